@@ -0,0 +1,66 @@
+// Counts heap allocations made while compiling a script, to keep an eye on compile-time garbage.
+// Build it together with the interpreter sources (without Main.cpp) and pass it one or more scripts.
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+#include "Compiler.h"
+
+static size_t allocationCount = 0;
+static size_t allocatedBytes = 0;
+
+void* operator new(size_t size)
+{
+	++allocationCount;
+	allocatedBytes += size;
+
+	if (void* memory = std::malloc(size ? size : 1))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+int main(int argc, char** argv)
+{
+	constexpr size_t COMPILES = 100;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::ifstream file(argv[i]);
+		std::stringstream buffer;
+		buffer << file.rdbuf();
+		std::string source = buffer.str();
+
+		// One compiler is reused across compiles, the way a VM reuses its own.
+		yo::Compiler compiler;
+		yo::Chunk warmup;
+		compiler.compile(source.c_str(), &warmup);
+
+		size_t chunkBytes = warmup.data.size();
+		size_t allocations = allocationCount;
+		size_t bytes = allocatedBytes;
+
+		for (size_t compile = 0; compile < COMPILES; ++compile)
+		{
+			yo::Chunk chunk;
+			compiler.compile(source.c_str(), &chunk);
+		}
+
+		printf("%-32s %6zu source bytes %6zu bytecode bytes %8.1f allocations %10.1f bytes per compile\n", argv[i], source.size(), chunkBytes,
+			(double)(allocationCount - allocations) / COMPILES, (double)(allocatedBytes - bytes) / COMPILES);
+	}
+
+	return 0;
+}
\ No newline at end of file
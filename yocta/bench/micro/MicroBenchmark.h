@@ -0,0 +1,144 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#if defined(__linux__)
+#define YOCTA_AFFINITY_SUPPORTED
+#include <sched.h>
+#endif
+
+namespace yo
+{
+	struct Measurement
+	{
+	public:
+		// Seconds per iteration of the measured body.
+		double minimum = 0.0;
+		double median = 0.0;
+
+		// How far the median is above the minimum, as a fraction of it; a few percent is a quiet machine.
+		double spread = 0.0;
+	};
+
+	// Times one piece of the interpreter at a time. Every case is calibrated to run for a fixed slice of time,
+	// then sampled repeatedly on a single core; the minimum is reported as the figure least disturbed by the rest
+	// of the system, the median and spread next to it so that a noisy run is noticed.
+	//
+	// Options: --samples=N (default 15), --sample-ms=N (default 20) and --filter=TEXT, which keeps the cases
+	// whose name contains TEXT.
+	class MicroBenchmark
+	{
+	public:
+		MicroBenchmark(int argc, char** argv)
+		{
+			for (int i = 1; i < argc; ++i)
+			{
+				if (strncmp(argv[i], "--samples=", 10) == 0)
+					sampleCount = std::max<size_t>(1, (size_t)strtoull(argv[i] + 10, nullptr, 10));
+
+				else if (strncmp(argv[i], "--sample-ms=", 12) == 0)
+					sampleSeconds = std::max(1.0, strtod(argv[i] + 12, nullptr)) / 1000.0;
+
+				else if (strncmp(argv[i], "--filter=", 9) == 0)
+					filter = argv[i] + 9;
+
+				else
+				{
+					fprintf(stderr, "Usage: %s [--samples=N] [--sample-ms=N] [--filter=TEXT]\n", argv[0]);
+					exit(1);
+				}
+			}
+
+			#ifdef YOCTA_AFFINITY_SUPPORTED
+			// Migrating between cores mid-sample costs more than most of what is measured here.
+			int core = sched_getcpu();
+
+			if (core >= 0)
+			{
+				cpu_set_t cores;
+				CPU_ZERO(&cores);
+				CPU_SET(core, &cores);
+				sched_setaffinity(0, sizeof(cores), &cores);
+			}
+			#endif
+		}
+
+	public:
+		bool selected(std::string_view name) const { return name.find(filter) != std::string_view::npos; }
+
+		// The body runs the measured operation the given number of times.
+		template<typename Body>
+		Measurement measure(Body&& body) const
+		{
+			size_t iterations = 1;
+
+			// Doubling until a batch fills the slice also warms caches, branch predictors and the allocator.
+			while (true)
+			{
+				double seconds = time(body, iterations);
+
+				if (seconds >= sampleSeconds)
+					break;
+
+				iterations = seconds > sampleSeconds / 64 ? (size_t)(iterations * sampleSeconds / seconds) + 1 : iterations * 2;
+			}
+
+			std::vector<double> samples;
+
+			for (size_t sample = 0; sample < sampleCount; ++sample)
+				samples.push_back(time(body, iterations) / iterations);
+
+			std::sort(samples.begin(), samples.end());
+
+			Measurement measurement;
+			measurement.minimum = samples.front();
+			measurement.median = samples[samples.size() / 2];
+			measurement.spread = measurement.median / measurement.minimum - 1.0;
+
+			return measurement;
+		}
+
+	private:
+		template<typename Body>
+		static double time(Body& body, size_t iterations)
+		{
+			auto start = std::chrono::steady_clock::now();
+			body(iterations);
+
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+
+	private:
+		size_t sampleCount = 15;
+		double sampleSeconds = 0.02;
+		std::string_view filter;
+	};
+
+	// Makes the compiler assume the value is read, so work producing it is not optimized away.
+	template<typename T>
+	inline void keep(T& value)
+	{
+		#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+		#else
+		static volatile const void* sink;
+		sink = &value;
+		#endif
+	}
+
+	// Makes the compiler forget what it knows of the value, so operations on it are not folded or hoisted.
+	template<typename T>
+	inline void launder(T& value)
+	{
+		#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : "+m"(value) : : "memory");
+		#else
+		keep(value);
+		#endif
+	}
+}
\ No newline at end of file
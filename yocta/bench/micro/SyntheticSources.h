@@ -0,0 +1,123 @@
+#pragma once
+#include <string>
+
+namespace yo
+{
+	// Sources built to stress one part of the front end each. The ones meant for the compiler put their code in
+	// coroutines, since every coroutine gets a chunk of its own and a chunk can address only 256 constants.
+	namespace synthetic
+	{
+		// Long names and keywords, which is where identifier lookup spends its time.
+		inline std::string identifiers()
+		{
+			std::string source;
+
+			for (size_t line = 0; line < 4000; ++line)
+			{
+				std::string index = std::to_string(line);
+				source += "var accumulatedValue" + index + " = previousValue" + index + " and notKeyword or none;\n";
+				source += "while (counterVariable" + index + ") if (true) resume(taskHandle" + index + ");\n";
+			}
+
+			return source;
+		}
+
+		inline std::string numbers()
+		{
+			std::string source;
+
+			for (size_t line = 0; line < 8000; ++line)
+			{
+				std::string index = std::to_string(line);
+				source += index + " 3.14159 " + index + "0000 0.5 " + index + ".25 42 7;\n";
+			}
+
+			return source;
+		}
+
+		inline std::string strings()
+		{
+			std::string source;
+
+			for (size_t line = 0; line < 8000; ++line)
+				source += "\"short\" \"a somewhat longer string literal\" \"\" \"line " + std::to_string(line) + "\";\n";
+
+			return source;
+		}
+
+		inline std::string comments()
+		{
+			std::string source;
+
+			for (size_t line = 0; line < 8000; ++line)
+				source += "// A comment line that the lexer skips over without producing a token " + std::to_string(line) + "\nx;\n";
+
+			return source;
+		}
+
+		// Loops, branches and blocks, the shape most scripts have.
+		inline std::string statements()
+		{
+			std::string source;
+
+			for (size_t coroutine = 0; coroutine < 100; ++coroutine)
+			{
+				source += "var task" + std::to_string(coroutine) + " = coroutine\n{\n";
+
+				for (size_t group = 0; group < 16; ++group)
+				{
+					std::string name = "value" + std::to_string(group);
+
+					source += "\tvar " + name + " = " + std::to_string(coroutine * 16 + group) + ";\n";
+					source += "\tfor (var i = 0; i < 10; i = i + 1)\n\t{\n";
+					source += "\t\t" + name + " = " + name + " * 3 + i % 7;\n";
+					source += "\t\tif (" + name + " > 1000)\n\t\t\t" + name + " = " + name + " - 1000;\n";
+					source += "\t}\n";
+				}
+
+				source += "\tyield value0;\n};\n\n";
+			}
+
+			return source;
+		}
+
+		// Long arithmetic on locals, which exercises precedence parsing and needs almost no constants.
+		inline std::string expressions()
+		{
+			std::string source;
+
+			for (size_t coroutine = 0; coroutine < 100; ++coroutine)
+			{
+				source += "var task" + std::to_string(coroutine) + " = coroutine\n{\n\tvar a = 1;\n\tvar b = 2;\n\tvar c = 3;\n";
+
+				for (size_t line = 0; line < 40; ++line)
+					source += "\ta = (a + b) * (c - a) / (b + c) - -a % (c * b + a);\n";
+
+				source += "\tyield a;\n};\n\n";
+			}
+
+			return source;
+		}
+
+		// Map literals and indexing, with a constant for every key.
+		inline std::string maps()
+		{
+			std::string source;
+
+			for (size_t coroutine = 0; coroutine < 100; ++coroutine)
+			{
+				source += "var task" + std::to_string(coroutine) + " = coroutine\n{\n\tvar table = {};\n";
+
+				for (size_t line = 0; line < 20; ++line)
+				{
+					std::string key = "\"key" + std::to_string(line) + "\"";
+					source += "\ttable[" + key + "] = {1: table, 2: " + key + ", 3: table[" + key + "]};\n";
+				}
+
+				source += "\tyield table;\n};\n\n";
+			}
+
+			return source;
+		}
+	}
+}
\ No newline at end of file
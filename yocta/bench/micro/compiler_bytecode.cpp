@@ -0,0 +1,68 @@
+// Measures Compiler::compile alone, in bytes of bytecode emitted per second. One compiler is reused across
+// compiles, the way a VM reuses its own. Build it together with the interpreter sources (without Main.cpp);
+// see MicroBenchmark.h for the options.
+#include <cstdio>
+#include <string>
+
+#include "Compiler.h"
+#include "Coroutine.h"
+#include "MicroBenchmark.h"
+#include "SyntheticSources.h"
+
+// Coroutine bodies are chunks of their own, held by the prototypes in the constant pool.
+static size_t bytecodeBytes(const yo::Chunk& chunk)
+{
+	size_t bytes = chunk.data.size();
+
+	for (const yo::Value& constant : chunk.constantPool)
+	{
+		if (yo::isObjectType(constant, yo::ObjectType::PROTOTYPE))
+			bytes += bytecodeBytes(static_cast<yo::PrototypeObject*>(std::get<yo::YoctaObject*>(constant.variantValue))->chunk);
+	}
+
+	return bytes;
+}
+
+int main(int argc, char** argv)
+{
+	yo::MicroBenchmark benchmark(argc, argv);
+
+	const std::pair<const char*, std::string> sources[] = {
+		{ "statements", yo::synthetic::statements() },
+		{ "expressions", yo::synthetic::expressions() },
+		{ "maps", yo::synthetic::maps() }
+	};
+
+	for (const auto& [name, source] : sources)
+	{
+		if (!benchmark.selected(name))
+			continue;
+
+		yo::Compiler compiler;
+		yo::Chunk chunk;
+
+		if (!compiler.compile(source.c_str(), &chunk))
+		{
+			fprintf(stderr, "The %s source does not compile.\n", name);
+			return 1;
+		}
+
+		size_t bytes = bytecodeBytes(chunk);
+
+		yo::Measurement measurement = benchmark.measure([&](size_t iterations)
+		{
+			for (size_t i = 0; i < iterations; ++i)
+			{
+				yo::Chunk output;
+				compiler.compile(source.c_str(), &output);
+				yo::keep(output);
+			}
+		});
+
+		printf("%-12s %8zu source bytes %8zu bytecode bytes %8.1f MB bytecode/s %8.1f MB source/s (median %.1f, spread %.1f%%)\n",
+			name, source.size(), bytes, bytes / measurement.minimum / 1e6, source.size() / measurement.minimum / 1e6,
+			bytes / measurement.median / 1e6, measurement.spread * 100.0);
+	}
+
+	return 0;
+}
\ No newline at end of file
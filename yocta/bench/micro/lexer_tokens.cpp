@@ -0,0 +1,58 @@
+// Measures Lexer::nextToken alone, in tokens per second, over sources that each stress one kind of token.
+// Build it together with the interpreter sources (without Main.cpp); see MicroBenchmark.h for the options.
+#include <cstdio>
+#include <string>
+
+#include "Lexer.h"
+#include "MicroBenchmark.h"
+#include "SyntheticSources.h"
+
+static size_t countTokens(const std::string& source)
+{
+	yo::Lexer lexer(source.c_str());
+	size_t tokens = 0;
+
+	for (yo::Token token = lexer.nextToken(); token.type != yo::TokenType::T_EOF; token = lexer.nextToken())
+		++tokens;
+
+	return tokens;
+}
+
+int main(int argc, char** argv)
+{
+	yo::MicroBenchmark benchmark(argc, argv);
+
+	const std::pair<const char*, std::string> sources[] = {
+		{ "identifiers", yo::synthetic::identifiers() },
+		{ "numbers", yo::synthetic::numbers() },
+		{ "strings", yo::synthetic::strings() },
+		{ "comments", yo::synthetic::comments() },
+		{ "statements", yo::synthetic::statements() }
+	};
+
+	for (const auto& [name, source] : sources)
+	{
+		if (!benchmark.selected(name))
+			continue;
+
+		size_t tokens = countTokens(source);
+		yo::Lexer lexer;
+
+		yo::Measurement measurement = benchmark.measure([&](size_t iterations)
+		{
+			for (size_t i = 0; i < iterations; ++i)
+			{
+				lexer.open(source.c_str());
+
+				for (yo::Token token = lexer.nextToken(); token.type != yo::TokenType::T_EOF; token = lexer.nextToken())
+					yo::keep(token);
+			}
+		});
+
+		printf("%-12s %8zu tokens %8.1f M tokens/s %8.2f ns/token (median %.2f, spread %.1f%%)\n", name, tokens,
+			tokens / measurement.minimum / 1e6, measurement.minimum * 1e9 / tokens, measurement.median * 1e9 / tokens,
+			measurement.spread * 100.0);
+	}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+// Compares the map object's open-addressing Table with std::unordered_map over the same Values and the same
+// hash, at 1e3 to 1e7 entries, in nanoseconds per operation: building the table one insert at a time, looking
+// up keys it holds in a scattered order, and looking up keys it does not hold. Integer keys run at every size;
+// string keys, a heap object each, stop at 1e6 to keep the memory the run needs bounded. Build it together
+// with the interpreter sources (without Main.cpp); see MicroBenchmark.h for the options. The largest sizes
+// take a while; --samples=5 shortens them.
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Table.h"
+#include "MicroBenchmark.h"
+
+namespace
+{
+	struct ValueHash
+	{
+	public:
+		size_t operator()(const yo::Value& value) const { return (size_t)yo::hashValue(value); }
+	};
+
+	using UnorderedMap = std::unordered_map<yo::Value, yo::Value, ValueHash>;
+
+	// Keys are read in a scattered order, as the size and this step share no factor.
+	constexpr size_t STRIDE = 2654435761u;
+
+	// Keys that miss are cycled through from a set this large, so making them does not dominate small tables.
+	constexpr size_t MISS_KEYS = 65536;
+
+	std::vector<yo::Value> makeKeys(bool strings, size_t first, size_t count)
+	{
+		std::vector<yo::Value> keys;
+		keys.reserve(count);
+
+		for (size_t i = first; i < first + count; ++i)
+		{
+			if (strings)
+			{
+				// Long enough to be a string object rather than a short string.
+				std::string key = "key:" + std::to_string(i * 7919);
+				keys.push_back(yo::Value::makeString(key.data(), key.size()));
+			}
+			else
+				keys.push_back(yo::Value((int64_t)(i * 7919)));
+		}
+
+		return keys;
+	}
+
+	void insert(yo::Table& table, const yo::Value& key, const yo::Value& value) { table.insert(key, value); }
+
+	void insert(UnorderedMap& map, const yo::Value& key, const yo::Value& value) { map.insert_or_assign(key, value); }
+
+	const yo::Value* find(const yo::Table& table, const yo::Value& key) { return table.find(key); }
+
+	const yo::Value* find(const UnorderedMap& map, const yo::Value& key)
+	{
+		auto found = map.find(key);
+		return found != map.end() ? &found->second : nullptr;
+	}
+}
+
+template<typename Container>
+static void measureContainer(const yo::MicroBenchmark& benchmark, const char* container, const char* type,
+	const std::vector<yo::Value>& keys, const std::vector<yo::Value>& misses)
+{
+	size_t size = keys.size();
+	yo::Value value((int64_t)1);
+
+	auto report = [&](const char* operation, const yo::Measurement& measurement, size_t operations)
+	{
+		printf("%-14s %-7s %-6s %9zu %9.2f ns/op (median %.2f, spread %.1f%%)\n", container, type, operation, size,
+			measurement.minimum * 1e9 / operations, measurement.median * 1e9 / operations, measurement.spread * 100.0);
+	};
+
+	std::string name = std::string(container) + " " + type + " " + std::to_string(size);
+
+	if (benchmark.selected(name + " insert"))
+	{
+		// Every iteration builds a table of every key from empty, growth included.
+		yo::Measurement measurement = benchmark.measure([&](size_t iterations)
+		{
+			for (size_t i = 0; i < iterations; ++i)
+			{
+				Container built;
+
+				for (const yo::Value& key : keys)
+					insert(built, key, value);
+
+				yo::keep(built);
+			}
+		});
+
+		report("insert", measurement, size);
+	}
+
+	Container filled;
+
+	for (const yo::Value& key : keys)
+		insert(filled, key, value);
+
+	if (benchmark.selected(name + " hit"))
+	{
+		yo::Measurement measurement = benchmark.measure([&](size_t iterations)
+		{
+			size_t index = 0;
+
+			for (size_t i = 0; i < iterations; ++i)
+			{
+				index = (index + STRIDE) % size;
+
+				const yo::Value* found = find(filled, keys[index]);
+				yo::keep(found);
+			}
+		});
+
+		report("hit", measurement, 1);
+	}
+
+	if (benchmark.selected(name + " miss"))
+	{
+		yo::Measurement measurement = benchmark.measure([&](size_t iterations)
+		{
+			for (size_t i = 0; i < iterations; ++i)
+			{
+				const yo::Value* found = find(filled, misses[i % misses.size()]);
+				yo::keep(found);
+			}
+		});
+
+		report("miss", measurement, 1);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	yo::MicroBenchmark benchmark(argc, argv);
+
+	for (bool strings : { false, true })
+	{
+		const char* type = strings ? "string" : "integer";
+
+		for (size_t size = 1000; size <= (strings ? 1000000u : 10000000u); size *= 10)
+		{
+			std::vector<yo::Value> keys = makeKeys(strings, 0, size);
+			std::vector<yo::Value> misses = makeKeys(strings, size, std::min(size, MISS_KEYS));
+
+			measureContainer<yo::Table>(benchmark, "Table", type, keys, misses);
+			measureContainer<UnorderedMap>(benchmark, "unordered_map", type, keys, misses);
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
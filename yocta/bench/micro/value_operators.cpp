@@ -0,0 +1,119 @@
+// Measures the Value operators alone, in nanoseconds per operation, for each combination of operand types
+// the interpreter falls back to them for. Results that allocate (string concatenation) go to a heap of their
+// own, collected whenever it asks to be. Build it together with the interpreter sources (without Main.cpp);
+// see MicroBenchmark.h for the options.
+#include <cstdio>
+#include <string>
+
+#include "Value.h"
+#include "Heap.h"
+#include "MicroBenchmark.h"
+
+namespace
+{
+	// The operands are permanent objects, so nothing the benchmark holds needs tracing.
+	class NoRoots : public yo::HeapRoots
+	{
+	public:
+		void traceRoots(yo::Heap&) override { }
+	};
+
+	struct Operand
+	{
+	public:
+		const char* type;
+		yo::Value value;
+	};
+}
+
+template<typename Apply>
+static yo::Measurement measureOperator(const yo::MicroBenchmark& benchmark, Apply apply, yo::Value lhs, yo::Value rhs)
+{
+	yo::Heap heap;
+	NoRoots roots;
+	yo::Heap::Scope scope(&heap);
+
+	return benchmark.measure([&](size_t iterations)
+	{
+		for (size_t i = 0; i < iterations; ++i)
+		{
+			yo::launder(lhs);
+			yo::launder(rhs);
+
+			yo::Value result = apply(lhs, rhs);
+			yo::keep(result);
+
+			if (heap.collectionRequested())
+				heap.collect(roots);
+		}
+	});
+}
+
+int main(int argc, char** argv)
+{
+	yo::MicroBenchmark benchmark(argc, argv);
+
+	const Operand integer = { "integer", yo::Value((int64_t)7) };
+	const Operand number = { "number", yo::Value(2.5) };
+	const Operand shortString = { "short string", yo::Value::makeString("abc", 3) };
+	const Operand longString = { "string", yo::Value::makeString("a string longer than seven", 26) };
+	const Operand equalString = { "equal string", yo::Value::makeString("a string longer than seven", 26) };
+	const Operand boolean = { "bool", yo::Value(true) };
+	const Operand none = { "none", yo::Value() };
+
+	// Wrapped in lambdas so each operator is inlined into its own loop, as it is into the interpreter's.
+	auto add = [](const yo::Value& a, const yo::Value& b) { return a + b; };
+	auto sub = [](const yo::Value& a, const yo::Value& b) { return a - b; };
+	auto mult = [](const yo::Value& a, const yo::Value& b) { return a * b; };
+	auto div = [](const yo::Value& a, const yo::Value& b) { return a / b; };
+	auto mod = [](const yo::Value& a, const yo::Value& b) { return a % b; };
+	auto less = [](const yo::Value& a, const yo::Value& b) { return yo::Value(a < b); };
+	auto greater = [](const yo::Value& a, const yo::Value& b) { return yo::Value(a > b); };
+	auto equal = [](const yo::Value& a, const yo::Value& b) { return yo::Value(a == b); };
+
+	auto run = [&](const char* symbol, auto apply, const Operand& lhs, const Operand& rhs)
+	{
+		std::string name = std::string(lhs.type) + " " + symbol + " " + rhs.type;
+
+		if (!benchmark.selected(name))
+			return;
+
+		yo::Measurement measurement = measureOperator(benchmark, apply, lhs.value, rhs.value);
+		printf("%-36s %8.2f ns/op (median %.2f, spread %.1f%%)\n", name.c_str(), measurement.minimum * 1e9,
+			measurement.median * 1e9, measurement.spread * 100.0);
+	};
+
+	for (const Operand* lhs : { &integer, &number })
+	{
+		for (const Operand* rhs : { &integer, &number })
+		{
+			run("+", add, *lhs, *rhs);
+			run("-", sub, *lhs, *rhs);
+			run("*", mult, *lhs, *rhs);
+			run("/", div, *lhs, *rhs);
+			run("%", mod, *lhs, *rhs);
+			run("<", less, *lhs, *rhs);
+			run(">", greater, *lhs, *rhs);
+			run("==", equal, *lhs, *rhs);
+		}
+	}
+
+	for (const Operand* lhs : { &shortString, &longString })
+	{
+		for (const Operand* rhs : { &shortString, &longString })
+		{
+			run("+", add, *lhs, *rhs);
+			run("==", equal, *lhs, *rhs);
+		}
+	}
+
+	// A different object with the same characters, which equality has to compare.
+	run("==", equal, longString, equalString);
+
+	run("==", equal, integer, shortString);
+	run("==", equal, boolean, boolean);
+	run("<", less, boolean, boolean);
+	run("==", equal, none, none);
+
+	return 0;
+}
\ No newline at end of file
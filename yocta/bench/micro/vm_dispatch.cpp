@@ -0,0 +1,302 @@
+// Measures the interpreter loop alone, in nanoseconds per dispatch of each opcode, on hand-assembled chunks
+// that bypass the compiler. Every opcode runs in a loop body that repeats one unit 32 times: the operands
+// it needs, the opcode, and pops for what it leaves. A reference body with the same operands and only pops is
+// timed too, and the difference is what the opcode costs over the pops it replaced. OP_POP_BACK and OP_TRUE
+// are taken to cost the same, half of a body of both, which closes the loop. OP_LOOP is what remains of an
+// empty iteration once the other loop instructions are accounted for.
+//
+// Quickening is off, so generic opcodes stay generic; the quickened ones are emitted directly. OP_RETURN,
+// OP_PRINT, OP_DEFINE_GLOBAL_VAR, OP_FOR_IN and the coroutine opcodes cannot repeat in place and are left out.
+// Build it together with the interpreter sources (without Main.cpp); see MicroBenchmark.h for the options.
+#include <cstdio>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "VirtualMachine.h"
+#include "MicroBenchmark.h"
+
+using yo::OPCode;
+
+namespace
+{
+	constexpr size_t UNITS = 32;
+
+	// Locals every chunk starts with, in slot order.
+	enum Slot : uint8_t
+	{
+		COUNTER,
+		LIMIT,
+		INTEGER_A,
+		INTEGER_B,
+		NUMBER_X,
+		NUMBER_Y,
+		STRING_S,
+		STRING_T,
+		MAP,
+		ARRAY,
+		NATIVE,
+		SCRATCH
+	};
+
+	// Every chunk starts its constant pool with these, so units can refer to them by index.
+	enum Constant : uint8_t
+	{
+		ZERO,
+		ONE,
+		SEVEN,
+		THREE,
+		ONE_AND_A_HALF,
+		TWO_AND_A_QUARTER,
+		ABC,
+		DE,
+		LIMIT_NAME,
+		GLOBAL_NAME,
+		NATIVE_NAME
+	};
+
+	struct Instruction
+	{
+	public:
+		Instruction(OPCode code)
+			: code(code) { }
+
+		Instruction(OPCode code, std::initializer_list<uint8_t> operands)
+			: code(code), operands(operands) { }
+
+	public:
+		OPCode code;
+		std::vector<uint8_t> operands;
+	};
+
+	struct DispatchCase
+	{
+	public:
+		std::string name;
+		std::vector<Instruction> operands;
+		Instruction measured;
+		size_t consumed;
+		size_t produced;
+	};
+}
+
+static void emit(yo::Chunk& chunk, const Instruction& instruction)
+{
+	chunk.push_back((uint8_t)instruction.code, 1);
+
+	for (uint8_t operand : instruction.operands)
+		chunk.push_back(operand, 1);
+}
+
+static std::shared_ptr<const yo::Program> assemble(const std::vector<Instruction>& unit)
+{
+	yo::Chunk chunk;
+
+	for (yo::Value constant : { yo::Value((int64_t)0), yo::Value((int64_t)1), yo::Value((int64_t)7), yo::Value((int64_t)3),
+		yo::Value(1.5), yo::Value(2.25), yo::Value::makeString("abc", 3), yo::Value::makeString("de", 2),
+		yo::Value::makeString("limit", 5), yo::Value::makeString("global", 6), yo::Value::makeString("len", 3) })
+		chunk.push_constant_only(constant);
+
+	for (const Instruction& instruction : std::initializer_list<Instruction> {
+		{ OPCode::OP_CONSTANT, { ZERO } },
+		{ OPCode::OP_GET_GLOBAL_VAR, { LIMIT_NAME } },
+		{ OPCode::OP_CONSTANT, { SEVEN } },
+		{ OPCode::OP_CONSTANT, { THREE } },
+		{ OPCode::OP_CONSTANT, { ONE_AND_A_HALF } },
+		{ OPCode::OP_CONSTANT, { TWO_AND_A_QUARTER } },
+		{ OPCode::OP_CONSTANT, { ABC } },
+		{ OPCode::OP_CONSTANT, { DE } },
+		{ OPCode::OP_CONSTANT, { SEVEN } },
+		{ OPCode::OP_CONSTANT, { ONE } },
+		{ OPCode::OP_BUILD_MAP, { 1 } },
+		{ OPCode::OP_CONSTANT, { ONE } },
+		{ OPCode::OP_CONSTANT, { THREE } },
+		{ OPCode::OP_BUILD_ARRAY, { 2 } },
+		{ OPCode::OP_GET_GLOBAL_VAR, { NATIVE_NAME } },
+		{ OPCode::OP_CONSTANT, { ZERO } } })
+		emit(chunk, instruction);
+
+	size_t loopStart = chunk.data.size();
+
+	emit(chunk, { OPCode::OP_GET_LOCAL_VAR, { COUNTER } });
+	emit(chunk, { OPCode::OP_GET_LOCAL_VAR, { LIMIT } });
+	emit(chunk, OPCode::OP_LESS_INT);
+
+	size_t exitJump = chunk.data.size() + 1;
+	emit(chunk, { OPCode::OP_JUMP_IF_FALSE, { 0, 0 } });
+	emit(chunk, OPCode::OP_POP_BACK);
+
+	for (size_t repeat = 0; repeat < UNITS; ++repeat)
+	{
+		for (const Instruction& instruction : unit)
+			emit(chunk, instruction);
+	}
+
+	emit(chunk, { OPCode::OP_INCREMENT_LOCAL, { COUNTER, ONE } });
+
+	size_t loopOffset = chunk.data.size() + 3 - loopStart;
+	emit(chunk, { OPCode::OP_LOOP, { (uint8_t)(loopOffset >> 8), (uint8_t)loopOffset } });
+
+	size_t exitOffset = chunk.data.size() - exitJump - 2;
+	chunk.data[exitJump] = (uint8_t)(exitOffset >> 8);
+	chunk.data[exitJump + 1] = (uint8_t)exitOffset;
+
+	emit(chunk, OPCode::OP_POP_BACK);
+	emit(chunk, OPCode::OP_RETURN);
+
+	// The cached global opcodes expect the slots quickening would have made for them.
+	chunk.profile.globalCaches.resize(chunk.data.size());
+
+	return yo::Program::assemble(std::move(chunk));
+}
+
+// Seconds per loop iteration, or nothing when the chunk fails to run.
+static std::optional<yo::Measurement> measureUnit(const yo::MicroBenchmark& benchmark, const std::vector<Instruction>& unit)
+{
+	std::shared_ptr<const yo::Program> program = assemble(unit);
+
+	yo::VirtualMachine vm;
+	vm.enableQuickening(false);
+
+	auto execute = [&](size_t iterations)
+	{
+		return vm.execute(program, { { "limit", yo::Value((int64_t)iterations) }, { "global", yo::Value((int64_t)1) } });
+	};
+
+	if (execute(1) != yo::VirtualMachine::InterpretResult::OK)
+		return std::nullopt;
+
+	return benchmark.measure(execute);
+}
+
+static std::vector<DispatchCase> dispatchCases()
+{
+	std::vector<DispatchCase> cases;
+
+	auto local = [](uint8_t slot) { return Instruction(OPCode::OP_GET_LOCAL_VAR, { slot }); };
+
+	for (OPCode code : { OPCode::OP_NONE, OPCode::OP_TRUE, OPCode::OP_FALSE })
+		cases.push_back({ yo::translateCode(code), {}, code, 0, 1 });
+
+	cases.push_back({ "OP_CONSTANT", {}, { OPCode::OP_CONSTANT, { SEVEN } }, 0, 1 });
+	cases.push_back({ "OP_GET_LOCAL", {}, local(INTEGER_A), 0, 1 });
+	cases.push_back({ "OP_SET_LOCAL", { local(INTEGER_A) }, { OPCode::OP_SET_LOCAL_VAR, { SCRATCH } }, 1, 1 });
+	cases.push_back({ "OP_INCREMENT_LOCAL", {}, { OPCode::OP_INCREMENT_LOCAL, { SCRATCH, ONE } }, 0, 0 });
+	cases.push_back({ "OP_GET_GLOBAL", {}, { OPCode::OP_GET_GLOBAL_VAR, { GLOBAL_NAME } }, 0, 1 });
+	cases.push_back({ "OP_GET_GLOBAL_CACHED", {}, { OPCode::OP_GET_GLOBAL_CACHED, { GLOBAL_NAME } }, 0, 1 });
+	cases.push_back({ "OP_SET_GLOBAL", { local(INTEGER_A) }, { OPCode::OP_SET_GLOBAL_VAR, { GLOBAL_NAME } }, 1, 1 });
+	cases.push_back({ "OP_SET_GLOBAL_CACHED", { local(INTEGER_A) }, { OPCode::OP_SET_GLOBAL_CACHED, { GLOBAL_NAME } }, 1, 1 });
+	cases.push_back({ "OP_JUMP", {}, { OPCode::OP_JUMP, { 0, 0 } }, 0, 0 });
+	cases.push_back({ "OP_JUMP_IF_FALSE", { OPCode::OP_TRUE }, { OPCode::OP_JUMP_IF_FALSE, { 0, 0 } }, 1, 1 });
+	cases.push_back({ "OP_NOT", { OPCode::OP_TRUE }, OPCode::OP_NOT, 1, 1 });
+	cases.push_back({ "OP_NEGATE (integer)", { local(INTEGER_A) }, OPCode::OP_NEGATE, 1, 1 });
+	cases.push_back({ "OP_NEGATE (number)", { local(NUMBER_X) }, OPCode::OP_NEGATE, 1, 1 });
+
+	const std::pair<const char*, std::vector<Instruction>> integers = { "(integer, integer)", { local(INTEGER_A), local(INTEGER_B) } };
+	const std::pair<const char*, std::vector<Instruction>> numbers = { "(number, number)", { local(NUMBER_X), local(NUMBER_Y) } };
+	const std::pair<const char*, std::vector<Instruction>> strings = { "(string, string)", { local(STRING_S), local(STRING_T) } };
+
+	for (const auto& [types, operands] : { integers, numbers })
+	{
+		for (OPCode code : { OPCode::OP_ADD, OPCode::OP_SUB, OPCode::OP_MULT, OPCode::OP_DIV, OPCode::OP_MOD,
+			OPCode::OP_LESS, OPCode::OP_GREATER, OPCode::OP_EQUAL })
+			cases.push_back({ std::string(yo::translateCode(code)) + " " + types, operands, code, 2, 1 });
+	}
+
+	for (OPCode code : { OPCode::OP_BIT_AND, OPCode::OP_BIT_OR, OPCode::OP_ADD_INT, OPCode::OP_SUB_INT, OPCode::OP_MULT_INT,
+		OPCode::OP_LESS_INT, OPCode::OP_GREATER_INT })
+		cases.push_back({ std::string(yo::translateCode(code)) + " " + integers.first, integers.second, code, 2, 1 });
+
+	for (OPCode code : { OPCode::OP_ADD_NUM_NUM, OPCode::OP_SUB_NUM_NUM, OPCode::OP_MULT_NUM_NUM, OPCode::OP_DIV_NUM_NUM,
+		OPCode::OP_LESS_NUM_NUM, OPCode::OP_GREATER_NUM_NUM })
+		cases.push_back({ std::string(yo::translateCode(code)) + " " + numbers.first, numbers.second, code, 2, 1 });
+
+	for (OPCode code : { OPCode::OP_ADD, OPCode::OP_ADD_STR_STR, OPCode::OP_EQUAL })
+		cases.push_back({ std::string(yo::translateCode(code)) + " " + strings.first, strings.second, code, 2, 1 });
+
+	cases.push_back({ "OP_BUILD_MAP (empty)", {}, { OPCode::OP_BUILD_MAP, { 0 } }, 0, 1 });
+	cases.push_back({ "OP_BUILD_ARRAY (2 elements)", { local(INTEGER_A), local(INTEGER_B) }, { OPCode::OP_BUILD_ARRAY, { 2 } }, 2, 1 });
+	cases.push_back({ "OP_GET_INDEX (map)", { local(MAP), local(INTEGER_A) }, OPCode::OP_GET_INDEX, 2, 1 });
+	cases.push_back({ "OP_SET_INDEX (map)", { local(MAP), local(INTEGER_A), local(INTEGER_B) }, OPCode::OP_SET_INDEX, 3, 1 });
+	cases.push_back({ "OP_DELETE_INDEX (map, missing key)", { local(MAP), local(INTEGER_B) }, OPCode::OP_DELETE_INDEX, 2, 0 });
+	cases.push_back({ "OP_GET_INDEX (array)", { local(ARRAY), { OPCode::OP_CONSTANT, { ONE } } }, OPCode::OP_GET_INDEX, 2, 1 });
+	cases.push_back({ "OP_SET_INDEX (array)", { local(ARRAY), { OPCode::OP_CONSTANT, { ONE } }, local(NUMBER_X) }, OPCode::OP_SET_INDEX, 3, 1 });
+	cases.push_back({ "OP_CALL (len)", { local(NATIVE), local(ARRAY) }, { OPCode::OP_CALL, { 1 } }, 2, 1 });
+
+	return cases;
+}
+
+static void report(const char* name, double seconds, double spread)
+{
+	printf("%-40s %8.2f ns/dispatch (spread %.1f%%)\n", name, seconds * 1e9, spread * 100.0);
+}
+
+int main(int argc, char** argv)
+{
+	yo::MicroBenchmark benchmark(argc, argv);
+
+	std::optional<yo::Measurement> empty = measureUnit(benchmark, {});
+	std::optional<yo::Measurement> pair = measureUnit(benchmark, { OPCode::OP_TRUE, OPCode::OP_POP_BACK });
+
+	if (!empty || !pair)
+	{
+		fprintf(stderr, "The reference chunks do not run.\n");
+		return 1;
+	}
+
+	double pop = (pair->minimum - empty->minimum) / UNITS / 2;
+
+	if (benchmark.selected("OP_POP_BACK"))
+		report("OP_POP_BACK", pop, pair->spread);
+
+	std::vector<DispatchCase> cases = dispatchCases();
+
+	for (const DispatchCase& dispatchCase : cases)
+	{
+		if (!benchmark.selected(dispatchCase.name))
+			continue;
+
+		std::vector<Instruction> unit = dispatchCase.operands;
+		unit.push_back(dispatchCase.measured);
+		unit.insert(unit.end(), dispatchCase.produced, OPCode::OP_POP_BACK);
+
+		std::vector<Instruction> reference = dispatchCase.operands;
+		reference.insert(reference.end(), dispatchCase.consumed, OPCode::OP_POP_BACK);
+
+		std::optional<yo::Measurement> measured = measureUnit(benchmark, unit);
+		std::optional<yo::Measurement> baseline = measureUnit(benchmark, reference);
+
+		if (!measured || !baseline)
+		{
+			fprintf(stderr, "%s: the chunk does not run.\n", dispatchCase.name.c_str());
+			return 1;
+		}
+
+		double cost = (measured->minimum - baseline->minimum) / UNITS + ((double)dispatchCase.consumed - (double)dispatchCase.produced) * pop;
+		report(dispatchCase.name.c_str(), cost, std::max(measured->spread, baseline->spread));
+	}
+
+	// An empty iteration is two local reads, the condition, its jump and pop, the increment and the back-edge.
+	if (benchmark.selected("OP_LOOP"))
+	{
+		auto costOf = [&](std::vector<Instruction> unit, size_t consumed, size_t produced)
+		{
+			std::vector<Instruction> reference = unit;
+			reference.pop_back();
+			reference.insert(reference.end(), consumed, OPCode::OP_POP_BACK);
+			unit.insert(unit.end(), produced, OPCode::OP_POP_BACK);
+
+			return (measureUnit(benchmark, unit)->minimum - measureUnit(benchmark, reference)->minimum) / UNITS + ((double)consumed - (double)produced) * pop;
+		};
+
+		double getLocal = costOf({ Instruction(OPCode::OP_GET_LOCAL_VAR, { COUNTER }) }, 0, 1);
+		double less = costOf({ Instruction(OPCode::OP_GET_LOCAL_VAR, { COUNTER }), Instruction(OPCode::OP_GET_LOCAL_VAR, { LIMIT }), OPCode::OP_LESS_INT }, 2, 1);
+		double jump = costOf({ OPCode::OP_TRUE, Instruction(OPCode::OP_JUMP_IF_FALSE, { 0, 0 }) }, 1, 1);
+		double increment = costOf({ Instruction(OPCode::OP_INCREMENT_LOCAL, { SCRATCH, ONE }) }, 0, 0);
+
+		report("OP_LOOP", empty->minimum - 2 * getLocal - less - jump - pop - increment, empty->spread);
+	}
+
+	return 0;
+}
\ No newline at end of file
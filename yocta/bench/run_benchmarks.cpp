@@ -0,0 +1,480 @@
+// Runs yocta scripts a fixed number of times and prints how long compiling and running each one took, as JSON,
+// so two builds can be compared by diffing or plotting their reports. Every repetition runs in a fresh VM, since a
+// script cannot define its globals twice. Pass scripts or directories of scripts (bench/corpus holds the standard
+// set); a generated large script is always compiled as well, to track compile speed on its own.
+//
+//   run_benchmarks [--warmup=N] [--repetitions=N] [--label=NAME] [--jit] [--trace] [--tier] <script or directory>...
+//
+// Instructions per second come from the hardware counters where the kernel lets the process read them, and
+// are null otherwise (other systems, containers, a high perf_event_paranoid).
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "VirtualMachine.h"
+#include "Program.h"
+
+#if defined(__linux__)
+#define YOCTA_PERF_EVENTS_SUPPORTED
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+#define YOCTA_SILENCING_SUPPORTED
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static size_t warmupCount = 2;
+static size_t repetitionCount = 10;
+static const char* label = "";
+static bool useJit = false;
+static bool useTracing = false;
+static yo::TieringOptions tieringOptions;
+
+// Counts the instructions retired by this thread between start and stop, in user and kernel mode alike.
+class InstructionCounter
+{
+public:
+	InstructionCounter()
+	{
+		#ifdef YOCTA_PERF_EVENTS_SUPPORTED
+		perf_event_attr attributes = {};
+		attributes.type = PERF_TYPE_HARDWARE;
+		attributes.size = sizeof(attributes);
+		attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+		attributes.disabled = 1;
+		attributes.exclude_hv = 1;
+
+		descriptor = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+
+		// Kernel instructions are often hidden from unprivileged processes, user ones seldom are.
+		if (descriptor < 0)
+		{
+			attributes.exclude_kernel = 1;
+			descriptor = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+		}
+		#endif
+	}
+
+	~InstructionCounter()
+	{
+		#ifdef YOCTA_PERF_EVENTS_SUPPORTED
+		if (descriptor >= 0)
+			close(descriptor);
+		#endif
+	}
+
+	InstructionCounter(const InstructionCounter&) = delete;
+	InstructionCounter& operator=(const InstructionCounter&) = delete;
+
+public:
+	bool available() const { return descriptor >= 0; }
+
+	void start()
+	{
+		#ifdef YOCTA_PERF_EVENTS_SUPPORTED
+		if (descriptor >= 0)
+		{
+			ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+			ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+		}
+		#endif
+	}
+
+	uint64_t stop()
+	{
+		uint64_t count = 0;
+
+		#ifdef YOCTA_PERF_EVENTS_SUPPORTED
+		if (descriptor >= 0)
+		{
+			ioctl(descriptor, PERF_EVENT_IOC_DISABLE, 0);
+
+			if (read(descriptor, &count, sizeof(count)) != sizeof(count))
+				count = 0;
+		}
+		#endif
+
+		return count;
+	}
+
+private:
+	int descriptor = -1;
+};
+
+// Points stdout at the null device while alive, so what the scripts print costs the same on every run.
+class SilencedOutput
+{
+public:
+	SilencedOutput()
+	{
+		fflush(stdout);
+
+		#ifdef YOCTA_SILENCING_SUPPORTED
+		int null = open("/dev/null", O_WRONLY);
+
+		if (null >= 0)
+		{
+			saved = dup(STDOUT_FILENO);
+			dup2(null, STDOUT_FILENO);
+			close(null);
+		}
+		#endif
+	}
+
+	~SilencedOutput()
+	{
+		fflush(stdout);
+
+		#ifdef YOCTA_SILENCING_SUPPORTED
+		if (saved >= 0)
+		{
+			dup2(saved, STDOUT_FILENO);
+			close(saved);
+		}
+		#endif
+	}
+
+	SilencedOutput(const SilencedOutput&) = delete;
+	SilencedOutput& operator=(const SilencedOutput&) = delete;
+
+private:
+	int saved = -1;
+};
+
+struct PhaseResult
+{
+public:
+	std::vector<double> seconds;
+	uint64_t instructions = 0;
+	bool counted = false;
+};
+
+struct BenchmarkResult
+{
+public:
+	std::string name;
+	std::string path;
+	size_t sourceBytes = 0;
+	PhaseResult compile;
+	std::optional<PhaseResult> run;
+	const char* error = nullptr;
+};
+
+static double percentile(std::vector<double> values, double fraction)
+{
+	if (values.empty())
+		return 0.0;
+
+	size_t index = std::min(values.size() - 1, (size_t)(fraction * values.size()));
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+
+	return values[index];
+}
+
+static bool readFile(const std::filesystem::path& path, std::string& source)
+{
+	std::ifstream file(path);
+
+	if (!file.good())
+		return false;
+
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	source = buffer.str();
+
+	return true;
+}
+
+// Many small coroutines with loops, branches and nested blocks. Every coroutine compiles into a chunk of its
+// own, which keeps each chunk well under the 256 constants one can address.
+static std::string generateLargeScript()
+{
+	constexpr size_t COROUTINES = 100;
+	constexpr size_t GROUPS = 16;
+
+	std::string source;
+
+	for (size_t coroutine = 0; coroutine < COROUTINES; ++coroutine)
+	{
+		source += "var task" + std::to_string(coroutine) + " = coroutine\n{\n";
+
+		for (size_t group = 0; group < GROUPS; ++group)
+		{
+			std::string name = "value" + std::to_string(group);
+			std::string seed = std::to_string(coroutine * GROUPS + group);
+
+			source += "\tvar " + name + " = " + seed + ";\n";
+			source += "\tfor (var i = 0; i < 10; i = i + 1)\n\t{\n";
+			source += "\t\t" + name + " = " + name + " * 3 + i % 7;\n";
+			source += "\t\tif (" + name + " > 1000)\n\t\t\t" + name + " = " + name + " - 1000;\n";
+			source += "\t}\n";
+		}
+
+		source += "\tyield value0;\n};\n\n";
+	}
+
+	return source;
+}
+
+static void runPhases(BenchmarkResult& result, const std::string& source, bool execute, InstructionCounter& counter)
+{
+	PhaseResult run;
+
+	for (size_t repetition = 0; repetition < warmupCount + repetitionCount; ++repetition)
+	{
+		bool measured = repetition >= warmupCount;
+
+		counter.start();
+		auto start = std::chrono::steady_clock::now();
+
+		std::shared_ptr<const yo::Program> program = yo::Program::compile(source.c_str());
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		uint64_t instructions = counter.stop();
+
+		if (!program)
+		{
+			result.error = "compile error";
+			return;
+		}
+
+		if (measured)
+		{
+			result.compile.seconds.push_back(seconds);
+			result.compile.instructions += instructions;
+		}
+
+		if (!execute)
+			continue;
+
+		yo::VirtualMachine vm;
+		vm.enableJit(useJit);
+		vm.enableTracing(useTracing);
+		vm.setTieringOptions(tieringOptions);
+
+		yo::VirtualMachine::InterpretResult outcome;
+		{
+			SilencedOutput silenced;
+
+			counter.start();
+			start = std::chrono::steady_clock::now();
+
+			for (outcome = vm.execute(program); outcome == yo::VirtualMachine::InterpretResult::YIELDED; outcome = vm.resume())
+				{ }
+
+			seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			instructions = counter.stop();
+		}
+
+		if (outcome != yo::VirtualMachine::InterpretResult::OK)
+		{
+			result.error = "runtime error";
+			return;
+		}
+
+		if (measured)
+		{
+			run.seconds.push_back(seconds);
+			run.instructions += instructions;
+		}
+	}
+
+	result.compile.counted = counter.available();
+	run.counted = counter.available();
+
+	if (execute)
+		result.run = run;
+}
+
+static void collectScripts(const char* argument, std::vector<std::filesystem::path>& scripts)
+{
+	std::error_code error;
+
+	if (!std::filesystem::is_directory(argument, error))
+	{
+		scripts.push_back(argument);
+		return;
+	}
+
+	std::vector<std::filesystem::path> entries;
+
+	for (const auto& entry : std::filesystem::directory_iterator(argument, error))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".yo")
+			entries.push_back(entry.path());
+	}
+
+	// Directory order differs between systems, and reports are easier to compare in a fixed one.
+	std::sort(entries.begin(), entries.end());
+	scripts.insert(scripts.end(), entries.begin(), entries.end());
+}
+
+static void printString(const std::string& text)
+{
+	putchar('"');
+
+	for (char character : text)
+	{
+		if (character == '"' || character == '\\')
+			printf("\\%c", character);
+		else if ((unsigned char)character < 0x20)
+			printf("\\u%04x", character);
+		else
+			putchar(character);
+	}
+
+	putchar('"');
+}
+
+static void printPhase(const char* name, const PhaseResult& phase)
+{
+	double total = 0.0;
+
+	for (double seconds : phase.seconds)
+		total += seconds;
+
+	printf("\t\t\t\"%s\": {\n", name);
+	printf("\t\t\t\t\"median_ms\": %.4f,\n", percentile(phase.seconds, 0.5) * 1000.0);
+	printf("\t\t\t\t\"p95_ms\": %.4f,\n", percentile(phase.seconds, 0.95) * 1000.0);
+	printf("\t\t\t\t\"min_ms\": %.4f,\n", phase.seconds.empty() ? 0.0 : *std::min_element(phase.seconds.begin(), phase.seconds.end()) * 1000.0);
+
+	if (phase.counted && total > 0.0)
+		printf("\t\t\t\t\"instructions_per_second\": %.0f\n", phase.instructions / total);
+	else
+		printf("\t\t\t\t\"instructions_per_second\": null\n");
+
+	printf("\t\t\t}");
+}
+
+static void printReport(const std::vector<BenchmarkResult>& results)
+{
+	printf("{\n");
+	printf("\t\"label\": ");
+	printString(label);
+	printf(",\n");
+	printf("\t\"options\": { \"jit\": %s, \"trace\": %s, \"tier\": %s },\n", useJit ? "true" : "false",
+		useTracing ? "true" : "false", tieringOptions.enabled ? "true" : "false");
+	printf("\t\"warmup\": %zu,\n", warmupCount);
+	printf("\t\"repetitions\": %zu,\n", repetitionCount);
+	printf("\t\"benchmarks\": [\n");
+
+	for (size_t index = 0; index < results.size(); ++index)
+	{
+		const BenchmarkResult& result = results[index];
+
+		printf("\t\t{\n");
+		printf("\t\t\t\"name\": ");
+		printString(result.name);
+		printf(",\n\t\t\t\"path\": ");
+		printString(result.path);
+		printf(",\n\t\t\t\"source_bytes\": %zu,\n", result.sourceBytes);
+
+		if (result.error)
+			printf("\t\t\t\"error\": \"%s\"\n", result.error);
+		else
+		{
+			printPhase("compile", result.compile);
+
+			if (result.run)
+			{
+				printf(",\n");
+				printPhase("run", *result.run);
+			}
+
+			printf("\n");
+		}
+
+		printf("\t\t}%s\n", index + 1 < results.size() ? "," : "");
+	}
+
+	printf("\t]\n");
+	printf("}\n");
+}
+
+int main(int argc, char** argv)
+{
+	for (; argc > 1 && strncmp(argv[1], "--", 2) == 0; --argc, ++argv)
+	{
+		if (strncmp(argv[1], "--warmup=", 9) == 0)
+			warmupCount = (size_t)strtoull(argv[1] + 9, nullptr, 10);
+
+		else if (strncmp(argv[1], "--repetitions=", 14) == 0)
+			repetitionCount = std::max<size_t>(1, (size_t)strtoull(argv[1] + 14, nullptr, 10));
+
+		else if (strncmp(argv[1], "--label=", 8) == 0)
+			label = argv[1] + 8;
+
+		else if (strcmp(argv[1], "--jit") == 0)
+			useJit = true;
+
+		else if (strcmp(argv[1], "--trace") == 0)
+			useTracing = true;
+
+		else if (strcmp(argv[1], "--tier") == 0)
+			tieringOptions.enabled = true;
+
+		else
+		{
+			fprintf(stderr, "Unknown option '%s'.\n", argv[1]);
+			return 1;
+		}
+	}
+
+	std::vector<std::filesystem::path> scripts;
+
+	for (int i = 1; i < argc; ++i)
+		collectScripts(argv[i], scripts);
+
+	InstructionCounter counter;
+	std::vector<BenchmarkResult> results;
+
+	for (const std::filesystem::path& script : scripts)
+	{
+		BenchmarkResult result;
+		result.name = script.stem().string();
+		result.path = script.string();
+
+		std::string source;
+
+		if (!readFile(script, source))
+		{
+			fprintf(stderr, "Cannot read '%s'.\n", result.path.c_str());
+			return 1;
+		}
+
+		result.sourceBytes = source.size();
+		runPhases(result, source, true, counter);
+
+		if (result.error)
+			fprintf(stderr, "%s: %s.\n", result.path.c_str(), result.error);
+
+		results.push_back(std::move(result));
+	}
+
+	BenchmarkResult generated;
+	generated.name = "generated_compile";
+	generated.path = "<generated>";
+
+	std::string source = generateLargeScript();
+	generated.sourceBytes = source.size();
+	runPhases(generated, source, false, counter);
+	results.push_back(std::move(generated));
+
+	printReport(results);
+
+	bool failed = std::any_of(results.begin(), results.end(), [](const BenchmarkResult& result) { return result.error != nullptr; });
+	return failed ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+// Compares the old-space slab allocator with plain new/delete on an old-space-like pattern: a large set of
+// small objects where a sweep frees a random part, and promotion refills it. Build it together with the
+// interpreter sources (without Main.cpp) and run it once per allocator, as `slab_allocations slab|new`,
+// so the peak RSS it prints belongs to that allocator alone.
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "SlabAllocator.h"
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+static long peakKilobytes()
+{
+	#if defined(__linux__)
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	return usage.ru_maxrss;
+	#else
+	return 0;
+	#endif
+}
+
+int main(int argc, char** argv)
+{
+	constexpr size_t LIVE_OBJECTS = 2000000;
+	constexpr size_t ROUNDS = 20;
+
+	bool useSlabs = argc < 2 || strcmp(argv[1], "new") != 0;
+	yo::SlabAllocator slabs;
+
+	std::mt19937 random(42);
+	std::uniform_int_distribution<size_t> sizes(17, 120);
+	std::bernoulli_distribution dies(0.4);
+
+	std::vector<std::pair<void*, size_t>> objects(LIVE_OBJECTS);
+	size_t allocations = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (size_t round = 0; round < ROUNDS; ++round)
+	{
+		for (auto& [memory, size] : objects)
+		{
+			if (memory && !dies(random))
+				continue;
+
+			if (memory)
+				useSlabs ? slabs.deallocate(memory, size) : ::operator delete(memory);
+
+			size = sizes(random);
+			memory = useSlabs ? slabs.allocate(size) : ::operator new(size);
+			std::memset(memory, 0, size);
+
+			++allocations;
+		}
+
+		if (useSlabs)
+			slabs.trim();
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (auto& [memory, size] : objects)
+		useSlabs ? slabs.deallocate(memory, size) : ::operator delete(memory);
+
+	printf("%-5s %10zu allocations %8.1f M allocations/s %8ld KB peak RSS\n", useSlabs ? "slab" : "new",
+		allocations, allocations / seconds / 1e6, peakKilobytes());
+
+	return 0;
+}
\ No newline at end of file
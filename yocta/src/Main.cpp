@@ -1,12 +1,56 @@
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
 #include "VirtualMachine.h"
+#include "Scheduler.h"
+#include "IsolatePool.h"
+#include "EventLoop.h"
+#include "BytecodeOptimizer.h"
+#include "CppTranspiler.h"
+#include "SamplingProfiler.h"
+
+static bool useJit = false;
+static bool useTracing = false;
+static bool useQuickening = true;
+static bool emitCpp = false;
+static bool heapStatistics = false;
+static bool opcodeStatistics = false;
+static const char* statisticsOutput = nullptr;
+static bool hugePages = false;
+static size_t memoryLimit = 0;
+static size_t repeatCount = 0;
+static uint64_t fuelBudget = 0;
+static size_t taskCount = 0;
+static size_t threadCount = 0;
+static size_t echoPairs = 0;
+static yo::TieringOptions tieringOptions;
+static std::shared_ptr<const yo::Snapshot> snapshot;
+static const char* snapshotOutput = nullptr;
+static const char* profileOutput = nullptr;
+static unsigned int profileFrequency = yo::SamplingProfiler::DEFAULT_FREQUENCY;
+
+static void configure(yo::VirtualMachine& vm)
+{
+	vm.enableJit(useJit);
+	vm.enableTracing(useTracing);
+	vm.setTieringOptions(tieringOptions);
+	vm.enableQuickening(useQuickening);
+	vm.setBudget(fuelBudget);
+	vm.heap().enableHugePages(hugePages);
+	vm.setMemoryLimit(memoryLimit);
+
+	if (snapshot)
+		vm.restore(snapshot);
+}
 
 void inlineInterpreter()
 {
 	yo::VirtualMachine vm;
+	configure(vm);
 
 	while (true)
 	{
@@ -19,10 +63,22 @@ void inlineInterpreter()
 			return;
 		}
 
-		vm.interpret(line);
+		for (auto result = vm.interpret(line); result == yo::VirtualMachine::InterpretResult::YIELDED; result = vm.resume())
+			{ }
 	}
 }
 
+static double percentile(std::vector<double> values, double fraction)
+{
+	if (values.empty())
+		return 0.0;
+
+	size_t index = std::min(values.size() - 1, (size_t)(fraction * values.size()));
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+
+	return values[index];
+}
+
 static std::string readFile(const char* filepath)
 {
 	std::ifstream file(filepath);
@@ -39,26 +95,347 @@ static std::string readFile(const char* filepath)
 	return stringBuffer.str();
 }
 
+static void scheduleFile(const std::string& src)
+{
+	std::shared_ptr<const yo::Program> program = yo::Program::compile(src.c_str());
+	if (!program)
+		return;
+
+	std::vector<std::unique_ptr<yo::VirtualMachine>> machines;
+	yo::Scheduler scheduler(fuelBudget ? fuelBudget : 10000);
+
+	for (size_t i = 0; i < taskCount; ++i)
+	{
+		machines.push_back(std::make_unique<yo::VirtualMachine>());
+		configure(*machines.back());
+		scheduler.spawn(*machines.back(), program);
+	}
+
+	scheduler.run();
+	fprintf(stderr, "Ran %zu tasks in %zu slices\n", taskCount, scheduler.slices());
+}
+
+static void scaleFile(const std::string& src)
+{
+	std::shared_ptr<const yo::Program> program = yo::Program::compile(src.c_str());
+	if (!program)
+		return;
+
+	size_t executions = repeatCount > 0 ? repeatCount : 1000;
+	double baseline = 0.0;
+
+	// Doubles the isolate count until it reaches the requested maximum.
+	for (size_t threads = 1; ; threads = std::min(threads * 2, threadCount))
+	{
+		yo::IsolatePool pool(threads, configure);
+
+		auto start = std::chrono::steady_clock::now();
+
+		for (size_t i = 0; i < executions; ++i)
+			pool.submit(program);
+
+		pool.wait();
+
+		double rate = executions / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (threads == 1)
+			baseline = rate;
+
+		fprintf(stderr, "%zu thread(s): %.0f executions/s, %.2fx, %zu failed\n", threads, rate, rate / baseline, pool.failed());
+
+		if (threads == threadCount)
+			break;
+	}
+}
+
+static void echoFile(const std::string& src)
+{
+	std::shared_ptr<const yo::Program> program = yo::Program::compile(src.c_str());
+	if (!program)
+		return;
+
+	size_t rounds = repeatCount > 0 ? repeatCount : 100;
+
+	std::vector<std::unique_ptr<yo::VirtualMachine>> machines;
+	yo::EventLoop loop(fuelBudget);
+
+	// Every pair is a client task and an echo task talking over the two ends of one socket pair.
+	for (size_t i = 0; i < echoPairs; ++i)
+	{
+		int fds[2];
+
+		if (!yo::EventLoop::openSocketPair(fds))
+		{
+			fprintf(stderr, "Could not open a socket pair for echo task %zu.\n", i);
+			return;
+		}
+
+		for (int side = 0; side < 2; ++side)
+		{
+			machines.push_back(std::make_unique<yo::VirtualMachine>());
+			configure(*machines.back());
+
+			loop.spawn(*machines.back(), program, { { "peer", { (int64_t)fds[side] } }, { "client", { side == 0 } }, { "rounds", { (int64_t)rounds } } });
+		}
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	if (!loop.run())
+	{
+		fprintf(stderr, "The event loop failed.\n");
+		return;
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	size_t failed = 0;
+	for (size_t task = 0; task < machines.size(); ++task)
+		failed += loop.result(task) != yo::VirtualMachine::InterpretResult::OK;
+
+	fprintf(stderr, "%zu echo pairs, %zu round trips in %.3f s: %.0f round trips/s, %zu parks, %zu failed\n",
+		echoPairs, echoPairs * rounds, seconds, echoPairs * rounds / seconds, loop.parks(), failed);
+}
+
 void runFile(const char* filepath)
 {
 	yo::VirtualMachine vm;
+	configure(vm);
 
 	std::string src = readFile(filepath);
 
-	vm.interpret(src.c_str());
+	if (taskCount > 0)
+		return scheduleFile(src);
+
+	if (threadCount > 0)
+		return scaleFile(src);
+
+	if (echoPairs > 0)
+		return echoFile(src);
+
+	yo::SamplingProfiler profiler(vm, profileFrequency);
+
+	if (profileOutput && !profiler.start())
+		fprintf(stderr, "Cannot start the sampling profiler on this system.\n");
+
+	vm.enableStatistics(opcodeStatistics);
+
+	if (repeatCount > 0)
+	{
+		std::shared_ptr<const yo::Program> program = yo::Program::compile(src.c_str());
+		if (!program)
+			return;
+
+		auto start = std::chrono::steady_clock::now();
+
+		for (size_t i = 0; i < repeatCount; ++i)
+		{
+			for (auto result = vm.execute(program); result == yo::VirtualMachine::InterpretResult::YIELDED; result = vm.resume())
+				{ }
+		}
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		fprintf(stderr, "Executed %zu times: %.1f ns per execution\n", repeatCount, seconds * 1e9 / repeatCount);
+	}
+	else
+	{
+		for (auto result = vm.interpret(src.c_str()); result == yo::VirtualMachine::InterpretResult::YIELDED; result = vm.resume())
+			{ }
+	}
+
+	if (profileOutput)
+	{
+		profiler.stop();
+
+		if (FILE* file = fopen(profileOutput, "w"))
+		{
+			profiler.writeFolded(file, filepath);
+			fclose(file);
+		}
+		else
+			fprintf(stderr, "Cannot write profile '%s'.\n", profileOutput);
+
+		profiler.writeLines(stderr, src);
+	}
+
+	if (snapshotOutput)
+	{
+		yo::SnapshotWriter writer;
+		vm.snapshot(writer);
+
+		if (!writer.write(snapshotOutput))
+			fprintf(stderr, "Cannot write snapshot '%s': %s.\n", snapshotOutput, writer.errorMessage());
+	}
+
+	if (useTracing)
+	{
+		const yo::TraceStatistics& statistics = vm.traceStatistics();
+
+		fprintf(stderr, "Traces recorded: %zu, aborted: %zu, entered: %zu, native time: %.3f ms\n",
+			statistics.recorded, statistics.aborted, statistics.entered, statistics.nativeSeconds * 1000.0);
+	}
+
+	if (const yo::OpcodeStatistics* statistics = vm.statistics())
+	{
+		FILE* file = statisticsOutput ? fopen(statisticsOutput, "w") : nullptr;
+
+		if (file)
+		{
+			statistics->writeJson(file);
+			fclose(file);
+		}
+		else if (statisticsOutput)
+			fprintf(stderr, "Cannot write statistics '%s'.\n", statisticsOutput);
+
+		statistics->writeTable(stderr);
+	}
+
+	if (heapStatistics)
+	{
+		const yo::HeapStatistics& statistics = vm.heap().statistics();
+		size_t minor = statistics.minorCollections;
+
+		fprintf(stderr, "Minor collections: %zu (mean %.3f ms, max %.3f ms), major: %zu (max %.3f ms), promoted: %.1f MB, pretenured: %.1f MB, old space: %.1f MB\n",
+			minor, minor ? statistics.minorSeconds * 1000.0 / minor : 0.0, statistics.maxMinorSeconds * 1000.0,
+			statistics.majorCollections, statistics.maxMajorSeconds * 1000.0, statistics.promotedBytes / 1048576.0,
+			statistics.pretenuredBytes / 1048576.0, vm.heap().oldBytes() / 1048576.0);
+
+		fprintf(stderr, "Slab pages: %.1f MB in use, %.1f MB reserved\n",
+			vm.heap().slabs().pageBytes() / 1048576.0, vm.heap().slabs().chunkBytes() / 1048576.0);
+
+		fprintf(stderr, "Memory: %.1f MB in use, %.1f MB peak\n", vm.memoryUsage() / 1048576.0, vm.peakMemoryUsage() / 1048576.0);
+
+		fprintf(stderr, "Pauses: p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, p99.9 %.3f ms\n",
+			percentile(statistics.pauses, 0.5) * 1000.0, percentile(statistics.pauses, 0.9) * 1000.0,
+			percentile(statistics.pauses, 0.99) * 1000.0, percentile(statistics.pauses, 0.999) * 1000.0);
+	}
+}
+
+int transpileFile(const char* filepath)
+{
+	std::string src = readFile(filepath);
+
+	yo::Compiler compiler;
+	yo::Chunk chunk;
+
+	if (!compiler.compile(src.c_str(), &chunk))
+		return 65;
+
+	std::vector<int32_t> offsetMap;
+	std::shared_ptr<yo::Chunk> optimized = yo::BytecodeOptimizer(chunk).optimize(offsetMap);
+
+	yo::CppTranspiler transpiler(optimized ? *optimized : chunk, filepath);
+	std::string output;
+
+	if (!transpiler.transpile(output))
+	{
+		fprintf(stderr, "Cannot emit C++ for '%s': %s.\n", filepath, transpiler.errorMessage());
+		return 1;
+	}
+
+	fwrite(output.data(), 1, output.size(), stdout);
+	return 0;
 }
 
 int main(int argc, char** argv)
 {
+	for (; argc > 1 && strncmp(argv[1], "--", 2) == 0; --argc, ++argv)
+	{
+		if (strcmp(argv[1], "--jit") == 0)
+			useJit = true;
+
+		else if (strcmp(argv[1], "--trace") == 0)
+			useTracing = true;
+
+		else if (strcmp(argv[1], "--emit-cpp") == 0)
+			emitCpp = true;
+
+		else if (strcmp(argv[1], "--heap-stats") == 0)
+			heapStatistics = true;
+
+		else if (strcmp(argv[1], "--stats") == 0)
+			opcodeStatistics = true;
+
+		else if (strncmp(argv[1], "--stats=", 8) == 0)
+		{
+			opcodeStatistics = true;
+			statisticsOutput = argv[1] + 8;
+		}
+
+		else if (strcmp(argv[1], "--huge-pages") == 0)
+			hugePages = true;
+
+		else if (strncmp(argv[1], "--memory-limit=", 15) == 0)
+			memoryLimit = (size_t)strtoull(argv[1] + 15, nullptr, 10) * 1024 * 1024;
+
+		else if (strncmp(argv[1], "--snapshot=", 11) == 0)
+		{
+			snapshot = yo::Snapshot::load(argv[1] + 11);
+
+			if (!snapshot)
+			{
+				fprintf(stderr, "Cannot load snapshot '%s'.\n", argv[1] + 11);
+				return 1;
+			}
+		}
+
+		else if (strncmp(argv[1], "--save-snapshot=", 16) == 0)
+			snapshotOutput = argv[1] + 16;
+
+		else if (strncmp(argv[1], "--profile=", 10) == 0)
+			profileOutput = argv[1] + 10;
+
+		else if (strncmp(argv[1], "--profile-hz=", 13) == 0)
+			profileFrequency = (unsigned int)strtoul(argv[1] + 13, nullptr, 10);
+
+		else if (strncmp(argv[1], "--repeat=", 9) == 0)
+			repeatCount = (size_t)strtoull(argv[1] + 9, nullptr, 10);
+
+		else if (strncmp(argv[1], "--budget=", 9) == 0)
+			fuelBudget = strtoull(argv[1] + 9, nullptr, 10);
+
+		else if (strncmp(argv[1], "--tasks=", 8) == 0)
+			taskCount = (size_t)strtoull(argv[1] + 8, nullptr, 10);
+
+		else if (strncmp(argv[1], "--threads=", 10) == 0)
+			threadCount = (size_t)strtoull(argv[1] + 10, nullptr, 10);
+
+		else if (strncmp(argv[1], "--echo=", 7) == 0)
+			echoPairs = (size_t)strtoull(argv[1] + 7, nullptr, 10);
+
+		else if (strcmp(argv[1], "--no-quicken") == 0)
+			useQuickening = false;
+
+		else if (strcmp(argv[1], "--tier") == 0)
+			tieringOptions.enabled = true;
+
+		else if (strcmp(argv[1], "--trace-tiers") == 0)
+			tieringOptions.enabled = tieringOptions.trace = true;
+
+		else if (strncmp(argv[1], "--tier-loops=", 13) == 0)
+			tieringOptions.backEdgeThreshold = (uint32_t)strtoul(argv[1] + 13, nullptr, 10);
+
+		else if (strncmp(argv[1], "--tier-calls=", 13) == 0)
+			tieringOptions.invocationThreshold = (uint32_t)strtoul(argv[1] + 13, nullptr, 10);
+
+		else
+		{
+			fprintf(stderr, "Unknown option '%s'.\n", argv[1]);
+			return 1;
+		}
+	}
+
 	if (argc == 1)
 		inlineInterpreter();
 	
+	else if (argc == 2 && emitCpp)
+		return transpileFile(argv[1]);
+
 	else if (argc == 2)
 		runFile(argv[1]);
 
 	else
 	{
-		fprintf(stderr, "Usage: yocta <filepath>\n");
+		fprintf(stderr, "Usage: yocta [--jit] [--trace] [--no-quicken] [--emit-cpp] [--heap-stats] [--stats[=FILE]] [--huge-pages] [--memory-limit=MB] [--snapshot=FILE] [--save-snapshot=FILE] [--profile=FILE] [--profile-hz=N] [--repeat=N] [--budget=N] [--tasks=N] [--threads=N] [--echo=N] [--tier] [--trace-tiers] [--tier-loops=N] [--tier-calls=N] <filepath>\n");
 		return 1;
 	}
 	
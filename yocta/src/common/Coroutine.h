@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+
+#include "YoctaObject.h"
+#include "Chunk.h"
+
+namespace yo
+{
+	// Stacks are swapped between the VM and its coroutines, so they all share one allocator type.
+	using ValueStack = std::vector<Value, AccountingAllocator<Value>>;
+
+	enum class CoroutineState
+	{
+		SUSPENDED = 0,
+		RUNNING,
+		DEAD
+	};
+
+	// The compiled body of a coroutine expression, stored in the constant pool of the enclosing chunk.
+	struct PrototypeObject : public YoctaObject
+	{
+	public:
+		PrototypeObject()
+			: YoctaObject(ObjectType::PROTOTYPE) { }
+
+	public:
+		Chunk chunk;
+	};
+
+	struct CoroutineObject : public YoctaObject
+	{
+	public:
+		CoroutineObject(PrototypeObject* prototype)
+			: YoctaObject(ObjectType::COROUTINE), IP(prototype->chunk.data.data()), chunk(&prototype->chunk) { }
+
+	public:
+		// Whichever side is not running keeps its context here: the coroutine's own while it is
+		// suspended, and its resumer's while it runs. Switching swaps these with the VM's registers.
+		const uint8_t* IP;
+		Chunk* chunk;
+		ValueStack stack;
+
+	public:
+		CoroutineObject* caller = nullptr;
+		CoroutineState state = CoroutineState::SUSPENDED;
+	};
+
+	inline CoroutineObject* getCoroutineObject(const Value& value)
+	{
+		return static_cast<CoroutineObject*>(std::get<YoctaObject*>(value.variantValue));
+	}
+}
\ No newline at end of file
@@ -2,7 +2,11 @@
 #define DEBUG_VM_STACK_TRACE
 #define DEBUG_COMPILER_TRACE
 #define DEBUG_VM_INSTRUCTION_TRACE
+#define DEBUG_TRACE_JIT
+#define DEBUG_QUICKENING_TRACE
 
 #undef DEBUG_VM_STACK_TRACE
 #undef DEBUG_VM_INSTRUCTION_TRACE
+#undef DEBUG_TRACE_JIT
+#undef DEBUG_QUICKENING_TRACE
 #undef DEBUG_COMPILER_TRACE
\ No newline at end of file
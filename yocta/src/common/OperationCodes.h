@@ -29,7 +29,35 @@ namespace yo
 		OP_SET_LOCAL_VAR,
 		OP_JUMP,
 		OP_JUMP_IF_FALSE,
-		OP_LOOP
+		OP_LOOP,
+		OP_BUILD_MAP,
+		OP_GET_INDEX,
+		OP_SET_INDEX,
+		OP_DELETE_INDEX,
+		OP_FOR_IN,
+		OP_MOD,
+		OP_BIT_AND,
+		OP_BIT_OR,
+		OP_BUILD_ARRAY,
+		OP_CALL,
+		OP_ADD_INT,
+		OP_SUB_INT,
+		OP_MULT_INT,
+		OP_LESS_INT,
+		OP_GREATER_INT,
+		OP_INCREMENT_LOCAL,
+		OP_ADD_NUM_NUM,
+		OP_SUB_NUM_NUM,
+		OP_MULT_NUM_NUM,
+		OP_DIV_NUM_NUM,
+		OP_LESS_NUM_NUM,
+		OP_GREATER_NUM_NUM,
+		OP_ADD_STR_STR,
+		OP_GET_GLOBAL_CACHED,
+		OP_SET_GLOBAL_CACHED,
+		OP_COROUTINE,
+		OP_YIELD,
+		OP_RESUME
 	};
 
 	inline const char* translateCode(const OPCode& code)
@@ -110,8 +138,161 @@ namespace yo
 
 			case OPCode::OP_LOOP:
 				return "OP_LOOP";
+
+			case OPCode::OP_BUILD_MAP:
+				return "OP_BUILD_MAP";
+
+			case OPCode::OP_GET_INDEX:
+				return "OP_GET_INDEX";
+
+			case OPCode::OP_SET_INDEX:
+				return "OP_SET_INDEX";
+
+			case OPCode::OP_DELETE_INDEX:
+				return "OP_DELETE_INDEX";
+
+			case OPCode::OP_FOR_IN:
+				return "OP_FOR_IN";
+
+			case OPCode::OP_MOD:
+				return "OP_MOD";
+
+			case OPCode::OP_BIT_AND:
+				return "OP_BIT_AND";
+
+			case OPCode::OP_BIT_OR:
+				return "OP_BIT_OR";
+
+			case OPCode::OP_BUILD_ARRAY:
+				return "OP_BUILD_ARRAY";
+
+			case OPCode::OP_CALL:
+				return "OP_CALL";
+
+			case OPCode::OP_ADD_INT:
+				return "OP_ADD_INT";
+
+			case OPCode::OP_SUB_INT:
+				return "OP_SUB_INT";
+
+			case OPCode::OP_MULT_INT:
+				return "OP_MULT_INT";
+
+			case OPCode::OP_LESS_INT:
+				return "OP_LESS_INT";
+
+			case OPCode::OP_GREATER_INT:
+				return "OP_GREATER_INT";
+
+			case OPCode::OP_INCREMENT_LOCAL:
+				return "OP_INCREMENT_LOCAL";
+
+			case OPCode::OP_ADD_NUM_NUM:
+				return "OP_ADD_NUM_NUM";
+
+			case OPCode::OP_SUB_NUM_NUM:
+				return "OP_SUB_NUM_NUM";
+
+			case OPCode::OP_MULT_NUM_NUM:
+				return "OP_MULT_NUM_NUM";
+
+			case OPCode::OP_DIV_NUM_NUM:
+				return "OP_DIV_NUM_NUM";
+
+			case OPCode::OP_LESS_NUM_NUM:
+				return "OP_LESS_NUM_NUM";
+
+			case OPCode::OP_GREATER_NUM_NUM:
+				return "OP_GREATER_NUM_NUM";
+
+			case OPCode::OP_ADD_STR_STR:
+				return "OP_ADD_STR_STR";
+
+			case OPCode::OP_GET_GLOBAL_CACHED:
+				return "OP_GET_GLOBAL_CACHED";
+
+			case OPCode::OP_SET_GLOBAL_CACHED:
+				return "OP_SET_GLOBAL_CACHED";
+
+			case OPCode::OP_COROUTINE:
+				return "OP_COROUTINE";
+
+			case OPCode::OP_YIELD:
+				return "OP_YIELD";
+
+			case OPCode::OP_RESUME:
+				return "OP_RESUME";
 		}
 		
 		return "";
 	}
+
+	inline int instructionLength(uint8_t code)
+	{
+		switch ((OPCode)code)
+		{
+			case OPCode::OP_CONSTANT:
+			case OPCode::OP_DEFINE_GLOBAL_VAR:
+			case OPCode::OP_GET_GLOBAL_VAR:
+			case OPCode::OP_SET_GLOBAL_VAR:
+			case OPCode::OP_GET_LOCAL_VAR:
+			case OPCode::OP_SET_LOCAL_VAR:
+			case OPCode::OP_BUILD_MAP:
+			case OPCode::OP_FOR_IN:
+			case OPCode::OP_BUILD_ARRAY:
+			case OPCode::OP_CALL:
+			case OPCode::OP_GET_GLOBAL_CACHED:
+			case OPCode::OP_SET_GLOBAL_CACHED:
+			case OPCode::OP_COROUTINE:
+				return 2;
+
+			case OPCode::OP_JUMP:
+			case OPCode::OP_JUMP_IF_FALSE:
+			case OPCode::OP_LOOP:
+			case OPCode::OP_INCREMENT_LOCAL:
+				return 3;
+
+			default:
+				return 1;
+		}
+	}
+
+	inline OPCode genericOperation(OPCode code)
+	{
+		switch (code)
+		{
+			case OPCode::OP_ADD_INT:
+			case OPCode::OP_ADD_NUM_NUM:
+			case OPCode::OP_ADD_STR_STR:
+				return OPCode::OP_ADD;
+
+			case OPCode::OP_SUB_INT:
+			case OPCode::OP_SUB_NUM_NUM:
+				return OPCode::OP_SUB;
+
+			case OPCode::OP_MULT_INT:
+			case OPCode::OP_MULT_NUM_NUM:
+				return OPCode::OP_MULT;
+
+			case OPCode::OP_DIV_NUM_NUM:
+				return OPCode::OP_DIV;
+
+			case OPCode::OP_LESS_INT:
+			case OPCode::OP_LESS_NUM_NUM:
+				return OPCode::OP_LESS;
+
+			case OPCode::OP_GREATER_INT:
+			case OPCode::OP_GREATER_NUM_NUM:
+				return OPCode::OP_GREATER;
+
+			case OPCode::OP_GET_GLOBAL_CACHED:
+				return OPCode::OP_GET_GLOBAL_VAR;
+
+			case OPCode::OP_SET_GLOBAL_CACHED:
+				return OPCode::OP_SET_GLOBAL_VAR;
+
+			default:
+				return code;
+		}
+	}
 }
\ No newline at end of file
@@ -1,8 +1,14 @@
 #pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
 #include <variant>
+#include <vector>
 #include <memory>
-#include "Value.h"
 #include "YoctaObject.h"
+#include "Heap.h"
 
 namespace yo
 {
@@ -11,13 +17,23 @@ namespace yo
 		VT_NONE,
 		VT_BOOL,
 		VT_NUMERIC,
-		VT_OBJECT
+		VT_OBJECT,
+		VT_SHORT_STRING,
+		VT_INTEGER
 	};
 
 	using YoctaValue = double;
 
 	struct YoctaObject;
 	struct StringObject;
+
+	struct ShortString
+	{
+		static constexpr size_t CAPACITY = 7;
+
+		char chars[CAPACITY];
+		uint8_t length;
+	};
 	
 	struct Value
 	{
@@ -33,12 +49,35 @@ namespace yo
 		Value(double number)
 			: type(ValueType::VT_NUMERIC), variantValue(number) { }
 
+		Value(int64_t integer)
+			: type(ValueType::VT_INTEGER), variantValue(integer) { }
+
+		Value(const ShortString& str)
+			: type(ValueType::VT_SHORT_STRING), variantValue(str) { }
+
 		Value(const std::string& str)
-			: type(ValueType::VT_OBJECT), variantValue((YoctaObject*)(new StringObject(str))) { }
+			: Value(makeString(str.data(), str.size())) { }
+
+	public:
+		static Value makeString(const char* chars, size_t length)
+		{
+			// Text too long for a string's length field is refused rather than cut short.
+			if (length > StringObject::MAX_LENGTH)
+				return {};
+
+			if (length > ShortString::CAPACITY)
+				return { (YoctaObject*)StringObject::create(chars, length) };
+
+			ShortString str = {};
+			std::memcpy(str.chars, chars, length);
+			str.length = (uint8_t)length;
+
+			return { str };
+		}
 
 	public:
 		ValueType type = ValueType::VT_NONE;
-		std::variant<bool, double, YoctaObject*> variantValue = false;
+		std::variant<bool, double, YoctaObject*, ShortString, int64_t> variantValue = false;
 
 	public:
 		friend Value operator-(const Value& lhs);
@@ -51,6 +90,12 @@ namespace yo
 
 		friend Value operator/(const Value& lhs, const Value& rhs);
 
+		friend Value operator%(const Value& lhs, const Value& rhs);
+
+		friend Value operator&(const Value& lhs, const Value& rhs);
+
+		friend Value operator|(const Value& lhs, const Value& rhs);
+
 		friend const bool operator==(const Value& lhs, const Value& rhs);
 
 		friend const bool operator<(const Value& lhs, const Value& rhs);
@@ -58,11 +103,223 @@ namespace yo
 		friend const bool operator>(const Value& lhs, const Value& rhs);
 	};
 
+	struct RopeObject : public YoctaObject
+	{
+	public:
+		RopeObject(const Value& left, const Value& right, size_t length)
+			: YoctaObject(ObjectType::ROPE), left(left), right(right), length(length) { }
+
+	public:
+		Value left;
+		Value right;
+		size_t length;
+		StringObject* flat = nullptr;
+	};
+
+	constexpr size_t ROPE_LEAF_LENGTH = 256;
+
+	inline bool isNumber(const Value& value)
+	{
+		return value.type == ValueType::VT_INTEGER || value.type == ValueType::VT_NUMERIC;
+	}
+
+	inline double toDouble(const Value& value)
+	{
+		if (value.type == ValueType::VT_INTEGER)
+			return (double)std::get<int64_t>(value.variantValue);
+
+		return std::get<double>(value.variantValue);
+	}
+
+	inline bool checkedAdd(int64_t a, int64_t b, int64_t& result)
+	{
+		#if defined(__GNUC__) || defined(__clang__)
+		return !__builtin_add_overflow(a, b, &result);
+		#else
+		result = (int64_t)((uint64_t)a + (uint64_t)b);
+		return !((a >= 0) == (b >= 0) && (result >= 0) != (a >= 0));
+		#endif
+	}
+
+	inline bool checkedSub(int64_t a, int64_t b, int64_t& result)
+	{
+		#if defined(__GNUC__) || defined(__clang__)
+		return !__builtin_sub_overflow(a, b, &result);
+		#else
+		result = (int64_t)((uint64_t)a - (uint64_t)b);
+		return !((a >= 0) != (b >= 0) && (result >= 0) != (a >= 0));
+		#endif
+	}
+
+	inline bool checkedMult(int64_t a, int64_t b, int64_t& result)
+	{
+		#if defined(__GNUC__) || defined(__clang__)
+		return !__builtin_mul_overflow(a, b, &result);
+		#else
+		result = (int64_t)((uint64_t)a * (uint64_t)b);
+		if (a == 0)
+			return true;
+
+		return !((a == -1 && b == INT64_MIN) || (b == -1 && a == INT64_MIN) || result / a != b);
+		#endif
+	}
+
 	inline StringObject* getStringObject(const Value& value)
 	{
-		return dynamic_cast<StringObject*>(std::get<YoctaObject*>(value.variantValue));
+		return static_cast<StringObject*>(std::get<YoctaObject*>(value.variantValue));
+	}
+
+	inline bool isObjectType(const Value& value, ObjectType type)
+	{
+		return value.type == ValueType::VT_OBJECT && std::get<YoctaObject*>(value.variantValue)->type == type;
+	}
+
+	inline bool isYoung(const Value& value)
+	{
+		return value.type == ValueType::VT_OBJECT && std::get<YoctaObject*>(value.variantValue)->generation == Generation::YOUNG;
+	}
+
+	inline bool isString(const Value& value)
+	{
+		if (value.type == ValueType::VT_SHORT_STRING)
+			return true;
+
+		return isObjectType(value, ObjectType::STRING) || isObjectType(value, ObjectType::ROPE);
+	}
+
+	inline size_t stringLength(const Value& value)
+	{
+		if (value.type == ValueType::VT_SHORT_STRING)
+			return std::get<ShortString>(value.variantValue).length;
+
+		YoctaObject* object = std::get<YoctaObject*>(value.variantValue);
+
+		if (object->type == ObjectType::ROPE)
+			return static_cast<RopeObject*>(object)->length;
+
+		return static_cast<StringObject*>(object)->length;
+	}
+
+	inline StringObject* flattenRope(RopeObject* rope)
+	{
+		if (rope->flat)
+			return rope->flat;
+
+		std::string buffer;
+		buffer.reserve(rope->length);
+
+		std::vector<const Value*> pending = { &rope->left, &rope->right };
+		std::reverse(pending.begin(), pending.end());
+
+		while (!pending.empty())
+		{
+			const Value* node = pending.back();
+			pending.pop_back();
+
+			if (node->type == ValueType::VT_SHORT_STRING)
+			{
+				const ShortString& str = std::get<ShortString>(node->variantValue);
+				buffer.append(str.chars, str.length);
+				continue;
+			}
+
+			YoctaObject* object = std::get<YoctaObject*>(node->variantValue);
+			if (object->type == ObjectType::STRING)
+			{
+				buffer.append(static_cast<StringObject*>(object)->view());
+				continue;
+			}
+
+			RopeObject* child = static_cast<RopeObject*>(object);
+			if (child->flat)
+			{
+				buffer.append(child->flat->view());
+				continue;
+			}
+
+			pending.push_back(&child->right);
+			pending.push_back(&child->left);
+		}
+
+		rope->flat = StringObject::create(buffer.data(), buffer.size());
+		rope->left = {};
+		rope->right = {};
+
+		if (rope->generation != Generation::YOUNG && Heap::active())
+			Heap::active()->remember(rope);
+
+		return rope->flat;
+	}
+
+	inline std::string_view stringView(const Value& value)
+	{
+		if (value.type == ValueType::VT_SHORT_STRING)
+		{
+			const ShortString& str = std::get<ShortString>(value.variantValue);
+			return { str.chars, str.length };
+		}
+
+		YoctaObject* object = std::get<YoctaObject*>(value.variantValue);
+
+		if (object->type == ObjectType::ROPE)
+			return flattenRope(static_cast<RopeObject*>(object))->view();
+
+		return static_cast<StringObject*>(object)->view();
+	}
+
+	inline uint32_t stringHash(const Value& value)
+	{
+		if (value.type == ValueType::VT_SHORT_STRING)
+		{
+			const ShortString& str = std::get<ShortString>(value.variantValue);
+			return StringObject::hashString(str.chars, str.length);
+		}
+
+		YoctaObject* object = std::get<YoctaObject*>(value.variantValue);
+
+		if (object->type == ObjectType::ROPE)
+			return flattenRope(static_cast<RopeObject*>(object))->hash;
+
+		return static_cast<StringObject*>(object)->hash;
 	}
 
+	inline Value concatenateStrings(const Value& lhs, const Value& rhs)
+	{
+		size_t length = stringLength(lhs) + stringLength(rhs);
+
+		// Every rope must flatten into a string that can record its length; the VM reports the error before this.
+		if (length > StringObject::MAX_LENGTH)
+			return {};
+
+		if (length <= ROPE_LEAF_LENGTH)
+		{
+			char buffer[ROPE_LEAF_LENGTH];
+
+			std::string_view a = stringView(lhs);
+			std::string_view b = stringView(rhs);
+
+			std::memcpy(buffer, a.data(), a.size());
+			std::memcpy(buffer + a.size(), b.data(), b.size());
+
+			return Value::makeString(buffer, length);
+		}
+
+		if (isObjectType(lhs, ObjectType::ROPE) && stringLength(rhs) < ROPE_LEAF_LENGTH)
+		{
+			RopeObject* rope = static_cast<RopeObject*>(std::get<YoctaObject*>(lhs.variantValue));
+
+			if (!rope->flat && stringLength(rope->right) + stringLength(rhs) <= ROPE_LEAF_LENGTH)
+			{
+				Value leaf = concatenateStrings(rope->right, rhs);
+				return { (YoctaObject*)createObject<RopeObject>(rope->left, leaf, length) };
+			}
+		}
+
+		return { (YoctaObject*)createObject<RopeObject>(lhs, rhs, length) };
+	}
+
+	void displayMap(const Value& value);
+
 	inline void displayValue(const Value& value)
 	{
 		if(value.type == ValueType::VT_NONE)
@@ -74,14 +331,55 @@ namespace yo
 		else if (value.type == ValueType::VT_NUMERIC)
 			printf("%f", std::get<double>(value.variantValue));
 
-		else if (value.type == ValueType::VT_OBJECT)
+		else if (value.type == ValueType::VT_INTEGER)
+			printf("%lld", (long long)std::get<int64_t>(value.variantValue));
+
+		else if (value.type == ValueType::VT_SHORT_STRING)
 		{
-			std::string str = getStringObject(value)->data;
+			std::string_view str = stringView(value);
+			printf("%.*s", (int)str.size(), str.data());
+		}
 
+		else if (value.type == ValueType::VT_OBJECT)
+		{
 			switch (std::get<YoctaObject*>(value.variantValue)->type)
 			{
 				case ObjectType::STRING:
-					printf("%s", str.c_str());
+				case ObjectType::ROPE:
+				{
+					std::string_view str = stringView(value);
+					fwrite(str.data(), 1, str.size(), stdout);
+					break;
+				}
+
+				case ObjectType::MAP:
+					displayMap(value);
+					break;
+
+				case ObjectType::NUMERIC_ARRAY:
+				{
+					const std::vector<double>& data = static_cast<NumericArrayObject*>(std::get<YoctaObject*>(value.variantValue))->data;
+
+					printf("[");
+					for (size_t i = 0; i < data.size(); ++i)
+						printf(i ? ", %f" : "%f", data[i]);
+					printf("]");
+					break;
+				}
+
+				case ObjectType::NATIVE:
+					printf("<native %s>", static_cast<NativeObject*>(std::get<YoctaObject*>(value.variantValue))->name);
+					break;
+
+				case ObjectType::PROTOTYPE:
+					printf("<prototype>");
+					break;
+
+				case ObjectType::COROUTINE:
+					printf("<coroutine>");
+					break;
+
+				default:
 					break;
 			}
 		}
@@ -89,65 +387,98 @@ namespace yo
 
 	inline Value operator-(const Value& lhs)
 	{
-		double a = std::get<double>(lhs.variantValue);
-		return { -a };
+		if (lhs.type == ValueType::VT_INTEGER && std::get<int64_t>(lhs.variantValue) != INT64_MIN)
+			return { -std::get<int64_t>(lhs.variantValue) };
+
+		return { -toDouble(lhs) };
 	}
 
 	inline Value operator+(const Value& lhs, const Value& rhs)
 	{
-		if (lhs.type != rhs.type)
-			return {};
+		if (isString(lhs) && isString(rhs))
+			return concatenateStrings(lhs, rhs);
 
-		if (lhs.type == ValueType::VT_NONE || rhs.type == ValueType::VT_NONE)
+		if (!isNumber(lhs) || !isNumber(rhs))
 			return {};
 
-		if (lhs.variantValue.index() == 1)
-		{
-			double a = std::get<double>(lhs.variantValue);
-			double b = std::get<double>(rhs.variantValue);
-
-			return { a + b };
-		}
-		else if (lhs.variantValue.index() == 2)
-		{
-			std::string a = getStringObject(lhs)->data;
-			std::string b = getStringObject(rhs)->data;
-
-			std::string c = a.append(b);
-			return { c };
-		}
+		int64_t result;
+		if (lhs.type == ValueType::VT_INTEGER && rhs.type == ValueType::VT_INTEGER &&
+			checkedAdd(std::get<int64_t>(lhs.variantValue), std::get<int64_t>(rhs.variantValue), result))
+			return { result };
 
-		return {};
+		return { toDouble(lhs) + toDouble(rhs) };
 	}
 
 	inline Value operator-(const Value& lhs, const Value& rhs)
 	{
-		double a = std::get<double>(lhs.variantValue);
-		double b = std::get<double>(rhs.variantValue);
+		int64_t result;
+		if (lhs.type == ValueType::VT_INTEGER && rhs.type == ValueType::VT_INTEGER &&
+			checkedSub(std::get<int64_t>(lhs.variantValue), std::get<int64_t>(rhs.variantValue), result))
+			return { result };
 
-		return { a - b };
+		return { toDouble(lhs) - toDouble(rhs) };
 	}
 
 	inline Value operator*(const Value& lhs, const Value& rhs)
 	{
-		double a = std::get<double>(lhs.variantValue);
-		double b = std::get<double>(rhs.variantValue);
+		int64_t result;
+		if (lhs.type == ValueType::VT_INTEGER && rhs.type == ValueType::VT_INTEGER &&
+			checkedMult(std::get<int64_t>(lhs.variantValue), std::get<int64_t>(rhs.variantValue), result))
+			return { result };
 
-		return { a * b };
+		return { toDouble(lhs) * toDouble(rhs) };
 	}
 
 	inline Value operator/(const Value& lhs, const Value& rhs)
 	{
-		double a = std::get<double>(lhs.variantValue);
-		double b = std::get<double>(rhs.variantValue);
+		if (lhs.type == ValueType::VT_INTEGER && rhs.type == ValueType::VT_INTEGER)
+		{
+			int64_t a = std::get<int64_t>(lhs.variantValue);
+			int64_t b = std::get<int64_t>(rhs.variantValue);
+
+			if (b != 0 && !(a == INT64_MIN && b == -1))
+				return { a / b };
+		}
+
+		return { toDouble(lhs) / toDouble(rhs) };
+	}
+
+	inline Value operator%(const Value& lhs, const Value& rhs)
+	{
+		if (lhs.type == ValueType::VT_INTEGER && rhs.type == ValueType::VT_INTEGER)
+		{
+			int64_t a = std::get<int64_t>(lhs.variantValue);
+			int64_t b = std::get<int64_t>(rhs.variantValue);
+
+			if (b == -1)
+				return { (int64_t)0 };
+
+			if (b != 0)
+				return { a % b };
+		}
+
+		return { std::fmod(toDouble(lhs), toDouble(rhs)) };
+	}
+
+	inline Value operator&(const Value& lhs, const Value& rhs)
+	{
+		return { std::get<int64_t>(lhs.variantValue) & std::get<int64_t>(rhs.variantValue) };
+	}
 
-		return { a / b };
+	inline Value operator|(const Value& lhs, const Value& rhs)
+	{
+		return { std::get<int64_t>(lhs.variantValue) | std::get<int64_t>(rhs.variantValue) };
 	}
 
 	inline const bool operator==(const Value& lhs, const Value& rhs)
 	{
 		if (lhs.type != rhs.type)
+		{
+			if (isNumber(lhs) && isNumber(rhs))
+				return toDouble(lhs) == toDouble(rhs);
+
 			return false;
+		}
 
 		if (lhs.type == ValueType::VT_NONE)
 			return (rhs.type == ValueType::VT_NONE);
@@ -164,12 +495,43 @@ namespace yo
 			double b = std::get<double>(rhs.variantValue);
 			return a == b;
 		}
+		else if (lhs.variantValue.index() == 2)
+		{
+			YoctaObject* a = std::get<YoctaObject*>(lhs.variantValue);
+			YoctaObject* b = std::get<YoctaObject*>(rhs.variantValue);
+
+			if (a == b)
+				return true;
+
+			if (!isString(lhs) || !isString(rhs) || stringLength(lhs) != stringLength(rhs))
+				return false;
+
+			return stringHash(lhs) == stringHash(rhs) && stringView(lhs) == stringView(rhs);
+		}
+		else if (lhs.variantValue.index() == 3)
+		{
+			const ShortString& a = std::get<ShortString>(lhs.variantValue);
+			const ShortString& b = std::get<ShortString>(rhs.variantValue);
+			return a.length == b.length && std::memcmp(a.chars, b.chars, a.length) == 0;
+		}
+		else if (lhs.variantValue.index() == 4)
+		{
+			int64_t a = std::get<int64_t>(lhs.variantValue);
+			int64_t b = std::get<int64_t>(rhs.variantValue);
+			return a == b;
+		}
 
 		return false;
 	}
 
 	inline const bool operator<(const Value& lhs, const Value& rhs)
 	{
+		if (lhs.type == ValueType::VT_INTEGER && rhs.type == ValueType::VT_INTEGER)
+			return std::get<int64_t>(lhs.variantValue) < std::get<int64_t>(rhs.variantValue);
+
+		if (isNumber(lhs) && isNumber(rhs))
+			return toDouble(lhs) < toDouble(rhs);
+
 		if (lhs.type != rhs.type)
 			return false;
 
@@ -182,18 +544,18 @@ namespace yo
 			bool b = std::get<bool>(rhs.variantValue);
 			return a < b;
 		}
-		else if (lhs.variantValue.index() == 1)
-		{
-			double a = std::get<double>(lhs.variantValue);
-			double b = std::get<double>(rhs.variantValue);
-			return a < b;
-		}
 
 		return false;
 	}
 
 	inline const bool operator>(const Value& lhs, const Value& rhs)
 	{
+		if (lhs.type == ValueType::VT_INTEGER && rhs.type == ValueType::VT_INTEGER)
+			return std::get<int64_t>(lhs.variantValue) > std::get<int64_t>(rhs.variantValue);
+
+		if (isNumber(lhs) && isNumber(rhs))
+			return toDouble(lhs) > toDouble(rhs);
+
 		if (lhs.type != rhs.type)
 			return false;
 
@@ -206,12 +568,6 @@ namespace yo
 			bool b = std::get<bool>(rhs.variantValue);
 			return a > b;
 		}
-		else if (lhs.variantValue.index() == 1)
-		{
-			double a = std::get<double>(lhs.variantValue);
-			double b = std::get<double>(rhs.variantValue);
-			return a > b;
-		}
 
 		return false;
 	}
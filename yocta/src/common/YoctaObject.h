@@ -1,33 +1,122 @@
 #pragma once
-#include <string>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <vector>
 
 namespace yo
 {
-	enum class ObjectType
+	enum class ObjectType : uint8_t
 	{
 		NONE = 0,
-		STRING
+		STRING,
+		ROPE,
+		MAP,
+		NUMERIC_ARRAY,
+		NATIVE,
+		PROTOTYPE,
+		COROUTINE
 	};
 
+	// Objects made outside a running VM (constants, natives, host values) stay PERMANENT: the
+	// collector never moves or frees them. A FORWARDED object has been moved to the old space.
+	enum class Generation : uint8_t
+	{
+		PERMANENT = 0,
+		YOUNG,
+		OLD,
+		FORWARDED
+	};
+
+	struct Value;
+	class NativeHost;
+
 	struct YoctaObject
 	{
 	public:
 		YoctaObject(ObjectType type)
-			: type(type) { }
-
-		virtual ~YoctaObject() = default;
+			: type(type), identity(++identities) { }
 
 	public:
 		ObjectType type;
+		Generation generation = Generation::PERMANENT;
+		bool marked = false;
+		bool remembered = false;
+
+		// Hashes objects by identity, since the collector changes their addresses.
+		uint32_t identity;
+
+	private:
+		static inline thread_local uint32_t identities = 0;
 	};
 
 	struct StringObject : public YoctaObject
 	{
 	public:
-		StringObject(const std::string& string)
-			: YoctaObject(ObjectType::STRING), data(string) {}
+		// The length is kept in 32 bits, and no string may be built longer than it can hold.
+		static constexpr size_t MAX_LENGTH = UINT32_MAX;
+
+	public:
+		// Defined in Heap.h, which decides whether the string lives in a VM heap.
+		static StringObject* create(const char* chars, size_t length);
+
+		static void destroy(StringObject* string)
+		{
+			string->~StringObject();
+			::operator delete(string);
+		}
+
+	public:
+		static uint32_t hashString(const char* key, size_t length)
+		{
+			uint32_t hash = 2166136261U;
+
+			for (size_t i = 0; i < length; ++i)
+			{
+				hash ^= (uint8_t)key[i];
+				hash *= 16777619U;
+			}
+
+			return hash;
+		}
+
+	public:
+		char* chars() { return reinterpret_cast<char*>(this + 1); }
+
+		const char* chars() const { return reinterpret_cast<const char*>(this + 1); }
+
+		std::string_view view() const { return { chars(), length }; }
+
+	private:
+		StringObject(uint32_t length, uint32_t hash)
+			: YoctaObject(ObjectType::STRING), length(length), hash(hash) { }
+
+	public:
+		uint32_t length;
+		uint32_t hash;
+	};
+
+	struct NumericArrayObject : public YoctaObject
+	{
+	public:
+		NumericArrayObject(size_t length = 0, double fill = 0.0)
+			: YoctaObject(ObjectType::NUMERIC_ARRAY), data(length, fill) { }
+
+	public:
+		std::vector<double> data;
+	};
+
+	using NativeFunction = bool (*)(NativeHost& host, int argCount, Value* args, Value& result);
+
+	struct NativeObject : public YoctaObject
+	{
+	public:
+		NativeObject(const char* name, NativeFunction function)
+			: YoctaObject(ObjectType::NATIVE), name(name), function(function) { }
 
 	public:
-		std::string data;
+		const char* name;
+		NativeFunction function;
 	};
 }
\ No newline at end of file
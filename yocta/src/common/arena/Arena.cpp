@@ -0,0 +1,56 @@
+#include "Arena.h"
+
+#include <new>
+
+yo::Arena::~Arena()
+{
+	for (Block* block = first; block;)
+	{
+		Block* next = block->next;
+		::operator delete(block);
+		block = next;
+	}
+}
+
+void yo::Arena::reset()
+{
+	if (first)
+		enter(first);
+}
+
+void* yo::Arena::allocateSlow(size_t size, size_t alignment)
+{
+	size_t needed = size + alignment;
+
+	// Blocks left over from earlier rounds are reused before asking for more memory.
+	while (current && current->next && current->next->size >= needed)
+	{
+		enter(current->next);
+
+		if (void* memory = allocate(size, alignment))
+			return memory;
+	}
+
+	size_t blockSize = needed > BLOCK_SIZE ? needed : BLOCK_SIZE;
+	Block* block = static_cast<Block*>(::operator new(sizeof(Block) + blockSize));
+
+	block->size = blockSize;
+	block->next = current ? current->next : nullptr;
+
+	if (current)
+		current->next = block;
+	else
+		first = block;
+
+	++blockCount;
+	enter(block);
+
+	return allocate(size, alignment);
+}
+
+void yo::Arena::enter(Block* block)
+{
+	current = block;
+	cursor = block->data();
+	limit = cursor + block->size;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace yo
+{
+	// Bump-pointer storage for data that dies together. Nothing is freed on its own;
+	// reset() rewinds to the first block and keeps every block for the next round.
+	class Arena
+	{
+	public:
+		static constexpr size_t BLOCK_SIZE = 16 * 1024;
+
+	public:
+		Arena() = default;
+
+		~Arena();
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+	public:
+		void* allocate(size_t size, size_t alignment)
+		{
+			uintptr_t aligned = ((uintptr_t)cursor + alignment - 1) & ~(uintptr_t)(alignment - 1);
+
+			if (!cursor || aligned + size > (uintptr_t)limit)
+				return allocateSlow(size, alignment);
+
+			cursor = (uint8_t*)(aligned + size);
+			return (void*)aligned;
+		}
+
+		void reset();
+
+	public:
+		size_t blocks() const { return blockCount; }
+
+	private:
+		struct Block
+		{
+		public:
+			Block* next;
+			size_t size;
+
+		public:
+			uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+		};
+
+	private:
+		void* allocateSlow(size_t size, size_t alignment);
+
+		void enter(Block* block);
+
+	private:
+		Block* first = nullptr;
+		Block* current = nullptr;
+		uint8_t* cursor = nullptr;
+		uint8_t* limit = nullptr;
+		size_t blockCount = 0;
+	};
+
+	template<typename T>
+	class ArenaAllocator
+	{
+	public:
+		using value_type = T;
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+
+	public:
+		explicit ArenaAllocator(Arena& arena)
+			: arena(&arena) { }
+
+		template<typename U>
+		ArenaAllocator(const ArenaAllocator<U>& other)
+			: arena(other.arena) { }
+
+	public:
+		T* allocate(size_t count) { return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T))); }
+
+		void deallocate(T*, size_t) { }
+
+	public:
+		template<typename U>
+		bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+
+		template<typename U>
+		bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+	private:
+		template<typename U>
+		friend class ArenaAllocator;
+
+		Arena* arena;
+	};
+}
\ No newline at end of file
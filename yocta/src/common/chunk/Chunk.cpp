@@ -23,5 +23,165 @@ void yo::Chunk::push_constant_only(Value value)
 void yo::Chunk::clear()
 {
 	data.clear();
+	lines.clear();
 	constantPool.clear();
+	profile = {};
 }
+
+size_t yo::Chunk::footprint() const
+{
+	size_t bytes = data.capacity() + lines.capacity() * sizeof(int) + constantPool.capacity() * sizeof(Value);
+
+	bytes += profile.operandTypes.capacity() + profile.deoptimizations.capacity();
+	bytes += profile.globalCaches.capacity() * sizeof(GlobalCache) + profile.offsetMap.capacity() * sizeof(int32_t);
+
+	return profile.optimized ? bytes + profile.optimized->footprint() : bytes;
+}
+
+bool yo::stackDepths(const uint8_t* code, size_t size, std::vector<int>& depths)
+{
+	std::vector<bool> starts(size);
+
+	for (size_t index = 0; index < size; index += instructionLength(code[index]))
+		starts[index] = true;
+
+	depths.assign(size, -1);
+	std::vector<size_t> work;
+
+	auto reach = [&](size_t target, int depth)
+	{
+		if (target >= size || !starts[target] || (depths[target] != -1 && depths[target] != depth))
+			return false;
+
+		if (depths[target] == -1)
+		{
+			depths[target] = depth;
+			work.push_back(target);
+		}
+
+		return true;
+	};
+
+	if (!reach(0, 0))
+		return false;
+
+	while (!work.empty())
+	{
+		size_t index = work.back();
+		work.pop_back();
+
+		OPCode operation = genericOperation((OPCode)code[index]);
+		int depth = depths[index];
+		int operand = instructionLength(code[index]) > 1 ? code[index + 1] : 0;
+		int taken = 0;
+		int pushed = 0;
+
+		switch (operation)
+		{
+			case OPCode::OP_RETURN:
+				continue;
+
+			case OPCode::OP_GET_LOCAL_VAR:
+			case OPCode::OP_SET_LOCAL_VAR:
+			case OPCode::OP_INCREMENT_LOCAL:
+				if (operand >= depth)
+					return false;
+
+				pushed = operation == OPCode::OP_GET_LOCAL_VAR;
+				break;
+
+			case OPCode::OP_NONE:
+			case OPCode::OP_TRUE:
+			case OPCode::OP_FALSE:
+			case OPCode::OP_CONSTANT:
+			case OPCode::OP_GET_GLOBAL_VAR:
+			case OPCode::OP_COROUTINE:
+				pushed = 1;
+				break;
+
+			case OPCode::OP_NEGATE:
+			case OPCode::OP_NOT:
+			case OPCode::OP_SET_GLOBAL_VAR:
+			case OPCode::OP_JUMP_IF_FALSE:
+			case OPCode::OP_RESUME:
+				taken = pushed = 1;
+				break;
+
+			case OPCode::OP_PRINT:
+			case OPCode::OP_POP_BACK:
+			case OPCode::OP_DEFINE_GLOBAL_VAR:
+			case OPCode::OP_YIELD:
+				taken = 1;
+				break;
+
+			case OPCode::OP_GET_INDEX:
+				taken = 2;
+				pushed = 1;
+				break;
+
+			case OPCode::OP_SET_INDEX:
+				taken = 3;
+				pushed = 1;
+				break;
+
+			case OPCode::OP_DELETE_INDEX:
+				taken = 2;
+				break;
+
+			// The loop variable, the container and the position sit in three locals from the operand on.
+			case OPCode::OP_FOR_IN:
+				if (operand + 3 > depth)
+					return false;
+
+				pushed = 1;
+				break;
+
+			case OPCode::OP_BUILD_MAP:
+				taken = operand * 2;
+				pushed = 1;
+				break;
+
+			case OPCode::OP_BUILD_ARRAY:
+				taken = operand;
+				pushed = 1;
+				break;
+
+			case OPCode::OP_CALL:
+				taken = operand + 1;
+				pushed = 1;
+				break;
+
+			case OPCode::OP_JUMP:
+			case OPCode::OP_LOOP:
+				break;
+
+			// Every other instruction is a binary operator.
+			default:
+				taken = 2;
+				pushed = 1;
+				break;
+		}
+
+		if (taken > depth)
+			return false;
+
+		depth += pushed - taken;
+
+		if (operation == OPCode::OP_JUMP || operation == OPCode::OP_JUMP_IF_FALSE || operation == OPCode::OP_LOOP)
+		{
+			size_t distance = (size_t)((code[index + 1] << 8) | code[index + 2]);
+			size_t next = index + 3;
+
+			if (operation == OPCode::OP_LOOP ? distance > next || !reach(next - distance, depth) : !reach(next + distance, depth))
+				return false;
+
+			if (operation != OPCode::OP_JUMP_IF_FALSE)
+				continue;
+		}
+
+		if (!reach(index + instructionLength(code[index]), depth))
+			return false;
+	}
+
+	return true;
+}
\ No newline at end of file
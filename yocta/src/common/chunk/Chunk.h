@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "OperationCodes.h"
@@ -7,6 +8,37 @@
 
 namespace yo
 {
+	class Chunk;
+
+	struct GlobalCache
+	{
+	public:
+		Value* value = nullptr;
+		uint32_t version = 0;
+	};
+
+	struct ChunkProfile
+	{
+	public:
+		static constexpr uint8_t SEEN_INTEGERS = 1 << 0;
+		static constexpr uint8_t SEEN_OTHER = 1 << 1;
+		static constexpr uint8_t MAX_DEOPTIMIZATIONS = 4;
+
+	public:
+		uint32_t invocations = 0;
+		uint32_t backEdges = 0;
+		std::vector<uint8_t> operandTypes;
+
+	public:
+		std::vector<GlobalCache> globalCaches;
+		std::vector<uint8_t> deoptimizations;
+
+	public:
+		std::shared_ptr<Chunk> optimized;
+		std::vector<int32_t> offsetMap;
+		bool optimizationFailed = false;
+	};
+
 	class Chunk
 	{
 	public:
@@ -21,9 +53,20 @@ namespace yo
 
 		void clear();
 
+		// Bytes held by the chunk, its profile and its optimized copy.
+		size_t footprint() const;
+
 	public:
 		std::vector<int> lines;
 		std::vector<uint8_t> data;
 		std::vector<Value> constantPool;
+
+	public:
+		ChunkProfile profile;
 	};
+
+	// The stack depth before each instruction of code already known to be made of whole instructions, or -1 for
+	// those no path reaches. False when a jump lands inside an instruction, paths disagree on a depth, an
+	// instruction takes more than the stack holds or names a local above it, or the code can run past its end.
+	bool stackDepths(const uint8_t* code, size_t size, std::vector<int>& depths);
 }
\ No newline at end of file
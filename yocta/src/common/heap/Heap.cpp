@@ -0,0 +1,538 @@
+#include "Heap.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "Value.h"
+#include "Table.h"
+#include "Coroutine.h"
+
+struct yo::Heap::RememberedEntry
+{
+public:
+	YoctaObject* map;
+	Value key;
+	int index;
+	uint32_t rehashes;
+};
+
+static_assert(sizeof(yo::StringObject) >= sizeof(yo::YoctaObject) + sizeof(void*), "A forwarded string must have room for its new address.");
+
+yo::Heap::Heap()
+	: oldSpace(&memoryAccount) { }
+
+yo::Heap::~Heap()
+{
+	for (YoctaObject* object : finalizers)
+	{
+		if (object->generation == Generation::YOUNG)
+			finalize(object);
+	}
+
+	for (std::vector<YoctaObject*>* objects : { &oldObjects, &sweepObjects })
+	{
+		for (YoctaObject* object : *objects)
+		{
+			size_t size = objectSize(object);
+
+			finalize(object);
+			oldSpace.deallocate(object, size);
+		}
+	}
+
+	// Permanent objects outlive this heap and must not look marked to the next one.
+	for (YoctaObject* object : markedPermanent)
+		object->marked = false;
+
+	if (nursery)
+		memoryAccount.release(NURSERY_SIZE);
+
+	::operator delete(nursery);
+}
+
+void* yo::Heap::allocateSlow(size_t size)
+{
+	// The nursery is only reserved once something is allocated, so idle VMs cost nothing.
+	if (!nursery)
+	{
+		nursery = static_cast<uint8_t*>(::operator new(NURSERY_SIZE));
+		memoryAccount.charge(NURSERY_SIZE);
+		cursor = nursery;
+		limit = nursery + NURSERY_SIZE;
+
+		if (size <= NURSERY_SIZE)
+			return allocate(size);
+	}
+
+	// A full nursery is only emptied at the next safe point; until then new objects go straight to the old space.
+	requested = true;
+	heapStatistics.pretenuredBytes += size;
+
+	return oldSpace.allocate(size);
+}
+
+void yo::Heap::adoptOld(YoctaObject* object, size_t size)
+{
+	object->generation = Generation::OLD;
+	object->marked = phase == Phase::MARKING;
+
+	oldObjects.push_back(object);
+	oldSize += size;
+
+	// It may be given young fields before the next minor collection.
+	remember(object);
+}
+
+void yo::Heap::rememberEntry(YoctaObject* map, const Value& key, int index, uint32_t rehashes)
+{
+	rememberedEntries.push_back({ map, key, index, rehashes });
+}
+
+void yo::Heap::shade(const Value& value)
+{
+	if (value.type == ValueType::VT_OBJECT)
+		shadeObject(std::get<YoctaObject*>(value.variantValue));
+}
+
+void yo::Heap::collect(HeapRoots& roots)
+{
+	requested = false;
+	inCollection = true;
+
+	auto start = std::chrono::steady_clock::now();
+	minorCollection(roots);
+
+	auto end = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(end - start).count();
+
+	++heapStatistics.minorCollections;
+	heapStatistics.minorSeconds += seconds;
+	heapStatistics.maxMinorSeconds = std::max(heapStatistics.maxMinorSeconds, seconds);
+
+	if (phase != Phase::IDLE || oldSize >= majorThreshold)
+	{
+		// Marking has to outpace promotion, or the old space would keep growing while it is being marked.
+		majorStep(roots, MARK_STEP + promotedObjects * 2);
+
+		double increment = std::chrono::duration<double>(std::chrono::steady_clock::now() - end).count();
+
+		heapStatistics.majorSeconds += increment;
+		heapStatistics.maxMajorSeconds = std::max(heapStatistics.maxMajorSeconds, increment);
+		seconds += increment;
+	}
+
+	heapStatistics.pauses.push_back(seconds);
+	inCollection = false;
+}
+
+void yo::Heap::collectFully(HeapRoots& roots)
+{
+	requested = false;
+	inCollection = true;
+
+	auto start = std::chrono::steady_clock::now();
+	minorCollection(roots);
+
+	// A cycle already underway keeps whatever died after it began, so a fresh one follows it.
+	for (int cycles = phase == Phase::IDLE ? 1 : 2; cycles > 0; --cycles)
+	{
+		do
+			majorStep(roots, SIZE_MAX);
+		while (phase != Phase::IDLE);
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	++heapStatistics.minorCollections;
+	heapStatistics.majorSeconds += seconds;
+	heapStatistics.maxMajorSeconds = std::max(heapStatistics.maxMajorSeconds, seconds);
+	heapStatistics.pauses.push_back(seconds);
+	inCollection = false;
+}
+
+void yo::Heap::trace(Value& value)
+{
+	if (value.type != ValueType::VT_OBJECT)
+		return;
+
+	YoctaObject*& object = std::get<YoctaObject*>(value.variantValue);
+	object = visit(object);
+}
+
+void yo::Heap::minorCollection(HeapRoots& roots)
+{
+	collection = Collection::MINOR;
+	promotedObjects = 0;
+
+	// Entries that moved in a rehash are found again by key, before anything is forwarded and keys become unreadable.
+	for (RememberedEntry& remembered : rememberedEntries)
+	{
+		const Table& table = static_cast<MapObject*>(remembered.map)->table;
+
+		if (table.rehashes() != remembered.rehashes)
+			remembered.index = table.slot(remembered.key);
+	}
+
+	roots.traceRoots(*this);
+
+	for (const RememberedEntry& remembered : rememberedEntries)
+	{
+		if (remembered.index == -1)
+			continue;
+
+		Table::Entry& entry = static_cast<MapObject*>(remembered.map)->table.entryAt(remembered.index);
+
+		trace(entry.key);
+		trace(entry.value);
+	}
+
+	rememberedEntries.clear();
+
+	for (YoctaObject* object : rememberedSet)
+	{
+		object->remembered = false;
+		traceChildren(object);
+	}
+
+	rememberedSet.clear();
+	drain();
+
+	// Promoted objects were moved out already; whatever is still young here is garbage.
+	for (YoctaObject* object : finalizers)
+	{
+		if (object->generation == Generation::YOUNG)
+			finalize(object);
+	}
+
+	finalizers.clear();
+	cursor = nursery;
+}
+
+void yo::Heap::majorStep(HeapRoots& roots, size_t budget)
+{
+	// Runs right after a minor collection, so the nursery is empty and every live object is old or permanent.
+	collection = Collection::MAJOR;
+
+	if (phase == Phase::IDLE)
+	{
+		phase = Phase::MARKING;
+		roots.traceRoots(*this);
+	}
+
+	if (phase == Phase::MARKING && mark(budget))
+	{
+		// The roots are not behind a barrier, so they are scanned again before marking is trusted.
+		roots.traceRoots(*this);
+		mark(SIZE_MAX);
+
+		for (YoctaObject* object : markedPermanent)
+			object->marked = false;
+
+		markedPermanent.clear();
+
+		// Objects promoted from now on are not part of this cycle and stay out of the sweep.
+		sweepObjects.swap(oldObjects);
+		phase = Phase::SWEEPING;
+	}
+	else if (phase == Phase::SWEEPING)
+		sweep(SWEEP_STEP);
+
+	collection = Collection::MINOR;
+}
+
+bool yo::Heap::mark(size_t budget)
+{
+	size_t work = 0;
+
+	while (work < budget)
+	{
+		if (scanning)
+		{
+			work += scanMap(budget - work);
+			continue;
+		}
+
+		if (markGray.empty())
+			return true;
+
+		YoctaObject* object = markGray.back();
+		markGray.pop_back();
+
+		if (object->type == ObjectType::MAP)
+		{
+			scanning = object;
+			scanIndex = 0;
+			scanRehashes = static_cast<MapObject*>(object)->table.rehashes();
+			continue;
+		}
+
+		traceChildren(object);
+		work += object->type == ObjectType::COROUTINE ? 1 + static_cast<CoroutineObject*>(object)->stack.size() : 1;
+	}
+
+	return false;
+}
+
+size_t yo::Heap::scanMap(size_t budget)
+{
+	Table& table = static_cast<MapObject*>(scanning)->table;
+
+	// A rehash moves entries behind the scan position, so the scan starts over.
+	if (table.rehashes() != scanRehashes)
+	{
+		scanIndex = 0;
+		scanRehashes = table.rehashes();
+	}
+
+	size_t work = 1;
+	int index = table.next(scanIndex);
+
+	for (; index != -1 && work < budget; index = table.next(index + 1), ++work)
+	{
+		Table::Entry& entry = table.entryAt(index);
+
+		trace(entry.key);
+		trace(entry.value);
+	}
+
+	if (index == -1)
+		scanning = nullptr;
+	else
+		scanIndex = index;
+
+	return work;
+}
+
+void yo::Heap::sweep(size_t budget)
+{
+	for (; budget > 0 && !sweepObjects.empty(); --budget)
+	{
+		YoctaObject* object = sweepObjects.back();
+		sweepObjects.pop_back();
+
+		if (object->marked)
+		{
+			object->marked = false;
+			oldObjects.push_back(object);
+			continue;
+		}
+
+		size_t size = objectSize(object);
+		oldSize -= size;
+
+		finalize(object);
+		oldSpace.deallocate(object, size);
+	}
+
+	if (!sweepObjects.empty())
+		return;
+
+	sweepObjects.shrink_to_fit();
+	oldSpace.trim();
+	phase = Phase::IDLE;
+
+	++heapStatistics.majorCollections;
+	majorThreshold = std::max(MIN_MAJOR_THRESHOLD, oldSize * 2);
+}
+
+yo::YoctaObject* yo::Heap::visit(YoctaObject* object)
+{
+	if (collection == Collection::MINOR)
+	{
+		if (object->generation == Generation::FORWARDED)
+			return static_cast<ForwardedObject*>(object)->forward;
+
+		if (object->generation == Generation::YOUNG)
+			return promote(object);
+	}
+
+	// Young objects reach old ones without a barrier, so a minor collection during marking shades what it passes.
+	if (collection == Collection::MAJOR || phase == Phase::MARKING)
+		shadeObject(object);
+
+	return object;
+}
+
+void yo::Heap::shadeObject(YoctaObject* object)
+{
+	if (object->marked || object->generation == Generation::YOUNG)
+		return;
+
+	// Permanent objects may be shared with other isolates, so only the mutable kinds are ever marked.
+	if (object->generation == Generation::PERMANENT)
+	{
+		if (!hasReferences(object->type))
+			return;
+
+		markedPermanent.push_back(object);
+	}
+
+	object->marked = true;
+
+	if (hasReferences(object->type))
+		markGray.push_back(object);
+}
+
+yo::YoctaObject* yo::Heap::promote(YoctaObject* object)
+{
+	size_t size = objectSize(object);
+	void* memory = oldSpace.allocate(size);
+	YoctaObject* copy = nullptr;
+
+	switch (object->type)
+	{
+		case ObjectType::STRING:
+			copy = static_cast<YoctaObject*>(std::memcpy(memory, object, size));
+			break;
+
+		case ObjectType::ROPE:
+			copy = new (memory) RopeObject(*static_cast<RopeObject*>(object));
+			break;
+
+		case ObjectType::MAP:
+			copy = new (memory) MapObject(std::move(*static_cast<MapObject*>(object)));
+			static_cast<MapObject*>(object)->~MapObject();
+			break;
+
+		case ObjectType::NUMERIC_ARRAY:
+			copy = new (memory) NumericArrayObject(std::move(*static_cast<NumericArrayObject*>(object)));
+			static_cast<NumericArrayObject*>(object)->~NumericArrayObject();
+			break;
+
+		case ObjectType::NATIVE:
+			copy = new (memory) NativeObject(*static_cast<NativeObject*>(object));
+			break;
+
+		case ObjectType::PROTOTYPE:
+			copy = new (memory) PrototypeObject(std::move(*static_cast<PrototypeObject*>(object)));
+			static_cast<PrototypeObject*>(object)->~PrototypeObject();
+			break;
+
+		case ObjectType::COROUTINE:
+			copy = new (memory) CoroutineObject(std::move(*static_cast<CoroutineObject*>(object)));
+			static_cast<CoroutineObject*>(object)->~CoroutineObject();
+			break;
+
+		default:
+			break;
+	}
+
+	copy->generation = Generation::OLD;
+	copy->remembered = false;
+	copy->marked = phase == Phase::MARKING;
+
+	object->generation = Generation::FORWARDED;
+	static_cast<ForwardedObject*>(object)->forward = copy;
+
+	oldObjects.push_back(copy);
+	oldSize += size;
+	heapStatistics.promotedBytes += size;
+	++promotedObjects;
+
+	if (hasReferences(copy->type))
+		gray.push_back(copy);
+
+	return copy;
+}
+
+void yo::Heap::traceChildren(YoctaObject* object)
+{
+	switch (object->type)
+	{
+		case ObjectType::ROPE:
+		{
+			RopeObject* rope = static_cast<RopeObject*>(object);
+
+			trace(rope->left);
+			trace(rope->right);
+			trace(rope->flat);
+			break;
+		}
+
+		case ObjectType::MAP:
+		{
+			Table& table = static_cast<MapObject*>(object)->table;
+
+			for (int index = table.next(0); index != -1; index = table.next(index + 1))
+			{
+				Table::Entry& entry = table.entryAt(index);
+
+				trace(entry.key);
+				trace(entry.value);
+			}
+			break;
+		}
+
+		case ObjectType::COROUTINE:
+		{
+			CoroutineObject* coroutine = static_cast<CoroutineObject*>(object);
+
+			for (Value& value : coroutine->stack)
+				trace(value);
+
+			trace(coroutine->caller);
+			break;
+		}
+
+		default:
+			break;
+	}
+}
+
+void yo::Heap::drain()
+{
+	while (!gray.empty())
+	{
+		YoctaObject* object = gray.back();
+		gray.pop_back();
+
+		traceChildren(object);
+	}
+}
+
+size_t yo::Heap::objectSize(const YoctaObject* object)
+{
+	switch (object->type)
+	{
+		case ObjectType::STRING: return sizeof(StringObject) + static_cast<const StringObject*>(object)->length + 1;
+		case ObjectType::ROPE: return sizeof(RopeObject);
+		case ObjectType::MAP: return sizeof(MapObject);
+		case ObjectType::NUMERIC_ARRAY: return sizeof(NumericArrayObject);
+		case ObjectType::NATIVE: return sizeof(NativeObject);
+		case ObjectType::PROTOTYPE: return sizeof(PrototypeObject);
+		case ObjectType::COROUTINE: return sizeof(CoroutineObject);
+		default: return sizeof(YoctaObject);
+	}
+}
+
+bool yo::Heap::hasReferences(ObjectType type)
+{
+	return type == ObjectType::ROPE || type == ObjectType::MAP || type == ObjectType::COROUTINE;
+}
+
+void yo::Heap::finalize(YoctaObject* object)
+{
+	switch (object->type)
+	{
+		case ObjectType::MAP:
+			memoryAccount.release(static_cast<MapObject*>(object)->table.footprint());
+			static_cast<MapObject*>(object)->~MapObject();
+			break;
+
+		case ObjectType::NUMERIC_ARRAY:
+			memoryAccount.release(static_cast<NumericArrayObject*>(object)->data.capacity() * sizeof(double));
+			static_cast<NumericArrayObject*>(object)->~NumericArrayObject();
+			break;
+
+		case ObjectType::PROTOTYPE:
+			static_cast<PrototypeObject*>(object)->~PrototypeObject();
+			break;
+
+		case ObjectType::COROUTINE:
+			static_cast<CoroutineObject*>(object)->~CoroutineObject();
+			break;
+
+		default:
+			break;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,311 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "YoctaObject.h"
+#include "SlabAllocator.h"
+#include "MemoryAccount.h"
+
+namespace yo
+{
+	struct Value;
+	class Heap;
+
+	class HeapRoots
+	{
+	public:
+		virtual ~HeapRoots() = default;
+
+	public:
+		virtual void traceRoots(Heap& heap) = 0;
+	};
+
+	struct HeapStatistics
+	{
+	public:
+		size_t minorCollections = 0;
+		size_t majorCollections = 0;
+		size_t promotedBytes = 0;
+		size_t pretenuredBytes = 0;
+
+	public:
+		double minorSeconds = 0.0;
+		double maxMinorSeconds = 0.0;
+		double majorSeconds = 0.0;
+		double maxMajorSeconds = 0.0;
+
+	public:
+		// Every pause a collection made, minor work and major increments together.
+		std::vector<double> pauses;
+	};
+
+	// Objects a VM creates while running. They are bump-allocated in the nursery, and a minor collection
+	// copies the ones still reachable from the roots or the remembered set into the old space. Once the
+	// old space has doubled it is marked and swept in increments that follow the minor collections, so
+	// no single pause has to walk all of it.
+	class Heap
+	{
+		// Compiled loops poll for a requested collection without calling out.
+		friend class BaselineJit;
+
+	public:
+		static constexpr size_t NURSERY_SIZE = 1024 * 1024;
+		static constexpr size_t MIN_MAJOR_THRESHOLD = 16 * 1024 * 1024;
+		static constexpr size_t MARK_STEP = 32768;
+		static constexpr size_t SWEEP_STEP = 65536;
+
+	public:
+		// Makes a heap the allocation target of the current thread; nullptr makes new objects permanent.
+		class Scope
+		{
+		public:
+			explicit Scope(Heap* heap)
+				: previous(current)
+			{
+				current = heap;
+				MemoryAccount::activeAccount = heap ? &heap->memoryAccount : nullptr;
+			}
+
+			~Scope()
+			{
+				current = previous;
+				MemoryAccount::activeAccount = previous ? &previous->memoryAccount : nullptr;
+			}
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			Heap* previous;
+		};
+
+	public:
+		Heap();
+
+		~Heap();
+
+		Heap(const Heap&) = delete;
+		Heap& operator=(const Heap&) = delete;
+
+	public:
+		static Heap* active() { return current; }
+
+		void* allocate(size_t size)
+		{
+			size = (size + 7) & ~(size_t)7;
+
+			if (size > (size_t)(limit - cursor))
+				return allocateSlow(size);
+
+			void* memory = cursor;
+			cursor += size;
+			return memory;
+		}
+
+		template<typename Object>
+		void adopt(Object* object, size_t size, bool finalized)
+		{
+			// Arrays never change length, so their buffer is charged once here and released when they die.
+			if constexpr (std::is_same<Object, NumericArrayObject>::value)
+				memoryAccount.charge(object->data.capacity() * sizeof(double));
+
+			if ((uint8_t*)object < nursery || (uint8_t*)object >= limit)
+				return adoptOld(object, size);
+
+			object->generation = Generation::YOUNG;
+
+			if (finalized)
+				finalizers.push_back(object);
+		}
+
+		// The write barrier: an old or permanent object that may now point into the nursery.
+		void remember(YoctaObject* object)
+		{
+			if (object->remembered)
+				return;
+
+			object->remembered = true;
+			rememberedSet.push_back(object);
+		}
+
+		// Maps grow in place, so the VM charges what their storage grew by; the heap releases it when they die.
+		void chargeGrowth(const YoctaObject* object, size_t before, size_t after)
+		{
+			if (object->generation == Generation::PERMANENT || before == after)
+				return;
+
+			memoryAccount.charge(after);
+			memoryAccount.release(before);
+		}
+
+		// Remembers a single map entry, so one store into a large old map does not rescan all of it.
+		void rememberEntry(YoctaObject* map, const Value& key, int index, uint32_t rehashes);
+
+		// The marking barrier: an old object stored while marking must not be missed by a map already scanned.
+		void shade(const Value& value);
+
+		bool marking() const { return phase == Phase::MARKING; }
+
+	public:
+		// Going over the memory limit asks for a collection too, so the VM checks the limit at the same safe points.
+		bool collectionRequested() const { return requested || memoryAccount.exceeded(); }
+
+		void collect(HeapRoots& roots);
+
+		// Finishes the current major cycle, or runs a whole one, without spreading it over increments.
+		void collectFully(HeapRoots& roots);
+
+		bool collecting() const { return inCollection; }
+
+	public:
+		void trace(Value& value);
+
+		template<typename Object>
+		void trace(Object*& object)
+		{
+			if (object)
+				object = static_cast<Object*>(visit(object));
+		}
+
+	public:
+		const HeapStatistics& statistics() const { return heapStatistics; }
+
+		size_t youngBytes() const { return cursor - nursery; }
+
+		size_t oldBytes() const { return oldSize; }
+
+		const SlabAllocator& slabs() const { return oldSpace; }
+
+		MemoryAccount& account() { return memoryAccount; }
+
+		const MemoryAccount& account() const { return memoryAccount; }
+
+		void enableHugePages(bool enable) { oldSpace.enableHugePages(enable); }
+
+	private:
+		enum class Collection
+		{
+			MINOR,
+			MAJOR
+		};
+
+		enum class Phase
+		{
+			IDLE,
+			MARKING,
+			SWEEPING
+		};
+
+		struct ForwardedObject : public YoctaObject
+		{
+		public:
+			YoctaObject* forward;
+		};
+
+		struct RememberedEntry;
+
+	private:
+		void* allocateSlow(size_t size);
+
+		void adoptOld(YoctaObject* object, size_t size);
+
+	private:
+		void minorCollection(HeapRoots& roots);
+
+		void majorStep(HeapRoots& roots, size_t budget);
+
+		bool mark(size_t budget);
+
+		size_t scanMap(size_t budget);
+
+		void sweep(size_t budget);
+
+		YoctaObject* visit(YoctaObject* object);
+
+		void shadeObject(YoctaObject* object);
+
+		YoctaObject* promote(YoctaObject* object);
+
+		void traceChildren(YoctaObject* object);
+
+		void drain();
+
+	private:
+		static size_t objectSize(const YoctaObject* object);
+
+		static bool hasReferences(ObjectType type);
+
+		void finalize(YoctaObject* object);
+
+	private:
+		static inline thread_local Heap* current = nullptr;
+
+	private:
+		MemoryAccount memoryAccount;
+
+	private:
+		uint8_t* nursery = nullptr;
+		uint8_t* cursor = nullptr;
+		uint8_t* limit = nullptr;
+		std::vector<YoctaObject*> finalizers;
+		std::vector<YoctaObject*> rememberedSet;
+		std::vector<RememberedEntry> rememberedEntries;
+
+	private:
+		SlabAllocator oldSpace;
+		std::vector<YoctaObject*> oldObjects;
+		size_t oldSize = 0;
+		size_t majorThreshold = MIN_MAJOR_THRESHOLD;
+
+	private:
+		Phase phase = Phase::IDLE;
+		std::vector<YoctaObject*> markGray;
+		std::vector<YoctaObject*> markedPermanent;
+		std::vector<YoctaObject*> sweepObjects;
+		YoctaObject* scanning = nullptr;
+		int scanIndex = 0;
+		uint32_t scanRehashes = 0;
+
+	private:
+		Collection collection = Collection::MINOR;
+		std::vector<YoctaObject*> gray;
+		size_t promotedObjects = 0;
+		bool requested = false;
+		bool inCollection = false;
+		HeapStatistics heapStatistics;
+	};
+
+	template<typename T, typename... Arguments>
+	T* createObject(Arguments&&... arguments)
+	{
+		Heap* heap = Heap::active();
+		if (!heap)
+			return new T(std::forward<Arguments>(arguments)...);
+
+		T* object = new (heap->allocate(sizeof(T))) T(std::forward<Arguments>(arguments)...);
+		heap->adopt(object, sizeof(T), !std::is_trivially_destructible<T>::value);
+
+		return object;
+	}
+
+	// Strings come from makeString or from flattening a rope, and neither is allowed past MAX_LENGTH.
+	inline StringObject* StringObject::create(const char* chars, size_t length)
+	{
+		Heap* heap = Heap::active();
+		size_t size = sizeof(StringObject) + length + 1;
+
+		void* memory = heap ? heap->allocate(size) : ::operator new(size);
+		StringObject* string = new (memory) StringObject((uint32_t)length, hashString(chars, length));
+
+		std::memcpy(string->chars(), chars, length);
+		string->chars()[length] = '\0';
+
+		if (heap)
+			heap->adopt(string, size, false);
+
+		return string;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+namespace yo
+{
+	// The bytes one VM holds. Memory is charged where it is reserved in bulk (nursery, slab pages, stack,
+	// table and array buffers), so the object allocation fast path never touches it. Going over the limit
+	// does not fail an allocation: the VM notices at its next safe point and raises a runtime error.
+	class MemoryAccount
+	{
+	public:
+		void charge(size_t bytes)
+		{
+			used += bytes;
+
+			if (used > peakUsed)
+				peakUsed = used;
+		}
+
+		void release(size_t bytes) { used -= bytes; }
+
+		bool exceeded() const { return used > byteLimit; }
+
+		bool fits(size_t bytes) const { return bytes <= byteLimit && used <= byteLimit - bytes; }
+
+	public:
+		// Zero removes the limit.
+		void setLimit(size_t bytes) { byteLimit = bytes ? bytes : SIZE_MAX; }
+
+		size_t limit() const { return byteLimit; }
+
+		size_t current() const { return used; }
+
+		size_t peak() const { return peakUsed; }
+
+	public:
+		// The account of the VM running on this thread, which containers made without one are charged to.
+		static MemoryAccount* active() { return activeAccount; }
+
+	private:
+		friend class Heap;
+		friend class BaselineJit;
+
+		static inline thread_local MemoryAccount* activeAccount = nullptr;
+
+	private:
+		size_t used = 0;
+		size_t peakUsed = 0;
+		size_t byteLimit = SIZE_MAX;
+	};
+
+	template<typename T>
+	class AccountingAllocator
+	{
+	public:
+		using value_type = T;
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+
+	public:
+		AccountingAllocator()
+			: account(MemoryAccount::active()) { }
+
+		explicit AccountingAllocator(MemoryAccount* account)
+			: account(account) { }
+
+		template<typename U>
+		AccountingAllocator(const AccountingAllocator<U>& other)
+			: account(other.account) { }
+
+	public:
+		T* allocate(size_t count)
+		{
+			if (account)
+				account->charge(count * sizeof(T));
+
+			return static_cast<T*>(::operator new(count * sizeof(T)));
+		}
+
+		void deallocate(T* memory, size_t count)
+		{
+			if (account)
+				account->release(count * sizeof(T));
+
+			::operator delete(memory);
+		}
+
+	public:
+		template<typename U>
+		bool operator==(const AccountingAllocator<U>& other) const { return account == other.account; }
+
+		template<typename U>
+		bool operator!=(const AccountingAllocator<U>& other) const { return account != other.account; }
+
+	private:
+		template<typename U>
+		friend class AccountingAllocator;
+
+		MemoryAccount* account;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "SlabAllocator.h"
+
+#if defined(__linux__)
+#define YOCTA_MADVISE_SUPPORTED
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+	// Slots start past the page header, at an offset every size class keeps 8-byte aligned.
+	constexpr size_t HEADER_SIZE = 64;
+}
+
+yo::SlabAllocator::SlabAllocator(MemoryAccount* account)
+	: account(account)
+{
+	static_assert(sizeof(Page) <= HEADER_SIZE, "The page header must fit in front of the first slot.");
+
+	for (size_t index = 0, slot = 0; index < sizeof(classIndices); ++index)
+	{
+		while (SLOT_SIZES[slot] < index * 8)
+			++slot;
+
+		classIndices[index] = (uint8_t)slot;
+	}
+
+	for (size_t index = 0; index < CLASS_COUNT; ++index)
+	{
+		classes[index].slotSize = SLOT_SIZES[index];
+		classes[index].index = (uint8_t)index;
+	}
+}
+
+yo::SlabAllocator::~SlabAllocator()
+{
+	for (void* chunk : chunks)
+		::operator delete(chunk, std::align_val_t(CHUNK_SIZE));
+}
+
+void yo::SlabAllocator::trim()
+{
+	while (pooledPages > RETAINED_PAGES)
+	{
+		Page* page = pooled;
+		pooled = page->next;
+		--pooledPages;
+
+		#ifdef YOCTA_MADVISE_SUPPORTED
+		// The header lives in the page too, so it is rebuilt when the page is taken again.
+		madvise(page, PAGE_SIZE, MADV_DONTNEED);
+		#endif
+
+		page->next = released;
+		released = page;
+	}
+}
+
+void* yo::SlabAllocator::allocateSlow(SizeClass& sizeClass)
+{
+	Page* page = sizeClass.available;
+
+	// Pages fill their free list lazily from the untouched end, and leave the list once both are used up.
+	while (page && !page->freeList)
+	{
+		if (page->bump + page->slotSize <= (uint8_t*)page + PAGE_SIZE)
+		{
+			void* memory = page->bump;
+			page->bump += page->slotSize;
+			++page->live;
+
+			return memory;
+		}
+
+		unlink(sizeClass, page);
+		page = sizeClass.available;
+	}
+
+	if (!page)
+	{
+		page = takePage();
+		page->freeList = nullptr;
+		page->bump = (uint8_t*)page + HEADER_SIZE;
+		page->live = 0;
+		page->slotSize = sizeClass.slotSize;
+		page->sizeClass = sizeClass.index;
+
+		link(sizeClass, page);
+		return allocateSlow(sizeClass);
+	}
+
+	FreeSlot* slot = page->freeList;
+	page->freeList = slot->next;
+	++page->live;
+
+	return slot;
+}
+
+void* yo::SlabAllocator::allocateLarge(size_t size)
+{
+	// Callers may pass the exact or the aligned size of the same object, so both are charged alike.
+	if (account)
+		account->charge((size + 7) & ~(size_t)7);
+
+	return ::operator new(size);
+}
+
+void yo::SlabAllocator::deallocateLarge(void* memory, size_t size)
+{
+	if (account)
+		account->release((size + 7) & ~(size_t)7);
+
+	::operator delete(memory);
+}
+
+void yo::SlabAllocator::deallocateSlow(Page* page)
+{
+	SizeClass& sizeClass = classes[page->sizeClass];
+
+	if (!page->listed)
+		link(sizeClass, page);
+
+	if (page->live > 0)
+		return;
+
+	unlink(sizeClass, page);
+
+	page->next = pooled;
+	pooled = page;
+	++pooledPages;
+	--usedPages;
+
+	if (account)
+		account->release(PAGE_SIZE);
+}
+
+yo::SlabAllocator::Page* yo::SlabAllocator::takePage()
+{
+	++usedPages;
+
+	if (account)
+		account->charge(PAGE_SIZE);
+
+	if (Page* page = pooled)
+	{
+		pooled = page->next;
+		--pooledPages;
+
+		return page;
+	}
+
+	if (Page* page = released)
+	{
+		released = page->next;
+		return page;
+	}
+
+	if (chunkCursor == chunkLimit)
+	{
+		void* chunk = ::operator new(CHUNK_SIZE, std::align_val_t(CHUNK_SIZE));
+
+		#ifdef YOCTA_MADVISE_SUPPORTED
+		if (hugePages)
+			madvise(chunk, CHUNK_SIZE, MADV_HUGEPAGE);
+		#endif
+
+		chunks.push_back(chunk);
+		chunkCursor = static_cast<uint8_t*>(chunk);
+		chunkLimit = chunkCursor + CHUNK_SIZE;
+	}
+
+	Page* page = reinterpret_cast<Page*>(chunkCursor);
+	chunkCursor += PAGE_SIZE;
+
+	return page;
+}
+
+void yo::SlabAllocator::link(SizeClass& sizeClass, Page* page)
+{
+	page->previous = nullptr;
+	page->next = sizeClass.available;
+
+	if (sizeClass.available)
+		sizeClass.available->previous = page;
+
+	sizeClass.available = page;
+	page->listed = true;
+}
+
+void yo::SlabAllocator::unlink(SizeClass& sizeClass, Page* page)
+{
+	if (page->previous)
+		page->previous->next = page->next;
+	else
+		sizeClass.available = page->next;
+
+	if (page->next)
+		page->next->previous = page->previous;
+
+	page->listed = false;
+}
\ No newline at end of file
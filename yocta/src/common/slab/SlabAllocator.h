@@ -0,0 +1,138 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+#include "MemoryAccount.h"
+
+namespace yo
+{
+	// Fixed-size slots for objects that outlive the nursery. Every page serves one size class and keeps
+	// its own free list; a page whose objects have all died goes back to a pool that any class can take
+	// from. Objects larger than the biggest class fall through to the global allocator. Pages in use and
+	// large objects are charged to the account; pooled pages are not.
+	class SlabAllocator
+	{
+	public:
+		static constexpr size_t PAGE_SIZE = 64 * 1024;
+		static constexpr size_t CHUNK_SIZE = 2 * 1024 * 1024;
+		static constexpr size_t MAX_SLOT_SIZE = 256;
+		static constexpr size_t RETAINED_PAGES = 64;
+
+	public:
+		explicit SlabAllocator(MemoryAccount* account = nullptr);
+
+		~SlabAllocator();
+
+		SlabAllocator(const SlabAllocator&) = delete;
+		SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+	public:
+		void* allocate(size_t size)
+		{
+			if (size > MAX_SLOT_SIZE)
+				return allocateLarge(size);
+
+			SizeClass& sizeClass = classes[classIndices[(size + 7) >> 3]];
+			Page* page = sizeClass.available;
+
+			if (!page || !page->freeList)
+				return allocateSlow(sizeClass);
+
+			FreeSlot* slot = page->freeList;
+			page->freeList = slot->next;
+			++page->live;
+
+			return slot;
+		}
+
+		void deallocate(void* memory, size_t size)
+		{
+			if (size > MAX_SLOT_SIZE)
+				return deallocateLarge(memory, size);
+
+			Page* page = reinterpret_cast<Page*>((uintptr_t)memory & ~(uintptr_t)(PAGE_SIZE - 1));
+			FreeSlot* slot = static_cast<FreeSlot*>(memory);
+
+			slot->next = page->freeList;
+			page->freeList = slot;
+
+			if (--page->live == 0 || !page->listed)
+				deallocateSlow(page);
+		}
+
+		// Gives the memory of pooled pages beyond RETAINED_PAGES back to the system; they stay mapped for reuse.
+		void trim();
+
+		// Chunks reserved from now on ask for transparent huge pages, where the system has them.
+		void enableHugePages(bool enable) { hugePages = enable; }
+
+	public:
+		size_t pageBytes() const { return usedPages * PAGE_SIZE; }
+
+		size_t chunkBytes() const { return chunks.size() * CHUNK_SIZE; }
+
+	private:
+		struct FreeSlot
+		{
+		public:
+			FreeSlot* next;
+		};
+
+		struct Page
+		{
+		public:
+			Page* next;
+			Page* previous;
+			FreeSlot* freeList;
+			uint8_t* bump;
+			uint32_t live;
+			uint16_t slotSize;
+			uint8_t sizeClass;
+			bool listed;
+		};
+
+		struct SizeClass
+		{
+		public:
+			Page* available = nullptr;
+			uint16_t slotSize = 0;
+			uint8_t index = 0;
+		};
+
+	private:
+		static constexpr size_t CLASS_COUNT = 16;
+		static constexpr uint16_t SLOT_SIZES[CLASS_COUNT] = { 16, 24, 32, 40, 48, 56, 64, 72, 80, 96, 112, 128, 160, 192, 208, 256 };
+
+	private:
+		void* allocateSlow(SizeClass& sizeClass);
+
+		void* allocateLarge(size_t size);
+
+		void deallocateLarge(void* memory, size_t size);
+
+		void deallocateSlow(Page* page);
+
+		Page* takePage();
+
+		void link(SizeClass& sizeClass, Page* page);
+
+		void unlink(SizeClass& sizeClass, Page* page);
+
+	private:
+		SizeClass classes[CLASS_COUNT];
+		uint8_t classIndices[MAX_SLOT_SIZE / 8 + 1];
+
+	private:
+		MemoryAccount* account;
+		std::vector<void*> chunks;
+		uint8_t* chunkCursor = nullptr;
+		uint8_t* chunkLimit = nullptr;
+		Page* pooled = nullptr;
+		Page* released = nullptr;
+		size_t pooledPages = 0;
+		size_t usedPages = 0;
+		bool hugePages = false;
+	};
+}
\ No newline at end of file
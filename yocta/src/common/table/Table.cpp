@@ -0,0 +1,274 @@
+#include "Table.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	// The maps being printed on this thread, outermost first; isolates print from several threads at once.
+	thread_local std::vector<const yo::MapObject*> displayedMaps;
+}
+
+uint64_t yo::hashValue(const Value& value)
+{
+	uint64_t hash = 0;
+
+	switch (value.type)
+	{
+		case ValueType::VT_NONE:
+			hash = 0x2545F491;
+			break;
+
+		case ValueType::VT_BOOL:
+			hash = std::get<bool>(value.variantValue) ? 0x9E3779B1 : 0x85EBCA77;
+			break;
+
+		case ValueType::VT_NUMERIC:
+		{
+			double number = std::get<double>(value.variantValue);
+
+			// NaN has many bit patterns and equals nothing, so every NaN hashes, and is looked up, as one key.
+			if (std::isnan(number))
+			{
+				hash = 0x7FF8000000000000ULL;
+				break;
+			}
+
+			if (number >= -9.2e18 && number <= 9.2e18 && number == (double)(int64_t)number)
+			{
+				hash = (uint64_t)(int64_t)number;
+				break;
+			}
+
+			std::memcpy(&hash, &number, sizeof(hash));
+			hash ^= hash >> 33;
+			break;
+		}
+
+		case ValueType::VT_INTEGER:
+			hash = (uint64_t)std::get<int64_t>(value.variantValue);
+			break;
+
+		case ValueType::VT_SHORT_STRING:
+			hash = stringHash(value);
+			break;
+
+		case ValueType::VT_OBJECT:
+		{
+			YoctaObject* object = std::get<YoctaObject*>(value.variantValue);
+
+			if (object->type == ObjectType::STRING || object->type == ObjectType::ROPE)
+				hash = stringHash(value);
+			else
+				hash = object->identity;
+			break;
+		}
+	}
+
+	return hash * 0x9E3779B97F4A7C15ULL;
+}
+
+void yo::displayMap(const Value& value)
+{
+	const MapObject* map = getMapObject(value);
+
+	// A map reachable from itself is printed once; the inner occurrences are elided.
+	if (std::find(displayedMaps.begin(), displayedMaps.end(), map) != displayedMaps.end())
+	{
+		printf("{...}");
+		return;
+	}
+
+	displayedMaps.push_back(map);
+
+	const Table& table = map->table;
+
+	printf("{");
+
+	for (int index = table.next(0), first = 1; index != -1; index = table.next(index + 1), first = 0)
+	{
+		const Table::Entry& entry = table.entryAt(index);
+
+		printf(first ? "" : ", ");
+		displayValue(entry.key);
+		printf(": ");
+		displayValue(entry.value);
+	}
+
+	printf("}");
+
+	displayedMaps.pop_back();
+}
+
+yo::Value* yo::Table::find(const Value& key)
+{
+	if (count == 0)
+		return nullptr;
+
+	int index = probe(key, hashValue(key));
+	return isFull(controls[index]) ? &entries[index].value : nullptr;
+}
+
+const yo::Value* yo::Table::find(const Value& key) const
+{
+	return const_cast<Table*>(this)->find(key);
+}
+
+bool yo::Table::insert(const Value& key, const Value& value)
+{
+	if ((count + tombstones + 1) * 8 > controls.size() * 7)
+		rehash(count * 2 >= controls.size() ? controls.size() * 2 : controls.size());
+
+	uint64_t hash = hashValue(key);
+	int index = probe(key, hash);
+
+	if (isFull(controls[index]))
+	{
+		entries[index].value = value;
+		return false;
+	}
+
+	if (controls[index] == CONTROL_DELETED)
+		--tombstones;
+
+	controls[index] = controlHash(hash);
+	entries[index] = { key, value };
+	++count;
+
+	return true;
+}
+
+int yo::Table::slot(const Value& key) const
+{
+	if (count == 0)
+		return -1;
+
+	int index = probe(key, hashValue(key));
+	return isFull(controls[index]) ? index : -1;
+}
+
+bool yo::Table::erase(const Value& key)
+{
+	if (count == 0)
+		return false;
+
+	int index = probe(key, hashValue(key));
+	if (!isFull(controls[index]))
+		return false;
+
+	controls[index] = CONTROL_DELETED;
+	entries[index] = {};
+	++layoutVersion;
+
+	--count;
+	++tombstones;
+
+	return true;
+}
+
+void yo::Table::clear()
+{
+	controls.clear();
+	entries.clear();
+	count = 0;
+	tombstones = 0;
+	++layoutVersion;
+}
+
+bool yo::Table::restore(std::vector<uint8_t> savedControls)
+{
+	controls = std::move(savedControls);
+	entries.assign(controls.size(), {});
+	count = 0;
+	tombstones = 0;
+	++layoutVersion;
+
+	for (uint8_t control : controls)
+	{
+		count += isFull(control);
+		tombstones += control == CONTROL_DELETED;
+	}
+
+	size_t size = controls.size();
+
+	// Probing masks with the capacity and stops at an empty slot, which insert always leaves at least one of.
+	bool valid = size == 0 || (size >= 8 && (size & (size - 1)) == 0 && (count + tombstones) * 8 <= size * 7);
+
+	for (size_t index = 0; valid && index < size; ++index)
+		valid = isFull(controls[index]) || controls[index] == CONTROL_EMPTY || controls[index] == CONTROL_DELETED;
+
+	if (!valid)
+		clear();
+
+	return valid;
+}
+
+int yo::Table::next(int index) const
+{
+	for (int size = (int)controls.size(); index < size; ++index)
+	{
+		if (isFull(controls[index]))
+			return index;
+	}
+
+	return -1;
+}
+
+int yo::Table::probe(const Value& key, uint64_t hash) const
+{
+	size_t mask = controls.size() - 1;
+	size_t index = (size_t)(hash >> 7) & mask;
+	uint8_t h2 = controlHash(hash);
+
+	int firstDeleted = -1;
+
+	while (true)
+	{
+		uint8_t control = controls[index];
+
+		if (control == CONTROL_EMPTY)
+			return firstDeleted != -1 ? firstDeleted : (int)index;
+
+		if (control == CONTROL_DELETED)
+		{
+			if (firstDeleted == -1)
+				firstDeleted = (int)index;
+		}
+		else if (control == h2 && keysEqual(entries[index].key, key))
+			return (int)index;
+
+		index = (index + 1) & mask;
+	}
+}
+
+void yo::Table::rehash(size_t newCapacity)
+{
+	if (newCapacity < 8)
+		newCapacity = 8;
+
+	std::vector<uint8_t> oldControls(newCapacity, CONTROL_EMPTY);
+	std::vector<Entry> oldEntries(newCapacity);
+
+	oldControls.swap(controls);
+	oldEntries.swap(entries);
+
+	tombstones = 0;
+	++layoutVersion;
+	++rehashCount;
+
+	size_t mask = newCapacity - 1;
+	for (size_t i = 0; i < oldControls.size(); ++i)
+	{
+		if (!isFull(oldControls[i]))
+			continue;
+
+		uint64_t hash = hashValue(oldEntries[i].key);
+		size_t index = (size_t)(hash >> 7) & mask;
+
+		while (controls[index] != CONTROL_EMPTY)
+			index = (index + 1) & mask;
+
+		controls[index] = controlHash(hash);
+		entries[index] = std::move(oldEntries[i]);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "YoctaObject.h"
+#include "Value.h"
+
+namespace yo
+{
+	uint64_t hashValue(const Value& value);
+
+	class Table
+	{
+		// Compiled global accesses check their caches against the layout version without calling out.
+		friend class BaselineJit;
+
+	public:
+		struct Entry
+		{
+			Value key;
+			Value value;
+		};
+
+	public:
+		Table() = default;
+
+	public:
+		Value* find(const Value& key);
+
+		const Value* find(const Value& key) const;
+
+		bool insert(const Value& key, const Value& value);
+
+		bool erase(const Value& key);
+
+		int slot(const Value& key) const;
+
+		void clear();
+
+		// Takes over the control bytes of a table saved elsewhere, so no key is hashed again. The caller then fills
+		// every full slot through entryAt, with the key it held there. False, leaving the table empty, when the
+		// bytes could not have come from a table.
+		bool restore(std::vector<uint8_t> savedControls);
+
+	public:
+		int next(int index) const;
+
+		const Entry& entryAt(int index) const { return entries[index]; }
+
+		// Lets the collector update the objects an entry points at; it must not change what a key hashes to.
+		Entry& entryAt(int index) { return entries[index]; }
+
+		uint8_t controlAt(int index) const { return controls[index]; }
+
+		size_t size() const { return count; }
+
+		size_t capacity() const { return controls.size(); }
+
+		size_t footprint() const { return controls.capacity() + entries.capacity() * sizeof(Entry); }
+
+		uint32_t version() const { return layoutVersion; }
+
+		uint32_t rehashes() const { return rehashCount; }
+
+	private:
+		int probe(const Value& key, uint64_t hash) const;
+
+		void rehash(size_t newCapacity);
+
+	private:
+		static constexpr uint8_t CONTROL_EMPTY = 0x80;
+		static constexpr uint8_t CONTROL_DELETED = 0xFE;
+
+		static uint8_t controlHash(uint64_t hash) { return (uint8_t)(hash & 0x7F); }
+
+		static bool isFull(uint8_t control) { return (control & 0x80) == 0; }
+
+		static bool keysEqual(const Value& lhs, const Value& rhs) { return lhs == rhs || (isNaN(lhs) && isNaN(rhs)); }
+
+		static bool isNaN(const Value& value) { return value.type == ValueType::VT_NUMERIC && std::isnan(std::get<double>(value.variantValue)); }
+
+	private:
+		std::vector<uint8_t> controls;
+		std::vector<Entry> entries;
+		size_t count = 0;
+		size_t tombstones = 0;
+		uint32_t layoutVersion = 0;
+		uint32_t rehashCount = 0;
+	};
+
+	struct MapObject : public YoctaObject
+	{
+	public:
+		MapObject()
+			: YoctaObject(ObjectType::MAP) { }
+
+	public:
+		Table table;
+	};
+
+	inline MapObject* getMapObject(const Value& value)
+	{
+		return static_cast<MapObject*>(std::get<YoctaObject*>(value.variantValue));
+	}
+}
\ No newline at end of file
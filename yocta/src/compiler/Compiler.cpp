@@ -1,17 +1,29 @@
+#include <charconv>
+#include <cstring>
+
 #include "Debug.h"
 #include "Compiler.h"
 #include "Disassembler.h"
 
 yo::Compiler::Compiler()
+	: localStack(arena)
 {
-	intializeParserRules();
 }
 
 bool yo::Compiler::compile(const char* source, Chunk* chunk)
 {
+	// Constants outlive any run and may be shared between isolates, so they never live in a VM heap.
+	Heap::Scope detached(nullptr);
+
 	lexer.open(source);
 	currentChunk = chunk;
 
+	// Bytecode runs at roughly half the source length, so size the chunk once up front.
+	size_t estimate = std::strlen(source) / 2 + 16;
+	chunk->data.reserve(estimate);
+	chunk->lines.reserve(estimate);
+	chunk->constantPool.reserve(estimate / 8 + 4);
+
 	parser.errorFound = false;
 	parser.panicMode = false;
 
@@ -22,6 +34,9 @@ bool yo::Compiler::compile(const char* source, Chunk* chunk)
 
 	finish();
 
+	localStack = LocalStack(arena);
+	arena.reset();
+
 	return !parser.errorFound;
 }
 
@@ -36,7 +51,7 @@ void yo::Compiler::advance()
 		if (parser.current.type != TokenType::T_ERROR)
 			break;
 
-		handleErrorAtCurrentToken(parser.current.data);
+		handleErrorAtCurrentToken(std::string(parser.current.data));
 	}
 }
 
@@ -52,6 +67,11 @@ void yo::Compiler::variableDeclaration()
 {
 	uint8_t globalVariable = parseVariable("Expected a variable name");
 
+	variableInitializer(globalVariable);
+}
+
+void yo::Compiler::variableInitializer(uint8_t globalVariable)
+{
 	if (matchToken(TokenType::T_EQUAL))
 		expression();
 	else
@@ -72,6 +92,10 @@ void yo::Compiler::statement()
 		statementWhile();
 	else if (matchToken(TokenType::T_FOR))
 		statementFor();
+	else if (matchToken(TokenType::T_DELETE))
+		statementDelete();
+	else if (matchToken(TokenType::T_YIELD))
+		statementYield();
 	else if (matchToken(TokenType::T_LEFT_BRACES))
 	{
 		startScope();
@@ -108,7 +132,7 @@ void yo::Compiler::finish()
 	#endif
 }
 
-void yo::Compiler::grouping()
+void yo::Compiler::grouping(bool canAssign)
 {
 	expression();
 	eat(TokenType::T_RIGHT_PARENTHESIS, "Expected ')' after expression");
@@ -213,7 +237,14 @@ void yo::Compiler::statementFor()
 	if (matchToken(TokenType::T_SEMICOLON))
 		{ }
 	else if (matchToken(TokenType::T_VAR))
-		variableDeclaration();
+	{
+		uint8_t variable = parseVariable("Expected a variable name");
+
+		if (matchToken(TokenType::T_IN))
+			return statementForIn();
+
+		variableInitializer(variable);
+	}
 	else
 		statementExpression();
 
@@ -259,6 +290,71 @@ void yo::Compiler::statementFor()
 	endScope();
 }
 
+void yo::Compiler::statementForIn()
+{
+	emitByte((uint8_t)OPCode::OP_NONE);
+	markInitialized();
+
+	int keySlot = localStack.locals.size() - 1;
+	if (keySlot + 2 > UINT8_MAX)
+		handleErrorAtCurrentToken("Too many local variables in this scope");
+
+	expression();
+	addLocal({ "@map", TokenType::T_IDENTIFIER, parser.previous.line });
+	markInitialized();
+
+	emitConstant({ (int64_t)0 });
+	addLocal({ "@cursor", TokenType::T_IDENTIFIER, parser.previous.line });
+	markInitialized();
+
+	eat(TokenType::T_RIGHT_PARENTHESIS, "Expected a ')'");
+
+	int loopStart = currentChunk->data.size();
+
+	emitByte((uint8_t)OPCode::OP_FOR_IN);
+	emitByte((uint8_t)keySlot);
+
+	int exitJump = emitJump((uint8_t)OPCode::OP_JUMP_IF_FALSE);
+	emitByte((uint8_t)OPCode::OP_POP_BACK);
+	statement();
+
+	emitLoop(loopStart);
+
+	patchJump(exitJump);
+	emitByte((uint8_t)OPCode::OP_POP_BACK);
+
+	endScope();
+}
+
+void yo::Compiler::statementDelete()
+{
+	pendingDelete = true;
+	parsePrecedence(Precedence::P_CALL);
+
+	if (pendingDelete)
+	{
+		pendingDelete = false;
+		handleErrorAtCurrentToken("Expected an index expression after 'delete'");
+	}
+
+	eat(TokenType::T_SEMICOLON, "Expected ';' after expression");
+}
+
+void yo::Compiler::statementYield()
+{
+	if (coroutineDepth == 0)
+		handleErrorToken(&parser.previous, "Can't yield outside of a coroutine");
+
+	if (checkToken(TokenType::T_SEMICOLON))
+		emitByte((uint8_t)OPCode::OP_NONE);
+	else
+		expression();
+
+	eat(TokenType::T_SEMICOLON, "Expected ';' after yield value");
+
+	emitByte((uint8_t)OPCode::OP_YIELD);
+}
+
 uint8_t yo::Compiler::parseVariable(const char* message)
 {
 	eat(TokenType::T_IDENTIFIER, message);
@@ -291,7 +387,7 @@ void yo::Compiler::declareVariable()
 		if (var.depth != -1 && var.depth < (int)localStack.scopeDepth)
 			break;
 
-		if (*name == var.name)
+		if (identifiersEqual(*name, var.name))
 			handleErrorAtCurrentToken("A variable assigned to this name already exists in this scope");
 	}
 
@@ -322,7 +418,10 @@ void yo::Compiler::synchronize()
 			case TokenType::T_WHILE:
 			case TokenType::T_PRINT:
 			case TokenType::T_RETURN:
+			case TokenType::T_YIELD:
 				return;
+			default:
+				break;
 		}
 
 		advance();
@@ -373,10 +472,24 @@ void yo::Compiler::patchJump(int offset)
 
 void yo::Compiler::numeric(bool canAssign)
 {
-	double value = std::strtod(parser.previous.data.c_str(), NULL);
+	std::string_view data = parser.previous.data;
+
+	double value = 0.0;
+	std::from_chars(data.data(), data.data() + data.size(), value);
 	emitConstant({ value });
 }
 
+void yo::Compiler::integer(bool canAssign)
+{
+	std::string_view data = parser.previous.data;
+
+	long long value = 0;
+	if (std::from_chars(data.data(), data.data() + data.size(), value).ec == std::errc::result_out_of_range)
+		return numeric(canAssign);
+
+	emitConstant({ (int64_t)value });
+}
+
 void yo::Compiler::unary(bool canAssign)
 {
 	TokenType type = parser.previous.type;
@@ -391,6 +504,8 @@ void yo::Compiler::unary(bool canAssign)
 	case TokenType::T_EXCLAMATION:
 		emitByte((uint8_t)OPCode::OP_NOT);
 		break;
+	default:
+		break;
 	}
 }
 
@@ -398,7 +513,7 @@ void yo::Compiler::binary(bool canAssign)
 {
 	TokenType type = parser.previous.type;
 
-	Rule* rule = getParserRule(type);
+	const Rule* rule = getParserRule(type);
 
 	parsePrecedence((Precedence)((int)rule->precedence + 1));
 
@@ -416,6 +531,15 @@ void yo::Compiler::binary(bool canAssign)
 	case TokenType::T_SLASH:
 		emitByte((uint8_t)OPCode::OP_DIV);
 		break;
+	case TokenType::T_PERCENT:
+		emitByte((uint8_t)OPCode::OP_MOD);
+		break;
+	case TokenType::T_AMPERSTAND:
+		emitByte((uint8_t)OPCode::OP_BIT_AND);
+		break;
+	case TokenType::T_PIPE:
+		emitByte((uint8_t)OPCode::OP_BIT_OR);
+		break;
 		
 	case TokenType::T_EQUAL_EQUAL:
 		emitByte((uint8_t)OPCode::OP_EQUAL);
@@ -438,6 +562,8 @@ void yo::Compiler::binary(bool canAssign)
 		emitByte((uint8_t)OPCode::OP_GREATER);
 		emitByte((uint8_t)OPCode::OP_NOT);
 		break;
+	default:
+		break;
 	}
 }
 
@@ -454,14 +580,16 @@ void yo::Compiler::literalType(bool canAssign)
 	case TokenType::T_FALSE:
 		emitByte((uint8_t)OPCode::OP_FALSE);
 		break;
+	default:
+		break;
 	}
 }
 
 void yo::Compiler::string(bool canAssign)
 {
-	std::string str = prepareStringObject();
+	std::string_view data = parser.previous.data;
 
-	emitConstant({ str });
+	emitConstant(Value::makeString(data.data(), data.size()));
 }
 
 void yo::Compiler::variable(bool canAssign)
@@ -469,6 +597,130 @@ void yo::Compiler::variable(bool canAssign)
 	namedVariable(parser.previous, canAssign);
 }
 
+void yo::Compiler::mapLiteral(bool canAssign)
+{
+	int entries = 0;
+
+	if (!checkToken(TokenType::T_RIGHT_BRACES))
+	{
+		do
+		{
+			expression();
+			eat(TokenType::T_COLON, "Expected ':' after map key");
+			expression();
+
+			if (++entries > UINT8_MAX)
+				handleErrorAtCurrentToken("Too many entries in a map literal");
+		} while (matchToken(TokenType::T_COMMA));
+	}
+
+	eat(TokenType::T_RIGHT_BRACES, "Expected '}' after map entries");
+
+	emitByte((uint8_t)OPCode::OP_BUILD_MAP);
+	emitByte((uint8_t)entries);
+}
+
+void yo::Compiler::arrayLiteral(bool canAssign)
+{
+	int elements = 0;
+
+	if (!checkToken(TokenType::T_RIGHT_BRACKETS))
+	{
+		do
+		{
+			expression();
+
+			if (++elements > UINT8_MAX)
+				handleErrorAtCurrentToken("Too many elements in an array literal");
+		} while (matchToken(TokenType::T_COMMA));
+	}
+
+	eat(TokenType::T_RIGHT_BRACKETS, "Expected ']' after array elements");
+
+	emitByte((uint8_t)OPCode::OP_BUILD_ARRAY);
+	emitByte((uint8_t)elements);
+}
+
+void yo::Compiler::call(bool canAssign)
+{
+	int arguments = 0;
+
+	if (!checkToken(TokenType::T_RIGHT_PARENTHESIS))
+	{
+		do
+		{
+			expression();
+
+			if (++arguments > UINT8_MAX)
+				handleErrorAtCurrentToken("Too many arguments in a call");
+		} while (matchToken(TokenType::T_COMMA));
+	}
+
+	eat(TokenType::T_RIGHT_PARENTHESIS, "Expected ')' after arguments");
+
+	emitByte((uint8_t)OPCode::OP_CALL);
+	emitByte((uint8_t)arguments);
+}
+
+void yo::Compiler::coroutine(bool canAssign)
+{
+	PrototypeObject* prototype = new PrototypeObject();
+
+	// The body gets its own chunk and stack, so it starts with no locals and cannot see the enclosing ones.
+	Chunk* enclosingChunk = currentChunk;
+	LocalStack enclosingLocals = std::move(localStack);
+
+	currentChunk = &prototype->chunk;
+	localStack = LocalStack(arena);
+	++coroutineDepth;
+
+	eat(TokenType::T_LEFT_BRACES, "Expected '{' before coroutine body");
+
+	startScope();
+	scopeBlock();
+	endScope();
+
+	emitByte((uint8_t)OPCode::OP_RETURN);
+
+	--coroutineDepth;
+	localStack = std::move(enclosingLocals);
+	currentChunk = enclosingChunk;
+
+	emitByte((uint8_t)OPCode::OP_COROUTINE);
+	currentChunk->push_constant({ (YoctaObject*)prototype }, parser.previous.line);
+}
+
+void yo::Compiler::resume(bool canAssign)
+{
+	eat(TokenType::T_LEFT_PARENTHESIS, "Expected '(' after 'resume'");
+	expression();
+	eat(TokenType::T_RIGHT_PARENTHESIS, "Expected ')' after coroutine");
+
+	emitByte((uint8_t)OPCode::OP_RESUME);
+}
+
+void yo::Compiler::index(bool canAssign)
+{
+	bool deleting = pendingDelete;
+	pendingDelete = false;
+
+	expression();
+	eat(TokenType::T_RIGHT_BRACKETS, "Expected ']' after index");
+
+	if (canAssign && matchToken(TokenType::T_EQUAL))
+	{
+		expression();
+		emitByte((uint8_t)OPCode::OP_SET_INDEX);
+	}
+	else if (deleting && checkToken(TokenType::T_SEMICOLON))
+		emitByte((uint8_t)OPCode::OP_DELETE_INDEX);
+	else
+	{
+		emitByte((uint8_t)OPCode::OP_GET_INDEX);
+		pendingDelete = deleting;
+	}
+}
+
 void yo::Compiler::namedVariable(Token name, bool canAssign)
 {
 	OPCode getOperation, setOperation;
@@ -503,7 +755,7 @@ void yo::Compiler::parsePrecedence(const Precedence& precendece)
 {
 	advance();
 	TokenType type = parser.previous.type;
-	std::function<void(bool)> prefix = getParserRule(type)->prefix;
+	Rule::ParseFunction prefix = getParserRule(type)->prefix;
 
 	if (!prefix)
 	{
@@ -512,14 +764,14 @@ void yo::Compiler::parsePrecedence(const Precedence& precendece)
 	}
 
 	bool canAssign = precendece <= Precedence::P_ASSIGNMENT;
-	prefix(canAssign);
+	(this->*prefix)(canAssign);
 
 	while (precendece <= getParserRule(parser.current.type)->precedence)
 	{
 		advance();
 
-		std::function<void(bool)> infix = getParserRule(parser.previous.type)->infix;
-		infix(canAssign);
+		Rule::ParseFunction infix = getParserRule(parser.previous.type)->infix;
+		(this->*infix)(canAssign);
 	}
 
 	if (canAssign && matchToken(TokenType::T_EQUAL))
@@ -528,7 +780,7 @@ void yo::Compiler::parsePrecedence(const Precedence& precendece)
 
 uint8_t yo::Compiler::identifierConstant(Token* name)
 {
-	currentChunk->push_constant_only({ name->data });
+	currentChunk->push_constant_only(Value::makeString(name->data.data(), name->data.size()));
 	return (uint8_t)currentChunk->constantPool.size() - 1;
 }
 
@@ -537,7 +789,7 @@ int yo::Compiler::resolveLocal(Token name)
 	for (int i = localStack.locals.size() - 1; i >= 0; i--)
 	{
 		LocalVar local = localStack.locals[i];
-		if (name == local.name)
+		if (identifiersEqual(name, local.name))
 		{
 			if(local.depth == -1)
 				handleErrorAtCurrentToken("Unable to read local variable in its own initializer.");
@@ -553,225 +805,52 @@ void yo::Compiler::addLocal(Token name)
 	localStack.locals.push_back({name, -1});
 }
 
-std::string yo::Compiler::prepareStringObject() const
-{
-	std::string str = parser.previous.data;
-	std::string a = parser.current.data;
-
-	return str;
-}
-
 //yo::StringObject* yo::Compiler::allocateStringObject(const std::string& str)
 //{
 //	return new StringObject(str);
 //}
 
-void yo::Compiler::intializeParserRules()
-{
-	parseRules.insert({
-		TokenType::T_LEFT_PARENTHESIS,
-		Rule(std::bind(&Compiler::grouping, this), nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_RIGHT_PARENTHESIS,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-		});
-
-	parseRules.insert({
-		TokenType::T_LEFT_BRACES,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-		});
-
-	parseRules.insert({
-		TokenType::T_RIGHT_BRACES,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-		});
-
-	parseRules.insert({
-		TokenType::T_COMMA,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-		});
-
-	parseRules.insert({
-		TokenType::T_DOT,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-		});
-
-	parseRules.insert({
-		TokenType::T_MINUS,
-		Rule(std::bind(&Compiler::unary, this, false), std::bind(&Compiler::binary, this, false), Precedence::P_TERM)
-	});
-
-	parseRules.insert({
-		TokenType::T_PLUS,
-		Rule(nullptr, std::bind(&Compiler::binary, this, false), Precedence::P_TERM)
-	});
-
-	parseRules.insert({
-		TokenType::T_SLASH,
-		Rule(nullptr, std::bind(&Compiler::binary, this, false), Precedence::P_FACTOR)
-	});
-
-	parseRules.insert({
-		TokenType::T_ASTERISTIC,
-		Rule(nullptr, std::bind(&Compiler::binary, this, false), Precedence::P_FACTOR)
-	});
-
-	parseRules.insert({
-		TokenType::T_SEMICOLON,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_EXCLAMATION,
-		Rule(std::bind(&Compiler::unary, this, false), nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_EXCLAMATION_EQUAL,
-		Rule(nullptr, std::bind(&Compiler::binary, this, false), Precedence::P_EQUAL)
-	});
-
-	parseRules.insert({
-		TokenType::T_EQUAL,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_EQUAL_EQUAL,
-		Rule(nullptr, std::bind(&Compiler::binary, this, false), Precedence::P_COMPARE)
-	});
-
-	parseRules.insert({
-		TokenType::T_GREATER,
-		Rule(nullptr, std::bind(&Compiler::binary, this, false), Precedence::P_COMPARE)
-	});
-
-	parseRules.insert({
-		TokenType::T_GREATER_EQUAL,
-		Rule(nullptr, std::bind(&Compiler::binary, this, false), Precedence::P_COMPARE)
-	});
-
-	parseRules.insert({
-		TokenType::T_LESS,
-		Rule(nullptr, std::bind(&Compiler::binary, this, false), Precedence::P_COMPARE)
-	});
-
-	parseRules.insert({
-		TokenType::T_LESS_EQUAL,
-		Rule(nullptr, std::bind(&Compiler::binary, this, false), Precedence::P_COMPARE)
-	});
-
-	parseRules.insert({
-		TokenType::T_IDENTIFIER,
-		Rule(std::bind(&Compiler::variable, this, true), nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_STRING,
-		Rule(std::bind(&Compiler::string, this, true), nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_NUMERIC,
-		Rule(std::bind(&Compiler::numeric, this, true), nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_AND,
-		Rule(nullptr, std::bind(&Compiler::andRule, this, false), Precedence::P_AND)
-	});
-
-	parseRules.insert({
-		TokenType::T_OR,
-		Rule(nullptr, std::bind(&Compiler::orRule, this, false), Precedence::P_OR)
-	});
-
-	parseRules.insert({
-		TokenType::T_IF,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-		});
-
-	parseRules.insert({
-		TokenType::T_ELSE,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-		});
-
-	parseRules.insert({
-		TokenType::T_FALSE,
-		Rule(std::bind(&Compiler::literalType, this, true), nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_TRUE,
-		Rule(std::bind(&Compiler::literalType, this, true), nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_FOR,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-		});
-
-	parseRules.insert({
-		TokenType::T_WHILE,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-		});
-
-	parseRules.insert({
-		TokenType::T_NONE,
-		Rule(std::bind(&Compiler::literalType, this, true), nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_PRINT,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_VAR,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_FUNC,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_RETURN,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_CLASS,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_SUPER,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_THIS,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_ERROR,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-	});
-
-	parseRules.insert({
-		TokenType::T_EOF,
-		Rule(nullptr, nullptr, Precedence::P_NONE)
-	});
-}
-
-yo::Rule* yo::Compiler::getParserRule(TokenType type)
-{
-	return &parseRules[type];
+std::array<yo::Rule, yo::TOKEN_TYPE_COUNT> yo::Compiler::createParserRules()
+{
+	// Tokens without an entry keep the empty rule: no prefix, no infix and no precedence.
+	std::array<Rule, TOKEN_TYPE_COUNT> rules;
+
+	rules[(size_t)TokenType::T_LEFT_PARENTHESIS] = Rule(&Compiler::grouping, &Compiler::call, Precedence::P_CALL);
+	rules[(size_t)TokenType::T_LEFT_BRACES] = Rule(&Compiler::mapLiteral, nullptr, Precedence::P_NONE);
+	rules[(size_t)TokenType::T_LEFT_BRACKETS] = Rule(&Compiler::arrayLiteral, &Compiler::index, Precedence::P_CALL);
+	rules[(size_t)TokenType::T_MINUS] = Rule(&Compiler::unary, &Compiler::binary, Precedence::P_TERM);
+	rules[(size_t)TokenType::T_PLUS] = Rule(nullptr, &Compiler::binary, Precedence::P_TERM);
+	rules[(size_t)TokenType::T_SLASH] = Rule(nullptr, &Compiler::binary, Precedence::P_FACTOR);
+	rules[(size_t)TokenType::T_ASTERISTIC] = Rule(nullptr, &Compiler::binary, Precedence::P_FACTOR);
+	rules[(size_t)TokenType::T_PERCENT] = Rule(nullptr, &Compiler::binary, Precedence::P_FACTOR);
+	rules[(size_t)TokenType::T_AMPERSTAND] = Rule(nullptr, &Compiler::binary, Precedence::P_BIT_AND);
+	rules[(size_t)TokenType::T_PIPE] = Rule(nullptr, &Compiler::binary, Precedence::P_BIT_OR);
+	rules[(size_t)TokenType::T_EXCLAMATION] = Rule(&Compiler::unary, nullptr, Precedence::P_NONE);
+	rules[(size_t)TokenType::T_EXCLAMATION_EQUAL] = Rule(nullptr, &Compiler::binary, Precedence::P_EQUAL);
+	rules[(size_t)TokenType::T_EQUAL_EQUAL] = Rule(nullptr, &Compiler::binary, Precedence::P_COMPARE);
+	rules[(size_t)TokenType::T_GREATER] = Rule(nullptr, &Compiler::binary, Precedence::P_COMPARE);
+	rules[(size_t)TokenType::T_GREATER_EQUAL] = Rule(nullptr, &Compiler::binary, Precedence::P_COMPARE);
+	rules[(size_t)TokenType::T_LESS] = Rule(nullptr, &Compiler::binary, Precedence::P_COMPARE);
+	rules[(size_t)TokenType::T_LESS_EQUAL] = Rule(nullptr, &Compiler::binary, Precedence::P_COMPARE);
+	rules[(size_t)TokenType::T_IDENTIFIER] = Rule(&Compiler::variable, nullptr, Precedence::P_NONE);
+	rules[(size_t)TokenType::T_STRING] = Rule(&Compiler::string, nullptr, Precedence::P_NONE);
+	rules[(size_t)TokenType::T_NUMERIC] = Rule(&Compiler::numeric, nullptr, Precedence::P_NONE);
+	rules[(size_t)TokenType::T_INTEGER] = Rule(&Compiler::integer, nullptr, Precedence::P_NONE);
+	rules[(size_t)TokenType::T_AND] = Rule(nullptr, &Compiler::andRule, Precedence::P_AND);
+	rules[(size_t)TokenType::T_OR] = Rule(nullptr, &Compiler::orRule, Precedence::P_OR);
+	rules[(size_t)TokenType::T_FALSE] = Rule(&Compiler::literalType, nullptr, Precedence::P_NONE);
+	rules[(size_t)TokenType::T_TRUE] = Rule(&Compiler::literalType, nullptr, Precedence::P_NONE);
+	rules[(size_t)TokenType::T_NONE] = Rule(&Compiler::literalType, nullptr, Precedence::P_NONE);
+	rules[(size_t)TokenType::T_COROUTINE] = Rule(&Compiler::coroutine, nullptr, Precedence::P_NONE);
+	rules[(size_t)TokenType::T_RESUME] = Rule(&Compiler::resume, nullptr, Precedence::P_NONE);
+
+	return rules;
+}
+
+const yo::Rule* yo::Compiler::getParserRule(TokenType type)
+{
+	static const std::array<Rule, TOKEN_TYPE_COUNT> rules = createParserRules();
+	return &rules[(size_t)type];
 }
 
 void yo::Compiler::handleErrorAtCurrentToken(const std::string& message)
@@ -794,7 +873,7 @@ void yo::Compiler::handleErrorToken(Token* token, const std::string& message)
 	else if (token->type == TokenType::T_ERROR) {}
 
 	else
-		fprintf(stderr, "at '%.*s'", token->data.length(), token->data.c_str());
+		fprintf(stderr, "at '%.*s'", (int)token->data.length(), token->data.data());
 
 	fprintf(stderr, ": %s\n", message.c_str());
 	parser.errorFound = true;
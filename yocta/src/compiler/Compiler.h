@@ -1,14 +1,15 @@
 #pragma once
-#include <unordered_map>
-#include <functional>
+#include <array>
 
 #include "YoctaObject.h"
+#include "Coroutine.h"
 #include "Precedence.h"
 #include "LocalVar.h"
 #include "Parser.h"
 #include "Lexer.h"
 #include "Chunk.h"
 #include "Rule.h"
+#include "Arena.h"
 
 namespace yo
 {
@@ -27,6 +28,8 @@ namespace yo
 
 		void variableDeclaration();
 
+		void variableInitializer(uint8_t globalVariable);
+
 		void statement();
 
 		void expression();
@@ -35,7 +38,7 @@ namespace yo
 
 		void finish();
 
-		void grouping();
+		void grouping(bool canAssign);
 
 	private:
 		void startScope();
@@ -55,6 +58,12 @@ namespace yo
 
 		void statementFor();
 
+		void statementForIn();
+
+		void statementDelete();
+
+		void statementYield();
+
 	private:
 		uint8_t parseVariable(const char* message);
 
@@ -81,6 +90,8 @@ namespace yo
 
 	private:
 		void numeric(bool canAssign);
+
+		void integer(bool canAssign);
 		
 		void unary(bool canAssign);
 
@@ -92,6 +103,18 @@ namespace yo
 
 		void variable(bool canAssign);
 
+		void mapLiteral(bool canAssign);
+
+		void arrayLiteral(bool canAssign);
+
+		void call(bool canAssign);
+
+		void index(bool canAssign);
+
+		void coroutine(bool canAssign);
+
+		void resume(bool canAssign);
+
 		void andRule(bool canAssign)
 		{
 			int endJump = emitJump((uint8_t)OPCode::OP_JUMP_IF_FALSE);
@@ -125,13 +148,12 @@ namespace yo
 
 		void addLocal(Token name);
 
-	private:
-		std::string prepareStringObject() const;
+		static bool identifiersEqual(const Token& lhs, const Token& rhs) { return lhs.data == rhs.data; }
 
 	private:
-		void intializeParserRules();
+		static std::array<Rule, TOKEN_TYPE_COUNT> createParserRules();
 
-		Rule* getParserRule(TokenType type);
+		static const Rule* getParserRule(TokenType type);
 
 	private:
 		void handleErrorAtCurrentToken(const std::string& message);
@@ -143,6 +165,9 @@ namespace yo
 
 		bool checkToken(TokenType type);
 
+	private:
+		Arena arena;
+
 	public:
 		Lexer lexer;
 		Parser parser;
@@ -151,6 +176,7 @@ namespace yo
 		YoctaObject* objects = nullptr;
 
 	private:
-		std::unordered_map<TokenType, Rule> parseRules;
+		bool pendingDelete = false;
+		unsigned int coroutineDepth = 0;
 	};
 }
\ No newline at end of file
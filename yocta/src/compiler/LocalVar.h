@@ -1,5 +1,8 @@
 #pragma once
+#include <vector>
+
 #include "Token.h"
+#include "Arena.h"
 
 namespace yo
 {
@@ -24,7 +27,11 @@ namespace yo
 	struct LocalStack
 	{
 	public:
-		std::vector<LocalVar> locals;
+		explicit LocalStack(Arena& arena)
+			: locals(ArenaAllocator<LocalVar>(arena)) { }
+
+	public:
+		std::vector<LocalVar, ArenaAllocator<LocalVar>> locals;
 		unsigned int scopeDepth = 0;
 	};
 }
\ No newline at end of file
@@ -10,6 +10,8 @@ namespace yo
 		P_AND,
 		P_EQUAL,
 		P_COMPARE,
+		P_BIT_OR,
+		P_BIT_AND,
 		P_TERM,
 		P_FACTOR,
 		P_UNARY,
@@ -1,20 +1,24 @@
 #pragma once
-#include <functional>
 #include "Precedence.h"
 
 namespace yo
 {
+	class Compiler;
+
 	struct Rule
 	{
 	public:
-		Rule(std::function<void(bool)> prefix, std::function<void(bool)> infix, Precedence precedence)
+		using ParseFunction = void (Compiler::*)(bool canAssign);
+
+	public:
+		constexpr Rule(ParseFunction prefix, ParseFunction infix, Precedence precedence)
 			: prefix(prefix), infix(infix), precedence(precedence) { }
 
-		Rule() = default;
+		constexpr Rule() = default;
 
 	public:
-		std::function<void(bool)> prefix;
-		std::function<void(bool)> infix;
+		ParseFunction prefix = nullptr;
+		ParseFunction infix = nullptr;
 		Precedence precedence = Precedence::P_NONE;
 	};
 }
\ No newline at end of file
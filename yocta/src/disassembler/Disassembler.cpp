@@ -94,6 +94,90 @@ unsigned int yo::Disassembler::disassembleInstruction(const Chunk& chunk, int of
 	case (uint8_t)OPCode::OP_LOOP:
 		return jumpInstruction(instruction, -1, chunk, offset);
 
+	case (uint8_t)OPCode::OP_BUILD_MAP:
+		return byteInstruction(instruction, chunk, offset);
+
+	case (uint8_t)OPCode::OP_GET_INDEX:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_SET_INDEX:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_DELETE_INDEX:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_FOR_IN:
+		return byteInstruction(instruction, chunk, offset);
+
+	case (uint8_t)OPCode::OP_MOD:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_BIT_AND:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_BIT_OR:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_BUILD_ARRAY:
+		return byteInstruction(instruction, chunk, offset);
+
+	case (uint8_t)OPCode::OP_CALL:
+		return byteInstruction(instruction, chunk, offset);
+
+	case (uint8_t)OPCode::OP_ADD_INT:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_SUB_INT:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_MULT_INT:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_LESS_INT:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_GREATER_INT:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_INCREMENT_LOCAL:
+		return localConstantInstruction(instruction, chunk, offset);
+
+	case (uint8_t)OPCode::OP_ADD_NUM_NUM:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_SUB_NUM_NUM:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_MULT_NUM_NUM:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_DIV_NUM_NUM:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_LESS_NUM_NUM:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_GREATER_NUM_NUM:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_ADD_STR_STR:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_GET_GLOBAL_CACHED:
+		return constantInstruction(instruction, chunk, offset);
+
+	case (uint8_t)OPCode::OP_SET_GLOBAL_CACHED:
+		return constantInstruction(instruction, chunk, offset);
+
+	case (uint8_t)OPCode::OP_COROUTINE:
+		return constantInstruction(instruction, chunk, offset);
+
+	case (uint8_t)OPCode::OP_YIELD:
+		return simpleInstruction(instruction, offset);
+
+	case (uint8_t)OPCode::OP_RESUME:
+		return simpleInstruction(instruction, offset);
+
 	default:
 		printf("Unknown opcode [%s]\n", translateCode((OPCode)instruction));
 		return offset + 1;
@@ -111,16 +195,21 @@ unsigned int yo::Disassembler::constantInstruction(uint8_t code, const Chunk& ch
 	uint8_t constant = chunk.data[++offset];
 
 	Value value = chunk.constantPool[constant];
-	if (value.variantValue.index() == 2)
+	if (isString(value))
 	{
-		StringObject* object = getStringObject(value);
-		printf("%s\t[Index]: %d | [Value]: %s\n", translateCode((OPCode)code), constant, object->data.c_str());
+		std::string_view str = stringView(value);
+		printf("%s\t[Index]: %d | [Value]: %.*s\n", translateCode((OPCode)code), constant, (int)str.size(), str.data());
 	}
 	else if (value.variantValue.index() == 1)
 	{
 		double v = std::get<double>(value.variantValue);
 		printf("%s\t[Index]: %d | [Value]: %f\n", translateCode((OPCode)code), constant, v);
 	}
+	else if (value.variantValue.index() == 4)
+	{
+		long long v = (long long)std::get<int64_t>(value.variantValue);
+		printf("%s\t[Index]: %d | [Value]: %lld\n", translateCode((OPCode)code), constant, v);
+	}
 	else if (value.variantValue.index() == 0)
 	{
 		bool v = std::get<bool>(value.variantValue);
@@ -144,3 +233,15 @@ unsigned int yo::Disassembler::jumpInstruction(uint8_t code, int sign, const Chu
 	printf("%-16s %4d -> %d\n", translateCode(OPCode(code)), offset, offset + 3 + sign * jump);
 	return offset + 3;
 }
+
+unsigned int yo::Disassembler::localConstantInstruction(uint8_t code, const Chunk& chunk, int offset)
+{
+	uint8_t slot = chunk.data[offset + 1];
+	uint8_t constant = chunk.data[offset + 2];
+
+	printf("%-16s %4d += ", translateCode((OPCode)code), slot);
+	displayValue(chunk.constantPool[constant]);
+	printf("\n");
+
+	return offset + 3;
+}
\ No newline at end of file
@@ -18,6 +18,8 @@ namespace yo
 		static unsigned int byteInstruction(uint8_t code, const Chunk& chunk, int offset);
 
 		static unsigned int jumpInstruction(uint8_t code, int sign, const Chunk& chunk, int offset);
+
+		static unsigned int localConstantInstruction(uint8_t code, const Chunk& chunk, int offset);
 	};
 }
 
@@ -0,0 +1,159 @@
+#include "AsyncIo.h"
+#include "EventLoopSupport.h"
+#include "NativeHost.h"
+
+#include <cerrno>
+
+#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+#include <unistd.h>
+#endif
+
+namespace
+{
+	using namespace yo;
+
+	bool descriptorArgument(NativeHost& host, const Value& value, const char* name, int& fd)
+	{
+		if (value.type != ValueType::VT_INTEGER || std::get<int64_t>(value.variantValue) < 0)
+			return host.nativeError("%s() expects a file descriptor.\n", name);
+
+		fd = (int)std::get<int64_t>(value.variantValue);
+		return true;
+	}
+
+	// Descriptors handed to scripts must be non-blocking; the call only parks when it would block.
+	bool submit(NativeHost& host, AsyncRequest& request, Value& result)
+	{
+		if (request.operation != AsyncOperation::SLEEP && attemptRequest(request, result) == AsyncStatus::DONE)
+			return true;
+
+		return host.await(request);
+	}
+
+	bool readNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		AsyncRequest request;
+		request.operation = AsyncOperation::READ;
+
+		if (argCount != 1)
+			return host.nativeError("read() expects a file descriptor.\n");
+
+		if (!descriptorArgument(host, args[0], "read", request.fd))
+			return false;
+
+		return submit(host, request, result);
+	}
+
+	bool writeNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		AsyncRequest request;
+		request.operation = AsyncOperation::WRITE;
+
+		if (argCount != 2 || !isString(args[1]))
+			return host.nativeError("write() expects a file descriptor and a string.\n");
+
+		if (!descriptorArgument(host, args[0], "write", request.fd))
+			return false;
+
+		request.data = std::string(stringView(args[1]));
+		return submit(host, request, result);
+	}
+
+	bool sleepNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		if (argCount != 1 || args[0].type != ValueType::VT_INTEGER || std::get<int64_t>(args[0].variantValue) < 0)
+			return host.nativeError("sleep() expects a non-negative number of milliseconds.\n");
+
+		AsyncRequest request;
+		request.operation = AsyncOperation::SLEEP;
+		request.milliseconds = std::get<int64_t>(args[0].variantValue);
+
+		return submit(host, request, result);
+	}
+
+	bool closeNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		int fd = -1;
+
+		if (argCount != 1)
+			return host.nativeError("close() expects a file descriptor.\n");
+
+		if (!descriptorArgument(host, args[0], "close", fd))
+			return false;
+
+		#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+		result = { ::close(fd) == 0 };
+		#else
+		result = { false };
+		#endif
+
+		return true;
+	}
+}
+
+yo::AsyncStatus yo::attemptRequest(AsyncRequest& request, Value& result)
+{
+	#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+	if (request.operation == AsyncOperation::READ)
+	{
+		char buffer[ASYNC_READ_SIZE];
+		ssize_t count = ::read(request.fd, buffer, sizeof(buffer));
+
+		if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return AsyncStatus::WOULD_BLOCK;
+
+		// An empty string marks the end of the stream and none marks an error.
+		result = count >= 0 ? Value::makeString(buffer, (size_t)count) : Value();
+		return AsyncStatus::DONE;
+	}
+
+	if (request.operation == AsyncOperation::WRITE)
+	{
+		while (request.written < request.data.size())
+		{
+			ssize_t count = ::write(request.fd, request.data.data() + request.written, request.data.size() - request.written);
+
+			if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+				return AsyncStatus::WOULD_BLOCK;
+
+			if (count < 0)
+			{
+				result = {};
+				return AsyncStatus::DONE;
+			}
+
+			request.written += (size_t)count;
+		}
+
+		result = { (int64_t)request.written };
+		return AsyncStatus::DONE;
+	}
+	#endif
+
+	result = {};
+	return AsyncStatus::DONE;
+}
+
+const char* yo::translateAsyncOperation(AsyncOperation operation)
+{
+	switch (operation)
+	{
+		case AsyncOperation::READ: return "read";
+		case AsyncOperation::WRITE: return "write";
+		case AsyncOperation::SLEEP: return "sleep";
+		default: return "none";
+	}
+}
+
+void yo::registerAsyncNatives(NativeHost& host)
+{
+	host.defineNative("read", readNative);
+	host.defineNative("write", writeNative);
+	host.defineNative("sleep", sleepNative);
+	host.defineNative("close", closeNative);
+}
+
+bool yo::NativeHost::await(const AsyncRequest& request)
+{
+	return nativeError("%s() can only be called by a task on an event loop.\n", translateAsyncOperation(request.operation));
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "Value.h"
+
+namespace yo
+{
+	class NativeHost;
+
+	enum class AsyncOperation
+	{
+		NONE = 0,
+		READ,
+		WRITE,
+		SLEEP
+	};
+
+	struct AsyncRequest
+	{
+	public:
+		AsyncOperation operation = AsyncOperation::NONE;
+		int fd = -1;
+
+	public:
+		std::string data;
+		size_t written = 0;
+
+	public:
+		int64_t milliseconds = 0;
+	};
+
+	enum class AsyncStatus
+	{
+		DONE = 0,
+		WOULD_BLOCK
+	};
+
+	constexpr size_t ASYNC_READ_SIZE = 4096;
+
+	// Makes as much progress on a read or write as the descriptor allows without blocking.
+	AsyncStatus attemptRequest(AsyncRequest& request, Value& result);
+
+	const char* translateAsyncOperation(AsyncOperation operation);
+
+	void registerAsyncNatives(NativeHost& host);
+}
\ No newline at end of file
@@ -0,0 +1,320 @@
+#include "EventLoop.h"
+#include "EventLoopSupport.h"
+
+#include <cerrno>
+#include <cstdio>
+
+#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// Descriptors are registered with their own number as the epoll token, so the timer needs one no descriptor can have.
+	constexpr uint64_t TIMER_TOKEN = UINT64_MAX;
+
+	int64_t monotonicNanoseconds()
+	{
+		#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+
+		return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+		#else
+		return 0;
+		#endif
+	}
+}
+
+yo::EventLoop::EventLoop(uint64_t timeSlice)
+	: timeSlice(timeSlice)
+{
+	#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+	epollFd = epoll_create1(EPOLL_CLOEXEC);
+	timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+	if (epollFd == -1 || timerFd == -1)
+		return;
+
+	epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.u64 = TIMER_TOKEN;
+
+	epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+	#endif
+}
+
+yo::EventLoop::~EventLoop()
+{
+	#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+	if (timerFd != -1)
+		close(timerFd);
+
+	if (epollFd != -1)
+		close(epollFd);
+	#endif
+}
+
+bool yo::EventLoop::supported()
+{
+	#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+	return true;
+	#else
+	return false;
+	#endif
+}
+
+bool yo::EventLoop::openSocketPair(int fds[2])
+{
+	#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+	return socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) == 0;
+	#else
+	return false;
+	#endif
+}
+
+bool yo::EventLoop::openPipe(int fds[2])
+{
+	#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+	return pipe2(fds, O_NONBLOCK | O_CLOEXEC) == 0;
+	#else
+	return false;
+	#endif
+}
+
+size_t yo::EventLoop::spawn(VirtualMachine& vm, const std::shared_ptr<const Program>& program, const std::vector<Binding>& bindings)
+{
+	vm.setBudget(timeSlice);
+	vm.enableAsync(true);
+
+	tasks.push_back({ &vm, program, bindings, InterpretResult::YIELDED, false, {}, {}, false });
+	ready.push_back(tasks.size() - 1);
+
+	return tasks.size() - 1;
+}
+
+bool yo::EventLoop::run()
+{
+	#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+	if (epollFd == -1 || timerFd == -1)
+		return false;
+
+	epoll_event events[MAX_EVENTS];
+
+	while (!ready.empty() || waiting > 0)
+	{
+		// Only the tasks that were ready on entry run, so a busy task cannot starve the descriptors.
+		for (size_t count = ready.size(); count > 0; --count)
+		{
+			size_t task = ready.front();
+			ready.pop_front();
+
+			step(task);
+		}
+
+		if (waiting == 0)
+			continue;
+
+		int count = epoll_wait(epollFd, events, MAX_EVENTS, ready.empty() ? -1 : 0);
+
+		if (count < 0 && errno != EINTR)
+			return false;
+
+		for (int i = 0; i < count; ++i)
+		{
+			if (events[i].data.u64 == TIMER_TOKEN)
+				expireTimers();
+			else
+				dispatch((int)events[i].data.u64, events[i].events);
+		}
+	}
+
+	return true;
+	#else
+	fprintf(stderr, "The event loop is not supported on this platform.\n");
+	return false;
+	#endif
+}
+
+void yo::EventLoop::step(size_t index)
+{
+	Task& task = tasks[index];
+	InterpretResult result;
+
+	if (!task.started)
+	{
+		task.started = true;
+		result = task.vm->execute(task.program, task.bindings);
+	}
+	else if (task.replied)
+	{
+		task.replied = false;
+		result = task.vm->complete(task.reply);
+	}
+	else
+		result = task.vm->resume();
+
+	if (result == InterpretResult::YIELDED)
+		ready.push_back(index);
+
+	else if (result == InterpretResult::WAITING)
+		task.result = park(index) ? result : InterpretResult::RUNTIME_ERROR;
+
+	else
+		task.result = result;
+}
+
+bool yo::EventLoop::park(size_t index)
+{
+	Task& task = tasks[index];
+	task.request = task.vm->pendingRequest();
+
+	if (task.request.operation == AsyncOperation::SLEEP)
+	{
+		int64_t deadline = monotonicNanoseconds() + task.request.milliseconds * 1000000;
+		bool earliest = timers.empty() || deadline < timers.top().deadline;
+
+		timers.push({ deadline, index });
+
+		if (earliest)
+			armTimer();
+	}
+	else
+	{
+		int fd = task.request.fd;
+		bool writing = task.request.operation == AsyncOperation::WRITE;
+
+		auto [found, added] = watches.try_emplace(fd);
+		size_t& slot = writing ? found->second.writer : found->second.reader;
+
+		if (slot != NO_TASK)
+		{
+			fprintf(stderr, "Task %zu: descriptor %d already has a waiting %s.\n", index, fd, writing ? "writer" : "reader");
+			return false;
+		}
+
+		slot = index;
+
+		if (!updateWatch(fd, added))
+		{
+			fprintf(stderr, "Task %zu: descriptor %d cannot be watched.\n", index, fd);
+			slot = NO_TASK;
+			updateWatch(fd, added);
+			return false;
+		}
+	}
+
+	++waiting;
+	++parkCount;
+	return true;
+}
+
+void yo::EventLoop::wake(size_t index, const Value& reply)
+{
+	Task& task = tasks[index];
+
+	task.reply = reply;
+	task.replied = true;
+
+	--waiting;
+	++wakeupCount;
+	ready.push_back(index);
+}
+
+bool yo::EventLoop::updateWatch(int fd, bool added)
+{
+	#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+	auto found = watches.find(fd);
+	const Watch& watch = found->second;
+
+	epoll_event event = {};
+	event.events = (watch.reader != NO_TASK ? (uint32_t)(EPOLLIN | EPOLLRDHUP) : 0u) | (watch.writer != NO_TASK ? (uint32_t)EPOLLOUT : 0u);
+	event.data.u64 = (uint64_t)fd;
+
+	if (event.events == 0)
+	{
+		watches.erase(found);
+		return added || epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr) == 0;
+	}
+
+	return epoll_ctl(epollFd, added ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event) == 0;
+	#else
+	return false;
+	#endif
+}
+
+void yo::EventLoop::dispatch(int fd, uint32_t events)
+{
+	#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+	auto found = watches.find(fd);
+	if (found == watches.end())
+		return;
+
+	Watch& watch = found->second;
+	Value reply;
+
+	// Readiness is only a hint: the operation is retried and the task stays parked if it would still block.
+	if (watch.reader != NO_TASK && (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+	{
+		// The data read becomes a string in the reader's heap; it stays unreachable by the collector
+		// only until complete() puts it on the stack, and that VM cannot collect before then.
+		Heap::Scope scope(&tasks[watch.reader].vm->heap());
+
+		if (attemptRequest(tasks[watch.reader].request, reply) == AsyncStatus::DONE)
+		{
+			wake(watch.reader, reply);
+			watch.reader = NO_TASK;
+		}
+	}
+
+	if (watch.writer != NO_TASK && (events & (EPOLLOUT | EPOLLHUP | EPOLLERR)))
+	{
+		if (attemptRequest(tasks[watch.writer].request, reply) == AsyncStatus::DONE)
+		{
+			wake(watch.writer, reply);
+			watch.writer = NO_TASK;
+		}
+	}
+
+	updateWatch(fd, false);
+	#endif
+}
+
+void yo::EventLoop::expireTimers()
+{
+	#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+	uint64_t expirations;
+	if (read(timerFd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+		return;
+
+	int64_t now = monotonicNanoseconds();
+
+	while (!timers.empty() && timers.top().deadline <= now)
+	{
+		wake(timers.top().task, {});
+		timers.pop();
+	}
+
+	armTimer();
+	#endif
+}
+
+void yo::EventLoop::armTimer()
+{
+	#ifdef YOCTA_EVENT_LOOP_SUPPORTED
+	itimerspec deadline = {};
+
+	if (!timers.empty())
+	{
+		deadline.it_value.tv_sec = timers.top().deadline / 1000000000;
+		deadline.it_value.tv_nsec = timers.top().deadline % 1000000000;
+	}
+
+	timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &deadline, nullptr);
+	#endif
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include "VirtualMachine.h"
+
+namespace yo
+{
+	// Drives many script tasks on one thread: a task that calls read(), write() or sleep() on
+	// a descriptor that is not ready parks until epoll or the timerfd reports it can continue.
+	class EventLoop
+	{
+	public:
+		using InterpretResult = VirtualMachine::InterpretResult;
+
+		static constexpr size_t NO_TASK = SIZE_MAX;
+		static constexpr int MAX_EVENTS = 256;
+
+	public:
+		explicit EventLoop(uint64_t timeSlice = 0);
+
+		~EventLoop();
+
+		EventLoop(const EventLoop&) = delete;
+		EventLoop& operator=(const EventLoop&) = delete;
+
+	public:
+		static bool supported();
+
+		static bool openSocketPair(int fds[2]);
+
+		static bool openPipe(int fds[2]);
+
+	public:
+		size_t spawn(VirtualMachine& vm, const std::shared_ptr<const Program>& program, const std::vector<Binding>& bindings = {});
+
+		bool run();
+
+	public:
+		InterpretResult result(size_t task) const { return tasks[task].result; }
+
+		size_t parks() const { return parkCount; }
+
+		size_t wakeups() const { return wakeupCount; }
+
+	private:
+		struct Task
+		{
+		public:
+			VirtualMachine* vm;
+			std::shared_ptr<const Program> program;
+			std::vector<Binding> bindings;
+
+		public:
+			InterpretResult result = InterpretResult::YIELDED;
+			bool started = false;
+
+		public:
+			AsyncRequest request;
+			Value reply;
+			bool replied = false;
+		};
+
+		struct Watch
+		{
+		public:
+			size_t reader = NO_TASK;
+			size_t writer = NO_TASK;
+		};
+
+		struct Timer
+		{
+		public:
+			int64_t deadline;
+			size_t task;
+
+		public:
+			bool operator>(const Timer& other) const { return deadline > other.deadline; }
+		};
+
+	private:
+		void step(size_t task);
+
+		bool park(size_t task);
+
+		void wake(size_t task, const Value& reply);
+
+	private:
+		bool updateWatch(int fd, bool added);
+
+		void dispatch(int fd, uint32_t events);
+
+		void expireTimers();
+
+		void armTimer();
+
+	private:
+		uint64_t timeSlice;
+		int epollFd = -1;
+		int timerFd = -1;
+
+	private:
+		std::vector<Task> tasks;
+		std::deque<size_t> ready;
+		std::unordered_map<int, Watch> watches;
+		std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+
+	private:
+		size_t waiting = 0;
+		size_t parkCount = 0;
+		size_t wakeupCount = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+#pragma once
+
+#if defined(__linux__)
+#define YOCTA_EVENT_LOOP_SUPPORTED
+#endif
\ No newline at end of file
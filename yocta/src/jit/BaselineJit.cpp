@@ -0,0 +1,777 @@
+#include "BaselineJit.h"
+#include "X64Assembler.h"
+#include "VirtualMachine.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+namespace
+{
+	// Native code reads a value's bool, double or integer in place. The variant keeps all three at the start of one
+	// union, at an offset the language leaves open, so it is measured; -1 when the layout is not the expected one.
+	int32_t payloadOffset()
+	{
+		yo::Value probe;
+		const char* base = (const char*)&probe;
+
+		probe = { (int64_t)0 };
+		const char* integer = (const char*)&std::get<int64_t>(probe.variantValue);
+
+		probe = { 0.0 };
+		const char* number = (const char*)&std::get<double>(probe.variantValue);
+
+		probe = { false };
+		const char* boolean = (const char*)&std::get<bool>(probe.variantValue);
+
+		if ((const char*)&probe.type != base || integer != number || number != boolean)
+			return -1;
+
+		return (int32_t)(integer - base);
+	}
+
+	const yo::Value NONE_VALUE;
+	const yo::Value TRUE_VALUE = { true };
+	const yo::Value FALSE_VALUE = { false };
+}
+
+static_assert(std::is_trivially_copyable_v<yo::Value> && sizeof(yo::Value) % 8 == 0, "Native code copies values eight bytes at a time.");
+static_assert(sizeof(yo::ValueType) == 4, "Native code compares value types as 32-bit words.");
+
+int64_t yo::JitCode::enter(VirtualMachine& vm, size_t offset) const
+{
+	using Entry = int64_t(*)(VirtualMachine*, const void*, Value*);
+
+	if (!hasEntry(offset) || vm.vmStack.size() != (size_t)depths[offset])
+		return (int64_t)offset;
+
+	vm.vmStack.resize(maxDepth);
+
+	Entry entry = (Entry)memory.data();
+	int64_t exit = entry(&vm, memory.data() + entries[offset], vm.vmStack.data());
+
+	// A finished script leaves nothing on the stack anything reads again.
+	vm.vmStack.resize(exit == RETURNED ? 0 : (size_t)depths[exit]);
+	return exit;
+}
+
+bool yo::BaselineJit::supported()
+{
+	#ifdef YOCTA_JIT_SUPPORTED
+	return true;
+	#else
+	return false;
+	#endif
+}
+
+std::unique_ptr<yo::JitCode> yo::BaselineJit::compile(VirtualMachine& vm, Chunk& chunk)
+{
+	constexpr int32_t SLOT = (int32_t)sizeof(Value);
+	const int32_t payload = payloadOffset();
+
+	if (!supported() || chunk.data.empty() || payload < 0)
+		return nullptr;
+
+	auto jitCode = std::make_unique<JitCode>();
+	jitCode->entries.assign(chunk.data.size(), -1);
+
+	const std::vector<int>& depths = jitCode->depths;
+	if (!stackDepths(chunk.data.data(), chunk.data.size(), jitCode->depths))
+		return nullptr;
+
+	jitCode->maxDepth = (size_t)*std::max_element(depths.begin(), depths.end());
+
+	// Global accesses share the interpreter's per-site caches, which must not move once code points into them.
+	std::vector<GlobalCache>& caches = chunk.profile.globalCaches;
+	if (caches.empty())
+		caches.resize(chunk.data.size());
+
+	// Where paths join; a compare is only fused with the branch after it when nothing else reaches the branch.
+	std::vector<bool> targets(chunk.data.size());
+
+	for (size_t offset = 0; offset < chunk.data.size(); offset += instructionLength(chunk.data[offset]))
+	{
+		OPCode operation = (OPCode)chunk.data[offset];
+		if (operation != OPCode::OP_JUMP && operation != OPCode::OP_JUMP_IF_FALSE && operation != OPCode::OP_LOOP)
+			continue;
+
+		size_t distance = (size_t)((chunk.data[offset + 1] << 8) | chunk.data[offset + 2]);
+		size_t target = operation == OPCode::OP_LOOP ? offset + 3 - distance : offset + 3 + distance;
+
+		if (target < targets.size())
+			targets[target] = true;
+	}
+
+	// The VM lives in RBX while native code runs, so its fields are addressed relative to it.
+	auto field = [&](const void* address) { return (int32_t)((const char*)address - (const char*)&vm); };
+
+	const int32_t fuel = field(&vm.fuel);
+	const int32_t requested = field(&vm.vmHeap.requested);
+	const int32_t used = field(&vm.vmHeap.memoryAccount.used);
+	const int32_t limit = field(&vm.vmHeap.memoryAccount.byteLimit);
+	const int32_t globalsVersion = field(&vm.vmGlobals.layoutVersion);
+
+	X64Assembler assembler;
+	std::vector<std::pair<size_t, size_t>> jumps;
+
+	// Entry stub: RBX holds the VM and RBP the stack for the whole chunk; the third push keeps calls 16-byte aligned.
+	assembler.push(X64Register::RBX);
+	assembler.push(X64Register::RBP);
+	assembler.push(X64Register::RCX);
+	assembler.movRegister(X64Register::RBX, X64Register::RDI);
+	assembler.movRegister(X64Register::RBP, X64Register::RDX);
+	assembler.jumpRegister(X64Register::RSI);
+
+	size_t epilogue = assembler.position();
+	assembler.pop(X64Register::RCX);
+	assembler.pop(X64Register::RBP);
+	assembler.pop(X64Register::RBX);
+	assembler.ret();
+
+	// Slow paths and side exits go after the chunk, so the inline code falls straight through on its fast path.
+	struct ColdPath
+	{
+		std::vector<size_t> fixups;
+		std::function<void()> emit;
+	};
+
+	std::vector<ColdPath> coldPaths;
+
+	auto exitTo = [&](int64_t offset)
+	{
+		assembler.movImmediate64(X64Register::RAX, (uint64_t)offset);
+		assembler.patchRelative32(assembler.jump(), epilogue);
+	};
+
+	auto resumeAt = [&](size_t resume)
+	{
+		assembler.patchRelative32(assembler.jump(), resume);
+	};
+
+	auto loadAddress = [&](X64Register destination, const void* address)
+	{
+		assembler.movImmediate64(destination, (uint64_t)(uintptr_t)address);
+	};
+
+	// Copies a whole value through RDX, so neither base may be RDX.
+	auto copyValue = [&](X64Register toBase, int32_t to, X64Register fromBase, int32_t from)
+	{
+		for (int32_t word = 0; word < SLOT; word += 8)
+		{
+			assembler.load(X64Register::RDX, fromBase, from + word);
+			assembler.store(toBase, to + word, X64Register::RDX);
+		}
+	};
+
+	auto guardType = [&](int32_t slot, ValueType type)
+	{
+		assembler.cmpMemory32(X64Register::RBP, slot, (int8_t)type);
+		return assembler.jumpIf(X64Condition::NOT_EQUAL);
+	};
+
+	// Writes the bool in RAX over the value in slot.
+	auto storeBoolean = [&](int32_t slot)
+	{
+		loadAddress(X64Register::RCX, &FALSE_VALUE);
+		copyValue(X64Register::RBP, slot, X64Register::RCX, 0);
+		assembler.store(X64Register::RBP, slot + payload, X64Register::RAX);
+	};
+
+	// Jumps to target when the value in slot is none or false, as the interpreter's isBooleanFalse decides.
+	auto branchIfFalse = [&](int32_t slot, size_t target)
+	{
+		assembler.cmpMemory32(X64Register::RBP, slot, (int8_t)ValueType::VT_NONE);
+		jumps.push_back({ assembler.jumpIf(X64Condition::EQUAL), target });
+
+		assembler.cmpMemory32(X64Register::RBP, slot, (int8_t)ValueType::VT_BOOL);
+		size_t done = assembler.jumpShortIf(X64Condition::NOT_EQUAL);
+
+		assembler.cmpMemory8(X64Register::RBP, slot + payload, 0);
+		jumps.push_back({ assembler.jumpIf(X64Condition::EQUAL), target });
+		assembler.patchRelative8(done, assembler.position());
+	};
+
+	// Helpers take the VM and a stack slot; the fallible ones send the instruction back to the interpreter on refusal.
+	auto callHelper = [&](const void* helper, int32_t slot)
+	{
+		assembler.movRegister(X64Register::RDI, X64Register::RBX);
+		assembler.lea(X64Register::RSI, X64Register::RBP, slot);
+		assembler.callAbsolute(helper);
+	};
+
+	auto checkHelper = [&](size_t offset)
+	{
+		assembler.testEax();
+		size_t fixup = assembler.jumpShortIf(X64Condition::EQUAL);
+		exitTo((int64_t)offset);
+		assembler.patchRelative8(fixup, assembler.position());
+	};
+
+	auto callFallible = [&](const void* helper, int32_t slot, size_t offset)
+	{
+		callHelper(helper, slot);
+		checkHelper(offset);
+	};
+
+	for (size_t offset = 0; offset < chunk.data.size(); offset += instructionLength(chunk.data[offset]))
+	{
+		// Code no path reaches has no stack depth, and nothing jumps to it.
+		if (depths[offset] < 0)
+			continue;
+
+		jitCode->entries[offset] = (int32_t)assembler.position();
+
+		const uint8_t* instruction = &chunk.data[offset];
+		uint16_t jumpOffset = instructionLength(*instruction) == 3 ? (uint16_t)((instruction[1] << 8) | instruction[2]) : 0;
+
+		OPCode operation = genericOperation((OPCode)*instruction);
+		int32_t top = (depths[offset] - 1) * SLOT;
+		int32_t second = top - SLOT;
+
+		switch (operation)
+		{
+			case OPCode::OP_RETURN:
+				exitTo(JitCode::RETURNED);
+				break;
+
+			case OPCode::OP_CONSTANT:
+				loadAddress(X64Register::RCX, &chunk.constantPool[instruction[1]]);
+				copyValue(X64Register::RBP, top + SLOT, X64Register::RCX, 0);
+				break;
+
+			case OPCode::OP_NONE:
+			case OPCode::OP_TRUE:
+			case OPCode::OP_FALSE:
+			{
+				const Value* literal = operation == OPCode::OP_NONE ? &NONE_VALUE : operation == OPCode::OP_TRUE ? &TRUE_VALUE : &FALSE_VALUE;
+
+				loadAddress(X64Register::RCX, literal);
+				copyValue(X64Register::RBP, top + SLOT, X64Register::RCX, 0);
+				break;
+			}
+
+			case OPCode::OP_GET_LOCAL_VAR:
+				copyValue(X64Register::RBP, top + SLOT, X64Register::RBP, instruction[1] * SLOT);
+				break;
+
+			case OPCode::OP_SET_LOCAL_VAR:
+				copyValue(X64Register::RBP, instruction[1] * SLOT, X64Register::RBP, top);
+				break;
+
+			case OPCode::OP_POP_BACK:
+				break;
+
+			case OPCode::OP_ADD:
+			case OPCode::OP_SUB:
+			case OPCode::OP_MULT:
+			{
+				const void* helper = operation == OPCode::OP_ADD ? (const void*)&binary<OPCode::OP_ADD> :
+					operation == OPCode::OP_SUB ? (const void*)&binary<OPCode::OP_SUB> : (const void*)&binary<OPCode::OP_MULT>;
+
+				std::vector<size_t> notIntegers = { guardType(second, ValueType::VT_INTEGER), guardType(top, ValueType::VT_INTEGER) };
+
+				assembler.load(X64Register::RAX, X64Register::RBP, second + payload);
+				assembler.load(X64Register::RCX, X64Register::RBP, top + payload);
+
+				if (operation == OPCode::OP_ADD)
+					assembler.add(X64Register::RAX, X64Register::RCX);
+				else if (operation == OPCode::OP_SUB)
+					assembler.sub(X64Register::RAX, X64Register::RCX);
+				else
+					assembler.imul(X64Register::RAX, X64Register::RCX);
+
+				size_t overflow = assembler.jumpIf(X64Condition::OVERFLOW);
+				assembler.store(X64Register::RBP, second + payload, X64Register::RAX);
+
+				size_t resume = assembler.position();
+
+				// Two doubles stay native; mixed operands, strings and integer overflow go through the helper.
+				coldPaths.push_back({ notIntegers, [=, &assembler]()
+				{
+					std::vector<size_t> generic = { guardType(second, ValueType::VT_NUMERIC), guardType(top, ValueType::VT_NUMERIC) };
+
+					assembler.loadDouble(X64FloatRegister::XMM0, X64Register::RBP, second + payload);
+					assembler.loadDouble(X64FloatRegister::XMM1, X64Register::RBP, top + payload);
+
+					if (operation == OPCode::OP_ADD)
+						assembler.addDouble(X64FloatRegister::XMM0, X64FloatRegister::XMM1);
+					else if (operation == OPCode::OP_SUB)
+						assembler.subDouble(X64FloatRegister::XMM0, X64FloatRegister::XMM1);
+					else
+						assembler.multDouble(X64FloatRegister::XMM0, X64FloatRegister::XMM1);
+
+					assembler.storeDouble(X64Register::RBP, second + payload, X64FloatRegister::XMM0);
+					resumeAt(resume);
+
+					for (size_t fixup : generic)
+						assembler.patchRelative32(fixup, assembler.position());
+
+					callFallible(helper, second, offset);
+					resumeAt(resume);
+				} });
+
+				coldPaths.push_back({ { overflow }, [=]()
+				{
+					callFallible(helper, second, offset);
+					resumeAt(resume);
+				} });
+				break;
+			}
+
+			case OPCode::OP_DIV:
+			{
+				std::vector<size_t> generic = { guardType(second, ValueType::VT_NUMERIC), guardType(top, ValueType::VT_NUMERIC) };
+
+				assembler.loadDouble(X64FloatRegister::XMM0, X64Register::RBP, second + payload);
+				assembler.loadDouble(X64FloatRegister::XMM1, X64Register::RBP, top + payload);
+				assembler.divDouble(X64FloatRegister::XMM0, X64FloatRegister::XMM1);
+				assembler.storeDouble(X64Register::RBP, second + payload, X64FloatRegister::XMM0);
+
+				size_t resume = assembler.position();
+
+				coldPaths.push_back({ generic, [=]()
+				{
+					callFallible((const void*)&binary<OPCode::OP_DIV>, second, offset);
+					resumeAt(resume);
+				} });
+				break;
+			}
+
+			case OPCode::OP_MOD:
+			{
+				std::vector<size_t> generic = { guardType(second, ValueType::VT_INTEGER), guardType(top, ValueType::VT_INTEGER) };
+
+				// Zero is an error and -1 may overflow idiv; both are the helper's to handle.
+				assembler.load(X64Register::RCX, X64Register::RBP, top + payload);
+				assembler.cmpImmediate8(X64Register::RCX, 0);
+				generic.push_back(assembler.jumpIf(X64Condition::EQUAL));
+				assembler.cmpImmediate8(X64Register::RCX, -1);
+				generic.push_back(assembler.jumpIf(X64Condition::EQUAL));
+
+				assembler.load(X64Register::RAX, X64Register::RBP, second + payload);
+				assembler.cqo();
+				assembler.idiv(X64Register::RCX);
+				assembler.store(X64Register::RBP, second + payload, X64Register::RDX);
+
+				size_t resume = assembler.position();
+
+				coldPaths.push_back({ generic, [=]()
+				{
+					callFallible((const void*)&binary<OPCode::OP_MOD>, second, offset);
+					resumeAt(resume);
+				} });
+				break;
+			}
+
+			case OPCode::OP_LESS:
+			case OPCode::OP_GREATER:
+			{
+				bool less = operation == OPCode::OP_LESS;
+				const void* helper = less ? (const void*)&binary<OPCode::OP_LESS> : (const void*)&binary<OPCode::OP_GREATER>;
+
+				// A compare whose result only feeds the branch after it, popped on both ways out, becomes the branch.
+				size_t branch = offset + 1;
+				size_t fallthrough = branch + 3;
+				size_t target = 0;
+
+				bool fused = branch < chunk.data.size() && chunk.data[branch] == (uint8_t)OPCode::OP_JUMP_IF_FALSE && !targets[branch];
+				if (fused)
+				{
+					target = fallthrough + (size_t)((chunk.data[branch + 1] << 8) | chunk.data[branch + 2]);
+					fused = target < chunk.data.size() && fallthrough < chunk.data.size() &&
+						chunk.data[target] == (uint8_t)OPCode::OP_POP_BACK && chunk.data[fallthrough] == (uint8_t)OPCode::OP_POP_BACK;
+				}
+
+				std::vector<size_t> notIntegers = { guardType(second, ValueType::VT_INTEGER), guardType(top, ValueType::VT_INTEGER) };
+
+				assembler.load(X64Register::RAX, X64Register::RBP, second + payload);
+				assembler.load(X64Register::RCX, X64Register::RBP, top + payload);
+				assembler.cmp(X64Register::RAX, X64Register::RCX);
+
+				if (fused)
+					jumps.push_back({ assembler.jumpIf(less ? X64Condition::GREATER_OR_EQUAL : X64Condition::LESS_OR_EQUAL), target });
+				else
+				{
+					assembler.setCondition(less ? X64Condition::LESS : X64Condition::GREATER, X64Register::RAX);
+					assembler.movzxByte(X64Register::RAX);
+					storeBoolean(second);
+				}
+
+				size_t resume = assembler.position();
+
+				// Unordered doubles compare false both ways, which the ABOVE conditions give.
+				coldPaths.push_back({ notIntegers, [=, &assembler, &jumps]()
+				{
+					std::vector<size_t> generic = { guardType(second, ValueType::VT_NUMERIC), guardType(top, ValueType::VT_NUMERIC) };
+
+					assembler.loadDouble(X64FloatRegister::XMM0, X64Register::RBP, second + payload);
+					assembler.loadDouble(X64FloatRegister::XMM1, X64Register::RBP, top + payload);
+
+					if (less)
+						assembler.compareDouble(X64FloatRegister::XMM1, X64FloatRegister::XMM0);
+					else
+						assembler.compareDouble(X64FloatRegister::XMM0, X64FloatRegister::XMM1);
+
+					if (fused)
+						jumps.push_back({ assembler.jumpIf(X64Condition::BELOW_OR_EQUAL), target });
+					else
+					{
+						assembler.setCondition(X64Condition::ABOVE, X64Register::RAX);
+						assembler.movzxByte(X64Register::RAX);
+						storeBoolean(second);
+					}
+
+					resumeAt(resume);
+
+					for (size_t fixup : generic)
+						assembler.patchRelative32(fixup, assembler.position());
+
+					callFallible(helper, second, offset);
+
+					if (fused)
+						branchIfFalse(second, target);
+
+					resumeAt(resume);
+				} });
+
+				if (fused)
+					offset = branch;
+				break;
+			}
+
+			case OPCode::OP_EQUAL:
+				callHelper((const void*)&equal, second);
+				break;
+
+			case OPCode::OP_NEGATE:
+				callFallible((const void*)&negate, top, offset);
+				break;
+
+			case OPCode::OP_NOT:
+				callHelper((const void*)&logicalNot, top);
+				break;
+
+			case OPCode::OP_BIT_AND:
+				callFallible((const void*)&binary<OPCode::OP_BIT_AND>, second, offset);
+				break;
+
+			case OPCode::OP_BIT_OR:
+				callFallible((const void*)&binary<OPCode::OP_BIT_OR>, second, offset);
+				break;
+
+			case OPCode::OP_PRINT:
+				callHelper((const void*)&print, top);
+				break;
+
+			case OPCode::OP_GET_INDEX:
+				callFallible((const void*)&index<OPCode::OP_GET_INDEX>, second, offset);
+				break;
+
+			case OPCode::OP_SET_INDEX:
+				callFallible((const void*)&index<OPCode::OP_SET_INDEX>, second - SLOT, offset);
+				break;
+
+			case OPCode::OP_DELETE_INDEX:
+				callFallible((const void*)&index<OPCode::OP_DELETE_INDEX>, second, offset);
+				break;
+
+			case OPCode::OP_DEFINE_GLOBAL_VAR:
+				assembler.movRegister(X64Register::RDI, X64Register::RBX);
+				loadAddress(X64Register::RSI, &chunk.constantPool[instruction[1]]);
+				assembler.lea(X64Register::RDX, X64Register::RBP, top);
+				assembler.callAbsolute((const void*)&defineGlobal);
+				checkHelper(offset);
+				break;
+
+			case OPCode::OP_GET_GLOBAL_VAR:
+			case OPCode::OP_SET_GLOBAL_VAR:
+			{
+				GlobalCache* cache = &caches[offset];
+				const Value* name = &chunk.constantPool[instruction[1]];
+
+				// The cached slot is good while the globals keep the layout they had when it was filled.
+				loadAddress(X64Register::RCX, cache);
+				assembler.load(X64Register::RAX, X64Register::RCX, (int32_t)offsetof(GlobalCache, value));
+				assembler.load32(X64Register::RDX, X64Register::RCX, (int32_t)offsetof(GlobalCache, version));
+				assembler.load32(X64Register::RSI, X64Register::RBX, globalsVersion);
+				assembler.cmp(X64Register::RDX, X64Register::RSI);
+				size_t stale = assembler.jumpIf(X64Condition::NOT_EQUAL);
+				assembler.testRegister(X64Register::RAX);
+				size_t empty = assembler.jumpIf(X64Condition::EQUAL);
+
+				size_t resume = assembler.position();
+
+				if (operation == OPCode::OP_GET_GLOBAL_VAR)
+					copyValue(X64Register::RBP, top + SLOT, X64Register::RAX, 0);
+				else
+					copyValue(X64Register::RAX, 0, X64Register::RBP, top);
+
+				coldPaths.push_back({ { stale, empty }, [=, &assembler]()
+				{
+					assembler.movRegister(X64Register::RDI, X64Register::RBX);
+					loadAddress(X64Register::RSI, name);
+					loadAddress(X64Register::RDX, cache);
+					assembler.callAbsolute((const void*)&findGlobal);
+					assembler.testRegister(X64Register::RAX);
+					assembler.patchRelative32(assembler.jumpIf(X64Condition::NOT_EQUAL), resume);
+					exitTo((int64_t)offset);
+				} });
+				break;
+			}
+
+			case OPCode::OP_INCREMENT_LOCAL:
+			{
+				int32_t local = instruction[1] * SLOT;
+				const Value* step = &chunk.constantPool[instruction[2]];
+
+				auto slowPath = [=, &assembler]()
+				{
+					assembler.movRegister(X64Register::RDI, X64Register::RBX);
+					assembler.lea(X64Register::RSI, X64Register::RBP, local);
+					loadAddress(X64Register::RDX, step);
+					assembler.callAbsolute((const void*)&incrementLocal);
+					checkHelper(offset);
+				};
+
+				if (step->type != ValueType::VT_INTEGER)
+				{
+					slowPath();
+					break;
+				}
+
+				std::vector<size_t> generic = { guardType(local, ValueType::VT_INTEGER) };
+
+				assembler.load(X64Register::RAX, X64Register::RBP, local + payload);
+				assembler.movImmediate64(X64Register::RCX, (uint64_t)std::get<int64_t>(step->variantValue));
+				assembler.add(X64Register::RAX, X64Register::RCX);
+				generic.push_back(assembler.jumpIf(X64Condition::OVERFLOW));
+				assembler.store(X64Register::RBP, local + payload, X64Register::RAX);
+
+				size_t resume = assembler.position();
+
+				coldPaths.push_back({ generic, [=]()
+				{
+					slowPath();
+					resumeAt(resume);
+				} });
+				break;
+			}
+
+			case OPCode::OP_JUMP:
+				jumps.push_back({ assembler.jump(), offset + 3 + jumpOffset });
+				break;
+
+			case OPCode::OP_JUMP_IF_FALSE:
+				branchIfFalse(top, offset + 3 + jumpOffset);
+				break;
+
+			// The interpreter's safe point: a requested collection or spent fuel sends the loop back to it.
+			case OPCode::OP_LOOP:
+			{
+				assembler.cmpMemory8(X64Register::RBX, requested, 0);
+				size_t collect = assembler.jumpIf(X64Condition::NOT_EQUAL);
+
+				assembler.load(X64Register::RAX, X64Register::RBX, used);
+				assembler.load(X64Register::RCX, X64Register::RBX, limit);
+				assembler.cmp(X64Register::RAX, X64Register::RCX);
+				size_t exceeded = assembler.jumpIf(X64Condition::ABOVE);
+
+				assembler.subMemory(X64Register::RBX, fuel, jumpOffset);
+				size_t spent = assembler.jumpIf(X64Condition::LESS_OR_EQUAL);
+
+				jumps.push_back({ assembler.jump(), offset + 3 - jumpOffset });
+
+				coldPaths.push_back({ { collect, exceeded }, [=]() { exitTo((int64_t)offset); } });
+
+				// The interpreter charges the back-edge itself when it runs the instruction again.
+				coldPaths.push_back({ { spent }, [=, &assembler]()
+				{
+					assembler.addMemory(X64Register::RBX, fuel, jumpOffset);
+					exitTo((int64_t)offset);
+				} });
+				break;
+			}
+
+			// Calls, iteration, allocation and coroutines stay in the interpreter.
+			default:
+				exitTo((int64_t)offset);
+				break;
+		}
+	}
+
+	// Cold paths may add cold jumps of their own, into the chunk, but no further cold paths.
+	for (size_t i = 0; i < coldPaths.size(); ++i)
+	{
+		for (size_t fixup : coldPaths[i].fixups)
+			assembler.patchRelative32(fixup, assembler.position());
+
+		coldPaths[i].emit();
+	}
+
+	for (const auto& [fixup, target] : jumps)
+	{
+		if (target >= jitCode->entries.size() || jitCode->entries[target] < 0)
+			return nullptr;
+
+		assembler.patchRelative32(fixup, (size_t)jitCode->entries[target]);
+	}
+
+	if (!jitCode->memory.load(assembler.code))
+		return nullptr;
+
+	return jitCode;
+}
+
+template<yo::OPCode Operation>
+int yo::BaselineJit::binary(VirtualMachine* vm, Value* operands)
+{
+	Value& a = operands[0];
+	const Value& b = operands[1];
+
+	// Anything that could fail is left for the interpreter to report.
+	if (Operation == OPCode::OP_ADD && isString(a) && isString(b))
+	{
+		size_t length = stringLength(a) + stringLength(b);
+
+		if (!vm->vmHeap.account().fits(length) || length > StringObject::MAX_LENGTH)
+			return 1;
+	}
+	else if (Operation == OPCode::OP_BIT_AND || Operation == OPCode::OP_BIT_OR)
+	{
+		if (a.type != ValueType::VT_INTEGER || b.type != ValueType::VT_INTEGER)
+			return 1;
+	}
+	else if (!isNumber(a) || !isNumber(b))
+		return 1;
+	else if ((Operation == OPCode::OP_DIV || Operation == OPCode::OP_MOD) &&
+		a.type == ValueType::VT_INTEGER && b.type == ValueType::VT_INTEGER && std::get<int64_t>(b.variantValue) == 0)
+		return 1;
+
+	switch (Operation)
+	{
+	case OPCode::OP_ADD:
+		a = a + b;
+		break;
+
+	case OPCode::OP_SUB:
+		a = a - b;
+		break;
+
+	case OPCode::OP_MULT:
+		a = a * b;
+		break;
+
+	case OPCode::OP_DIV:
+		a = a / b;
+		break;
+
+	case OPCode::OP_MOD:
+		a = a % b;
+		break;
+
+	case OPCode::OP_BIT_AND:
+		a = a & b;
+		break;
+
+	case OPCode::OP_BIT_OR:
+		a = a | b;
+		break;
+
+	case OPCode::OP_LESS:
+		a = { a < b };
+		break;
+
+	case OPCode::OP_GREATER:
+		a = { a > b };
+		break;
+
+	default:
+		break;
+	}
+
+	return 0;
+}
+
+template<yo::OPCode Operation>
+int yo::BaselineJit::index(VirtualMachine* vm, Value* container)
+{
+	const Value& key = container[1];
+
+	// Only accesses that cannot fail run here, so the interpreter still reports every error.
+	if (isObjectType(*container, ObjectType::NUMERIC_ARRAY))
+	{
+		const std::vector<double>& data = static_cast<NumericArrayObject*>(std::get<YoctaObject*>(container->variantValue))->data;
+
+		if (Operation == OPCode::OP_DELETE_INDEX || key.type != ValueType::VT_INTEGER)
+			return 1;
+
+		int64_t position = std::get<int64_t>(key.variantValue);
+		if (position < 0 || (uint64_t)position >= data.size() || (Operation == OPCode::OP_SET_INDEX && !isNumber(container[2])))
+			return 1;
+	}
+	else if (!isObjectType(*container, ObjectType::MAP))
+		return 1;
+
+	// indexOperation works on the top of the stack, so the stack is cut to this instruction's depth around it. It has
+	// room for the deepest point already, so neither resize moves it.
+	ValueStack& stack = vm->vmStack;
+	size_t size = stack.size();
+
+	stack.resize((size_t)(container - stack.data()) + (Operation == OPCode::OP_SET_INDEX ? 3 : 2));
+	vm->indexOperation(Operation);
+	stack.resize(size);
+
+	return 0;
+}
+
+int yo::BaselineJit::negate(VirtualMachine* vm, Value* value)
+{
+	if (!isNumber(*value))
+		return 1;
+
+	*value = -*value;
+	return 0;
+}
+
+void yo::BaselineJit::equal(VirtualMachine* vm, Value* operands)
+{
+	operands[0] = { operands[0] == operands[1] };
+}
+
+void yo::BaselineJit::logicalNot(VirtualMachine* vm, Value* value)
+{
+	*value = { vm->isBooleanFalse(*value) };
+}
+
+void yo::BaselineJit::print(VirtualMachine* vm, Value* value)
+{
+	displayValue(*value);
+	printf("\n");
+}
+
+int yo::BaselineJit::defineGlobal(VirtualMachine* vm, const Value* name, const Value* value)
+{
+	return vm->defineGlobal(*name, *value) ? 0 : 1;
+}
+
+yo::Value* yo::BaselineJit::findGlobal(VirtualMachine* vm, const Value* name, GlobalCache* cache)
+{
+	Value* value = vm->findGlobal(*name);
+
+	if (value)
+		*cache = { value, vm->vmGlobals.version() };
+
+	return value;
+}
+
+int yo::BaselineJit::incrementLocal(VirtualMachine* vm, Value* local, const Value* step)
+{
+	Value operands[] = { *local, *step };
+
+	if (binary<OPCode::OP_ADD>(vm, operands))
+		return 1;
+
+	*local = operands[0];
+	return 0;
+}
\ No newline at end of file
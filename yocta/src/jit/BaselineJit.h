@@ -0,0 +1,64 @@
+#pragma once
+#include <memory>
+
+#include "ExecutableMemory.h"
+#include "JitSupport.h"
+#include "Chunk.h"
+
+namespace yo
+{
+	class VirtualMachine;
+
+	class JitCode
+	{
+	public:
+		static constexpr int64_t RETURNED = -1;
+
+	public:
+		int64_t enter(VirtualMachine& vm, size_t offset) const;
+
+		bool hasEntry(size_t offset) const { return offset < entries.size() && entries[offset] >= 0; }
+
+	public:
+		ExecutableMemory memory;
+		std::vector<int32_t> entries;
+
+		// The stack depth before each instruction. Native code keeps every value in the slot its depth gives it, so the
+		// stack is sized for the deepest point while it runs and cut back to the depth of the instruction it leaves at.
+		std::vector<int> depths;
+		size_t maxDepth = 0;
+	};
+
+	class BaselineJit
+	{
+	public:
+		static bool supported();
+
+		// Code for chunk as run by vm, whose fields and global caches it addresses directly.
+		static std::unique_ptr<JitCode> compile(VirtualMachine& vm, Chunk& chunk);
+
+	private:
+		// The paths the inline code does not take. Each gets the stack slot of the instruction's first operand; the
+		// fallible ones return nonzero, having changed nothing, when the instruction must go back to the interpreter.
+		template<OPCode Operation>
+		static int binary(VirtualMachine* vm, Value* operands);
+
+		template<OPCode Operation>
+		static int index(VirtualMachine* vm, Value* container);
+
+		static int negate(VirtualMachine* vm, Value* value);
+
+		static void equal(VirtualMachine* vm, Value* operands);
+
+		static void logicalNot(VirtualMachine* vm, Value* value);
+
+		static void print(VirtualMachine* vm, Value* value);
+
+		static int defineGlobal(VirtualMachine* vm, const Value* name, const Value* value);
+
+		// Fills the site's cache the way the interpreter's cached instructions do; null for an undefined name.
+		static Value* findGlobal(VirtualMachine* vm, const Value* name, GlobalCache* cache);
+
+		static int incrementLocal(VirtualMachine* vm, Value* local, const Value* step);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "ExecutableMemory.h"
+#include "JitSupport.h"
+
+#include <cstring>
+
+#ifdef YOCTA_JIT_SUPPORTED
+#include <sys/mman.h>
+#endif
+
+yo::ExecutableMemory::~ExecutableMemory()
+{
+	release();
+}
+
+bool yo::ExecutableMemory::load(const std::vector<uint8_t>& code)
+{
+	release();
+
+	#ifdef YOCTA_JIT_SUPPORTED
+	void* region = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (region == MAP_FAILED)
+		return false;
+
+	std::memcpy(region, code.data(), code.size());
+
+	if (mprotect(region, code.size(), PROT_READ | PROT_EXEC) != 0)
+	{
+		munmap(region, code.size());
+		return false;
+	}
+
+	memory = (uint8_t*)region;
+	length = code.size();
+
+	return true;
+	#else
+	return false;
+	#endif
+}
+
+void yo::ExecutableMemory::release()
+{
+	#ifdef YOCTA_JIT_SUPPORTED
+	if (memory)
+		munmap(memory, length);
+	#endif
+
+	memory = nullptr;
+	length = 0;
+}
\ No newline at end of file
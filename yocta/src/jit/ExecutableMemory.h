@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace yo
+{
+	class ExecutableMemory
+	{
+	public:
+		ExecutableMemory() = default;
+
+		ExecutableMemory(const ExecutableMemory&) = delete;
+
+		ExecutableMemory& operator=(const ExecutableMemory&) = delete;
+
+		~ExecutableMemory();
+
+	public:
+		bool load(const std::vector<uint8_t>& code);
+
+		void release();
+
+	public:
+		const uint8_t* data() const { return memory; }
+
+		size_t size() const { return length; }
+
+	private:
+		uint8_t* memory = nullptr;
+		size_t length = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+#pragma once
+
+#if defined(__linux__) && defined(__x86_64__)
+#define YOCTA_JIT_SUPPORTED
+#endif
\ No newline at end of file
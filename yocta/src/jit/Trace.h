@@ -0,0 +1,97 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "ExecutableMemory.h"
+#include "Value.h"
+
+namespace yo
+{
+	enum class TraceType : uint8_t
+	{
+		INTEGER = 0,
+		NUMERIC,
+		BOOL
+	};
+
+	struct TraceInstruction
+	{
+	public:
+		size_t offset;
+		ValueType operands[2];
+		ValueType variable;
+	};
+
+	struct TraceVariable
+	{
+	public:
+		bool global;
+		uint8_t index;
+		TraceType type;
+	};
+
+	struct TraceOperand
+	{
+	public:
+		bool constant;
+		TraceType type;
+		int32_t slot;
+		int64_t bits;
+	};
+
+	struct TraceExit
+	{
+	public:
+		size_t resumeOffset;
+		std::vector<TraceType> variableTypes;
+		std::vector<TraceOperand> stack;
+	};
+
+	struct Trace
+	{
+	public:
+		using Function = uint32_t(*)(int64_t* frame);
+
+		static constexpr int MAX_VARIABLES = 64;
+		static constexpr int ITERATIONS_SLOT = MAX_VARIABLES;
+		static constexpr int ITERATION_LIMIT_SLOT = ITERATIONS_SLOT + 1;
+		static constexpr int TEMPORARY_BASE = ITERATION_LIMIT_SLOT + 1;
+
+	public:
+		Function function() const { return (Function)memory.data(); }
+
+	public:
+		size_t header = 0;
+		size_t stackSize = 0;
+		size_t frameSize = 0;
+		size_t fuelPerIteration = 1;
+		uint32_t shortRuns = 0;
+
+		std::vector<TraceVariable> variables;
+		std::vector<TraceExit> exits;
+
+		ExecutableMemory memory;
+	};
+
+	inline Value boxTraceValue(int64_t bits, TraceType type)
+	{
+		switch (type)
+		{
+		case TraceType::INTEGER:
+			return { (int64_t)bits };
+
+		case TraceType::NUMERIC:
+		{
+			double number;
+			std::memcpy(&number, &bits, sizeof(number));
+			return { number };
+		}
+
+		default:
+			break;
+		}
+
+		return { bits != 0 };
+	}
+}
\ No newline at end of file
@@ -0,0 +1,781 @@
+#include "TraceCompiler.h"
+#include <cstring>
+
+yo::TraceCompiler::TraceCompiler(const Chunk& chunk, size_t header, size_t stackSize)
+	: chunk(chunk), header(header), trace(std::make_unique<Trace>())
+{
+	trace->header = header;
+	trace->stackSize = stackSize;
+}
+
+std::unique_ptr<yo::Trace> yo::TraceCompiler::compile(const std::vector<TraceInstruction>& instructions)
+{
+	if (instructions.empty() || chunk.data[instructions.back().offset] != (uint8_t)OPCode::OP_LOOP)
+	{
+		abort("trace does not close the loop");
+		return nullptr;
+	}
+
+	trace->fuelPerIteration = instructions.back().offset + 3 - header;
+
+	for (size_t i = 0; i < instructions.size(); ++i)
+	{
+		bool last = i + 1 == instructions.size();
+
+		if (!compileInstruction(instructions[i], last ? header : instructions[i + 1].offset, last))
+			return nullptr;
+	}
+
+	// Side exits only report which snapshot to restore; boxing happens back in C++.
+	for (const auto& [fixup, index] : exitJumps)
+	{
+		assembler.patchRelative32(fixup, assembler.position());
+		assembler.movImmediate32(X64Register::RAX, index);
+		assembler.ret();
+	}
+
+	trace->frameSize = Trace::TEMPORARY_BASE + maxDepth + 1;
+
+	if (!trace->memory.load(assembler.code))
+	{
+		abort("could not map executable memory");
+		return nullptr;
+	}
+
+	return std::move(trace);
+}
+
+bool yo::TraceCompiler::compileInstruction(const TraceInstruction& instruction, size_t next, bool last)
+{
+	const uint8_t* code = &chunk.data[instruction.offset];
+	uint16_t jump = instructionLength(*code) == 3 ? (uint16_t)((code[1] << 8) | code[2]) : 0;
+	OPCode operation = genericOperation((OPCode)*code);
+
+	// The trace starts with nothing of its own on the stack, so taking more than it pushed would reach into the
+	// scope around the loop.
+	if (stack.size() < operandCount(operation))
+		return abort("trace leaves the loop's scope");
+
+	switch (operation)
+	{
+		case OPCode::OP_CONSTANT:
+		{
+			TraceOperand operand;
+			if (!fromValue(chunk.constantPool[code[1]], operand))
+				return abort("unsupported constant");
+
+			push(operand);
+			return true;
+		}
+
+		case OPCode::OP_TRUE:
+		case OPCode::OP_FALSE:
+			push({ true, TraceType::BOOL, -1, *code == (uint8_t)OPCode::OP_TRUE });
+			return true;
+
+		case OPCode::OP_GET_LOCAL_VAR:
+		case OPCode::OP_GET_GLOBAL_VAR:
+		{
+			if (operation == OPCode::OP_GET_LOCAL_VAR && code[1] >= trace->stackSize)
+			{
+				size_t depth;
+				if (!findStackLocal(code[1], instruction.variable, depth))
+					return false;
+
+				TraceOperand local = stack[depth];
+				push(local);
+				return true;
+			}
+
+			int variable = findVariable(operation == OPCode::OP_GET_GLOBAL_VAR, code[1], instruction.variable);
+			if (variable < 0)
+				return false;
+
+			push({ false, variableTypes[variable], variable, 0 });
+			return true;
+		}
+
+		case OPCode::OP_SET_LOCAL_VAR:
+		case OPCode::OP_SET_GLOBAL_VAR:
+		{
+			if (operation == OPCode::OP_SET_LOCAL_VAR && code[1] >= trace->stackSize)
+			{
+				size_t depth;
+				if (!findStackLocal(code[1], instruction.variable, depth))
+					return false;
+
+				storeStackLocal(depth);
+				return true;
+			}
+
+			int variable = findVariable(operation == OPCode::OP_SET_GLOBAL_VAR, code[1], instruction.variable);
+			if (variable < 0)
+				return false;
+
+			storeVariable(variable);
+			return true;
+		}
+
+		case OPCode::OP_POP_BACK:
+			pop();
+			return true;
+
+		case OPCode::OP_ADD:
+		case OPCode::OP_SUB:
+		case OPCode::OP_MULT:
+		case OPCode::OP_DIV:
+		case OPCode::OP_MOD:
+			return arithmetic(operation, instruction);
+
+		case OPCode::OP_LESS:
+		case OPCode::OP_GREATER:
+		case OPCode::OP_EQUAL:
+			return comparison(operation, instruction);
+
+		case OPCode::OP_INCREMENT_LOCAL:
+			return incrementLocal(instruction);
+
+		case OPCode::OP_NEGATE:
+		case OPCode::OP_NOT:
+			return unary(operation, instruction);
+
+		case OPCode::OP_JUMP:
+			if (next != instruction.offset + 3 + jump)
+				return abort("trace does not follow the jump");
+			return true;
+
+		case OPCode::OP_JUMP_IF_FALSE:
+			return branch(instruction, next);
+
+		case OPCode::OP_LOOP:
+			if (last)
+				return instruction.offset + 3 - jump == header ? closeLoop() : abort("trace does not close the loop");
+
+			if (next != instruction.offset + 3 - jump)
+				return abort("trace does not follow the loop");
+			return true;
+
+		default:
+			break;
+	}
+
+	return abort("unsupported instruction");
+}
+
+bool yo::TraceCompiler::arithmetic(OPCode operation, const TraceInstruction& instruction, size_t fusedOperands)
+{
+	TraceOperand b = stack[stack.size() - 1];
+	TraceOperand a = stack[stack.size() - 2];
+
+	if (!matches(a, instruction.operands[1]) || !matches(b, instruction.operands[0]))
+		return abort("type mismatch");
+
+	if (a.type == TraceType::BOOL || b.type == TraceType::BOOL)
+		return abort("unsupported operand types");
+
+	bool integers = a.type == TraceType::INTEGER && b.type == TraceType::INTEGER;
+	bool division = operation == OPCode::OP_DIV || operation == OPCode::OP_MOD;
+
+	if (integers && division && b.constant && (b.bits == 0 || b.bits == -1))
+		return abort("division guard always fails");
+
+	if (a.constant && b.constant)
+	{
+		Value result;
+
+		switch (operation)
+		{
+		case OPCode::OP_ADD: result = toValue(a) + toValue(b); break;
+		case OPCode::OP_SUB: result = toValue(a) - toValue(b); break;
+		case OPCode::OP_MULT: result = toValue(a) * toValue(b); break;
+		case OPCode::OP_DIV: result = toValue(a) / toValue(b); break;
+		case OPCode::OP_MOD: result = toValue(a) % toValue(b); break;
+		default: break;
+		}
+
+		TraceOperand folded;
+		if (!fromValue(result, folded))
+			return abort("unsupported constant");
+
+		pop();
+		pop();
+		push(folded);
+		return true;
+	}
+
+	// A fused instruction resumes without the operands it pushed for itself.
+	std::vector<TraceOperand> before(stack.begin(), stack.end() - fusedOperands);
+
+	pop();
+	pop();
+
+	if (integers)
+	{
+		TraceOperand result = temporary(TraceType::INTEGER);
+
+		if (division)
+		{
+			loadInteger(X64Register::RCX, b);
+
+			if (!b.constant)
+			{
+				assembler.testRegister(X64Register::RCX);
+				exitIf(X64Condition::EQUAL, instruction.offset, before);
+
+				assembler.cmpImmediate8(X64Register::RCX, -1);
+				exitIf(X64Condition::EQUAL, instruction.offset, before);
+			}
+
+			loadInteger(X64Register::RAX, a);
+			assembler.cqo();
+			assembler.idiv(X64Register::RCX);
+
+			storeResult(result, operation == OPCode::OP_DIV ? X64Register::RAX : X64Register::RDX);
+		}
+		else
+		{
+			loadInteger(X64Register::RAX, a);
+			loadInteger(X64Register::RCX, b);
+
+			if (operation == OPCode::OP_ADD)
+				assembler.add(X64Register::RAX, X64Register::RCX);
+			else if (operation == OPCode::OP_SUB)
+				assembler.sub(X64Register::RAX, X64Register::RCX);
+			else
+				assembler.imul(X64Register::RAX, X64Register::RCX);
+
+			// On overflow the interpreter redoes the operation and promotes to a double.
+			exitIf(X64Condition::OVERFLOW, instruction.offset, before);
+			storeResult(result, X64Register::RAX);
+		}
+
+		push(result);
+		return true;
+	}
+
+	if (operation == OPCode::OP_MOD)
+		return abort("floating point modulo");
+
+	TraceOperand result = temporary(TraceType::NUMERIC);
+
+	loadDouble(X64FloatRegister::XMM0, a);
+	loadDouble(X64FloatRegister::XMM1, b);
+
+	switch (operation)
+	{
+	case OPCode::OP_ADD: assembler.addDouble(X64FloatRegister::XMM0, X64FloatRegister::XMM1); break;
+	case OPCode::OP_SUB: assembler.subDouble(X64FloatRegister::XMM0, X64FloatRegister::XMM1); break;
+	case OPCode::OP_MULT: assembler.multDouble(X64FloatRegister::XMM0, X64FloatRegister::XMM1); break;
+	case OPCode::OP_DIV: assembler.divDouble(X64FloatRegister::XMM0, X64FloatRegister::XMM1); break;
+	default: break;
+	}
+
+	assembler.storeDouble(X64Register::RDI, result.slot * 8, X64FloatRegister::XMM0);
+
+	push(result);
+	return true;
+}
+
+bool yo::TraceCompiler::incrementLocal(const TraceInstruction& instruction)
+{
+	const uint8_t* code = &chunk.data[instruction.offset];
+
+	TraceOperand step;
+	if (!fromValue(chunk.constantPool[code[2]], step))
+		return abort("unsupported constant");
+
+	bool declaredInside = code[1] >= trace->stackSize;
+	int variable = -1;
+	size_t depth = 0;
+
+	if (declaredInside)
+	{
+		if (!findStackLocal(code[1], instruction.variable, depth))
+			return false;
+
+		TraceOperand local = stack[depth];
+		push(local);
+	}
+	else
+	{
+		variable = findVariable(false, code[1], instruction.variable);
+		if (variable < 0)
+			return false;
+
+		push({ false, variableTypes[variable], variable, 0 });
+	}
+
+	push(step);
+
+	TraceInstruction add = instruction;
+	add.operands[0] = chunk.constantPool[code[2]].type;
+	add.operands[1] = instruction.variable;
+
+	if (!arithmetic(OPCode::OP_ADD, add, 2))
+		return false;
+
+	if (declaredInside)
+		storeStackLocal(depth);
+	else
+		storeVariable(variable);
+
+	pop();
+
+	return true;
+}
+
+bool yo::TraceCompiler::comparison(OPCode operation, const TraceInstruction& instruction)
+{
+	TraceOperand b = stack[stack.size() - 1];
+	TraceOperand a = stack[stack.size() - 2];
+
+	if (!matches(a, instruction.operands[1]) || !matches(b, instruction.operands[0]))
+		return abort("type mismatch");
+
+	bool booleans = a.type == TraceType::BOOL || b.type == TraceType::BOOL;
+	if (booleans && operation != OPCode::OP_EQUAL)
+		return abort("unsupported operand types");
+
+	if ((a.constant && b.constant) || (booleans && a.type != b.type))
+	{
+		bool result = false;
+
+		if (a.type == b.type || !booleans)
+		{
+			switch (operation)
+			{
+			case OPCode::OP_LESS: result = toValue(a) < toValue(b); break;
+			case OPCode::OP_GREATER: result = toValue(a) > toValue(b); break;
+			case OPCode::OP_EQUAL: result = toValue(a) == toValue(b); break;
+			default: break;
+			}
+		}
+
+		pop();
+		pop();
+		push({ true, TraceType::BOOL, -1, result });
+		return true;
+	}
+
+	pop();
+	pop();
+
+	TraceOperand result = temporary(TraceType::BOOL);
+
+	if (booleans || (a.type == TraceType::INTEGER && b.type == TraceType::INTEGER))
+	{
+		loadInteger(X64Register::RAX, a);
+		loadInteger(X64Register::RCX, b);
+		assembler.cmp(X64Register::RAX, X64Register::RCX);
+
+		switch (operation)
+		{
+		case OPCode::OP_LESS: assembler.setCondition(X64Condition::LESS, X64Register::RAX); break;
+		case OPCode::OP_GREATER: assembler.setCondition(X64Condition::GREATER, X64Register::RAX); break;
+		case OPCode::OP_EQUAL: assembler.setCondition(X64Condition::EQUAL, X64Register::RAX); break;
+		default: break;
+		}
+	}
+	else
+	{
+		loadDouble(X64FloatRegister::XMM0, a);
+		loadDouble(X64FloatRegister::XMM1, b);
+
+		// Unordered comparisons set CF and ZF, so only 'above' and 'equal and ordered' are NaN safe.
+		switch (operation)
+		{
+		case OPCode::OP_LESS:
+			assembler.compareDouble(X64FloatRegister::XMM1, X64FloatRegister::XMM0);
+			assembler.setCondition(X64Condition::ABOVE, X64Register::RAX);
+			break;
+
+		case OPCode::OP_GREATER:
+			assembler.compareDouble(X64FloatRegister::XMM0, X64FloatRegister::XMM1);
+			assembler.setCondition(X64Condition::ABOVE, X64Register::RAX);
+			break;
+
+		case OPCode::OP_EQUAL:
+			assembler.compareDouble(X64FloatRegister::XMM0, X64FloatRegister::XMM1);
+			assembler.setCondition(X64Condition::EQUAL, X64Register::RAX);
+			assembler.setCondition(X64Condition::NOT_PARITY, X64Register::RCX);
+			assembler.andByte(X64Register::RAX, X64Register::RCX);
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	assembler.movzxByte(X64Register::RAX);
+	storeResult(result, X64Register::RAX);
+
+	push(result);
+	return true;
+}
+
+bool yo::TraceCompiler::unary(OPCode operation, const TraceInstruction& instruction)
+{
+	TraceOperand a = stack.back();
+
+	if (!matches(a, instruction.operands[0]))
+		return abort("type mismatch");
+
+	if (operation == OPCode::OP_NEGATE && a.type == TraceType::BOOL)
+		return abort("unsupported operand types");
+
+	if (operation == OPCode::OP_NOT && (a.constant || a.type != TraceType::BOOL))
+	{
+		pop();
+		push({ true, TraceType::BOOL, -1, a.type == TraceType::BOOL && a.bits == 0 });
+		return true;
+	}
+
+	if (a.constant)
+	{
+		TraceOperand folded;
+		if (!fromValue(-toValue(a), folded))
+			return abort("unsupported constant");
+
+		pop();
+		push(folded);
+		return true;
+	}
+
+	std::vector<TraceOperand> before = stack;
+
+	pop();
+
+	TraceOperand result = temporary(a.type);
+	loadInteger(X64Register::RAX, a);
+
+	if (operation == OPCode::OP_NOT)
+	{
+		assembler.movImmediate32(X64Register::RCX, 1);
+		assembler.xorRegister(X64Register::RAX, X64Register::RCX);
+	}
+	else if (a.type == TraceType::INTEGER)
+	{
+		assembler.neg(X64Register::RAX);
+		exitIf(X64Condition::OVERFLOW, instruction.offset, before);
+	}
+	else
+	{
+		assembler.movImmediate64(X64Register::RCX, 0x8000000000000000ULL);
+		assembler.xorRegister(X64Register::RAX, X64Register::RCX);
+	}
+
+	storeResult(result, X64Register::RAX);
+
+	push(result);
+	return true;
+}
+
+bool yo::TraceCompiler::branch(const TraceInstruction& instruction, size_t next)
+{
+	const uint8_t* code = &chunk.data[instruction.offset];
+
+	size_t fallthrough = instruction.offset + 3;
+	size_t target = fallthrough + (uint16_t)((code[1] << 8) | code[2]);
+
+	if (next != fallthrough && next != target)
+		return abort("trace does not follow the branch");
+
+	const TraceOperand& condition = stack.back();
+
+	if (!matches(condition, instruction.operands[0]))
+		return abort("type mismatch");
+
+	if (target == fallthrough)
+		return true;
+
+	bool taken = next == target;
+
+	// Numbers are always truthy and constant conditions are known up front, so neither needs a guard.
+	if (condition.constant || condition.type != TraceType::BOOL)
+	{
+		bool isFalse = condition.type == TraceType::BOOL && condition.bits == 0;
+		return isFalse == taken ? true : abort("branch contradicts its condition");
+	}
+
+	loadInteger(X64Register::RAX, condition);
+	assembler.testRegister(X64Register::RAX);
+
+	if (taken)
+		exitIf(X64Condition::NOT_EQUAL, fallthrough, stack);
+	else
+		exitIf(X64Condition::EQUAL, target, stack);
+
+	return true;
+}
+
+bool yo::TraceCompiler::closeLoop()
+{
+	if (!stack.empty())
+		return abort("unbalanced stack");
+
+	for (size_t i = 0; i < variableTypes.size(); ++i)
+	{
+		if (variableTypes[i] != trace->variables[i].type)
+			return abort("type unstable loop");
+	}
+
+	assembler.load(X64Register::RAX, X64Register::RDI, Trace::ITERATIONS_SLOT * 8);
+	assembler.movImmediate32(X64Register::RCX, 1);
+	assembler.add(X64Register::RAX, X64Register::RCX);
+	assembler.store(X64Register::RDI, Trace::ITERATIONS_SLOT * 8, X64Register::RAX);
+
+	// The VM's fuel budget caps how many iterations a single entry may run.
+	assembler.load(X64Register::RCX, X64Register::RDI, Trace::ITERATION_LIMIT_SLOT * 8);
+	assembler.cmp(X64Register::RAX, X64Register::RCX);
+	exitIf(X64Condition::EQUAL, header, {});
+
+	assembler.patchRelative32(assembler.jump(), 0);
+	return true;
+}
+
+int yo::TraceCompiler::findVariable(bool global, uint8_t index, ValueType observed)
+{
+	TraceType type;
+	if (!toTraceType(observed, type))
+	{
+		abort("unsupported variable type");
+		return -1;
+	}
+
+	for (size_t i = 0; i < trace->variables.size(); ++i)
+	{
+		const TraceVariable& variable = trace->variables[i];
+
+		if (variable.global != global)
+			continue;
+
+		if (global ? !(chunk.constantPool[variable.index] == chunk.constantPool[index]) : variable.index != index)
+			continue;
+
+		if (variableTypes[i] != type)
+		{
+			abort("type mismatch");
+			return -1;
+		}
+
+		return (int)i;
+	}
+
+	if (trace->variables.size() >= Trace::MAX_VARIABLES)
+	{
+		abort("too many variables");
+		return -1;
+	}
+
+	trace->variables.push_back({ global, index, type });
+	variableTypes.push_back(type);
+
+	return (int)trace->variables.size() - 1;
+}
+
+void yo::TraceCompiler::storeVariable(int variable)
+{
+	// Operands still reading the old value get their own copy before it is overwritten.
+	for (size_t depth = 0; depth < stack.size(); ++depth)
+	{
+		if (stack[depth].constant || stack[depth].slot != variable)
+			continue;
+
+		int32_t slot = Trace::TEMPORARY_BASE + (int32_t)depth;
+
+		assembler.load(X64Register::RAX, X64Register::RDI, variable * 8);
+		assembler.store(X64Register::RDI, slot * 8, X64Register::RAX);
+		stack[depth].slot = slot;
+	}
+
+	const TraceOperand& value = stack.back();
+
+	loadInteger(X64Register::RAX, value);
+	assembler.store(X64Register::RDI, variable * 8, X64Register::RAX);
+
+	variableTypes[variable] = value.type;
+}
+
+bool yo::TraceCompiler::findStackLocal(uint8_t index, ValueType observed, size_t& depth)
+{
+	// Locals declared inside the loop body live on the trace's own stack, above what the VM held at the header.
+	depth = index - trace->stackSize;
+
+	if (depth >= stack.size())
+		return abort("local outside the trace");
+
+	if (!matches(stack[depth], observed))
+		return abort("type mismatch");
+
+	return true;
+}
+
+void yo::TraceCompiler::storeStackLocal(size_t depth)
+{
+	int32_t slot = Trace::TEMPORARY_BASE + (int32_t)depth;
+
+	// Only copies taken above the local can still read its slot.
+	for (size_t above = depth + 1; above < stack.size(); ++above)
+	{
+		if (stack[above].constant || stack[above].slot != slot)
+			continue;
+
+		int32_t copy = Trace::TEMPORARY_BASE + (int32_t)above;
+
+		assembler.load(X64Register::RAX, X64Register::RDI, slot * 8);
+		assembler.store(X64Register::RDI, copy * 8, X64Register::RAX);
+		stack[above].slot = copy;
+	}
+
+	TraceOperand value = stack.back();
+
+	if (value.constant)
+	{
+		stack[depth] = value;
+		return;
+	}
+
+	loadInteger(X64Register::RAX, value);
+	assembler.store(X64Register::RDI, slot * 8, X64Register::RAX);
+
+	stack[depth] = { false, value.type, slot, 0 };
+}
+
+bool yo::TraceCompiler::matches(const TraceOperand& operand, ValueType observed) const
+{
+	TraceType type;
+	return toTraceType(observed, type) && type == operand.type;
+}
+
+yo::TraceOperand yo::TraceCompiler::pop()
+{
+	TraceOperand operand = stack.back();
+	stack.pop_back();
+	return operand;
+}
+
+yo::TraceOperand yo::TraceCompiler::temporary(TraceType type) const
+{
+	return { false, type, Trace::TEMPORARY_BASE + (int32_t)stack.size(), 0 };
+}
+
+void yo::TraceCompiler::push(const TraceOperand& operand)
+{
+	stack.push_back(operand);
+	maxDepth = std::max(maxDepth, stack.size());
+}
+
+void yo::TraceCompiler::loadInteger(X64Register destination, const TraceOperand& operand)
+{
+	if (operand.constant)
+		assembler.movImmediate64(destination, (uint64_t)operand.bits);
+	else
+		assembler.load(destination, X64Register::RDI, operand.slot * 8);
+}
+
+void yo::TraceCompiler::loadDouble(X64FloatRegister destination, const TraceOperand& operand)
+{
+	if (operand.constant)
+	{
+		double number = operand.type == TraceType::NUMERIC ? toDouble(toValue(operand)) : (double)operand.bits;
+		uint64_t bits;
+		std::memcpy(&bits, &number, sizeof(bits));
+
+		assembler.movImmediate64(X64Register::RAX, bits);
+		assembler.moveToDouble(destination, X64Register::RAX);
+	}
+	else if (operand.type == TraceType::NUMERIC)
+		assembler.loadDouble(destination, X64Register::RDI, operand.slot * 8);
+	else
+	{
+		assembler.load(X64Register::RAX, X64Register::RDI, operand.slot * 8);
+		assembler.convertToDouble(destination, X64Register::RAX);
+	}
+}
+
+void yo::TraceCompiler::storeResult(const TraceOperand& result, X64Register source)
+{
+	assembler.store(X64Register::RDI, result.slot * 8, source);
+}
+
+void yo::TraceCompiler::exitIf(X64Condition condition, size_t resumeOffset, const std::vector<TraceOperand>& stack)
+{
+	uint32_t index = (uint32_t)trace->exits.size();
+	trace->exits.push_back({ resumeOffset, variableTypes, stack });
+
+	exitJumps.push_back({ assembler.jumpIf(condition), index });
+}
+
+size_t yo::TraceCompiler::operandCount(OPCode operation)
+{
+	switch (operation)
+	{
+		case OPCode::OP_ADD:
+		case OPCode::OP_SUB:
+		case OPCode::OP_MULT:
+		case OPCode::OP_DIV:
+		case OPCode::OP_MOD:
+		case OPCode::OP_LESS:
+		case OPCode::OP_GREATER:
+		case OPCode::OP_EQUAL:
+			return 2;
+
+		case OPCode::OP_SET_LOCAL_VAR:
+		case OPCode::OP_SET_GLOBAL_VAR:
+		case OPCode::OP_POP_BACK:
+		case OPCode::OP_NEGATE:
+		case OPCode::OP_NOT:
+		case OPCode::OP_JUMP_IF_FALSE:
+			return 1;
+
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+bool yo::TraceCompiler::toTraceType(ValueType type, TraceType& traceType)
+{
+	switch (type)
+	{
+	case ValueType::VT_INTEGER: traceType = TraceType::INTEGER; return true;
+	case ValueType::VT_NUMERIC: traceType = TraceType::NUMERIC; return true;
+	case ValueType::VT_BOOL: traceType = TraceType::BOOL; return true;
+	default: break;
+	}
+
+	return false;
+}
+
+yo::Value yo::TraceCompiler::toValue(const TraceOperand& operand)
+{
+	return boxTraceValue(operand.bits, operand.type);
+}
+
+bool yo::TraceCompiler::fromValue(const Value& value, TraceOperand& operand)
+{
+	operand = { true, TraceType::INTEGER, -1, 0 };
+
+	switch (value.type)
+	{
+	case ValueType::VT_INTEGER:
+		operand.bits = std::get<int64_t>(value.variantValue);
+		return true;
+
+	case ValueType::VT_NUMERIC:
+		operand.type = TraceType::NUMERIC;
+		std::memcpy(&operand.bits, &std::get<double>(value.variantValue), sizeof(operand.bits));
+		return true;
+
+	case ValueType::VT_BOOL:
+		operand.type = TraceType::BOOL;
+		operand.bits = std::get<bool>(value.variantValue);
+		return true;
+
+	default:
+		break;
+	}
+
+	return false;
+}
\ No newline at end of file
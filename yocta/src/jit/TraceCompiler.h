@@ -0,0 +1,85 @@
+#pragma once
+#include <memory>
+
+#include "X64Assembler.h"
+#include "Trace.h"
+#include "Chunk.h"
+
+namespace yo
+{
+	class TraceCompiler
+	{
+	public:
+		TraceCompiler(const Chunk& chunk, size_t header, size_t stackSize);
+
+	public:
+		std::unique_ptr<Trace> compile(const std::vector<TraceInstruction>& instructions);
+
+		const char* abortReason() const { return reason; }
+
+	private:
+		bool compileInstruction(const TraceInstruction& instruction, size_t next, bool last);
+
+		bool arithmetic(OPCode operation, const TraceInstruction& instruction, size_t fusedOperands = 0);
+
+		bool incrementLocal(const TraceInstruction& instruction);
+
+		bool comparison(OPCode operation, const TraceInstruction& instruction);
+
+		bool unary(OPCode operation, const TraceInstruction& instruction);
+
+		bool branch(const TraceInstruction& instruction, size_t next);
+
+		bool closeLoop();
+
+	private:
+		int findVariable(bool global, uint8_t index, ValueType observed);
+
+		void storeVariable(int variable);
+
+		bool findStackLocal(uint8_t index, ValueType observed, size_t& depth);
+
+		void storeStackLocal(size_t depth);
+
+		bool matches(const TraceOperand& operand, ValueType observed) const;
+
+		TraceOperand pop();
+
+		TraceOperand temporary(TraceType type) const;
+
+		void push(const TraceOperand& operand);
+
+		void loadInteger(X64Register destination, const TraceOperand& operand);
+
+		void loadDouble(X64FloatRegister destination, const TraceOperand& operand);
+
+		void storeResult(const TraceOperand& result, X64Register source);
+
+		void exitIf(X64Condition condition, size_t resumeOffset, const std::vector<TraceOperand>& stack);
+
+		bool abort(const char* why) { reason = why; return false; }
+
+	private:
+		static size_t operandCount(OPCode operation);
+
+		static bool toTraceType(ValueType type, TraceType& traceType);
+
+		static Value toValue(const TraceOperand& operand);
+
+		static bool fromValue(const Value& value, TraceOperand& operand);
+
+	private:
+		const Chunk& chunk;
+		size_t header;
+
+		std::unique_ptr<Trace> trace;
+		X64Assembler assembler;
+
+		std::vector<TraceType> variableTypes;
+		std::vector<TraceOperand> stack;
+		std::vector<std::pair<size_t, uint32_t>> exitJumps;
+
+		size_t maxDepth = 0;
+		const char* reason = nullptr;
+	};
+}
\ No newline at end of file
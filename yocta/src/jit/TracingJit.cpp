@@ -0,0 +1,233 @@
+#include "TracingJit.h"
+#include "TraceCompiler.h"
+#include "VirtualMachine.h"
+
+#include <algorithm>
+#include <chrono>
+
+yo::TracingJit::TracingJit(VirtualMachine& vm, const Chunk& chunk, TraceStatistics& statistics)
+	: vm(vm), chunk(chunk), statistics(statistics),
+	counters(chunk.data.size(), 0), aborts(chunk.data.size(), 0), loopEnds(chunk.data.size(), 0), traces(chunk.data.size())
+{
+	// A loop ends with the last instruction that jumps back to its header.
+	for (size_t offset = 0; offset < chunk.data.size(); offset += instructionLength(chunk.data[offset]))
+	{
+		if (chunk.data[offset] == (uint8_t)OPCode::OP_LOOP)
+			loopEnds[offset + 3 - ((chunk.data[offset + 1] << 8) | chunk.data[offset + 2])] = offset;
+	}
+
+	// The condition of a for loop is jumped back to from the increment, which the body after it jumps back to in
+	// turn, so a loop also ends where the loops headed inside it do.
+	for (size_t header = loopEnds.size(); header-- > 0;)
+	{
+		for (size_t inner = header + 1; inner <= loopEnds[header]; ++inner)
+			loopEnds[header] = std::max(loopEnds[header], loopEnds[inner]);
+	}
+}
+
+void yo::TracingJit::record(size_t offset)
+{
+	if (instructions.size() >= MAX_TRACE_LENGTH)
+		return stopRecording("trace too long");
+
+	const ValueStack& stack = vm.vmStack;
+
+	// Everything of the loop lies between its header and the instruction that closes it; outside that the loop has
+	// been left, and from there the trace could reach the header again only through the code around the loop.
+	if (offset < recordHeader || offset > recordEnd)
+		return stopRecording("trace left the loop");
+
+	// Below the stack the header started with, the trace has left the scope the loop runs in.
+	if (stack.size() < recordStackSize)
+		return stopRecording("trace left the loop's scope");
+
+	TraceInstruction instruction = { offset, { ValueType::VT_NONE, ValueType::VT_NONE }, ValueType::VT_NONE };
+
+	if (stack.size() > 0)
+		instruction.operands[0] = stack[stack.size() - 1].type;
+
+	if (stack.size() > 1)
+		instruction.operands[1] = stack[stack.size() - 2].type;
+
+	switch (genericOperation((OPCode)chunk.data[offset]))
+	{
+		case OPCode::OP_GET_LOCAL_VAR:
+		case OPCode::OP_SET_LOCAL_VAR:
+		case OPCode::OP_INCREMENT_LOCAL:
+			instruction.variable = stack[chunk.data[offset + 1]].type;
+			break;
+
+		case OPCode::OP_GET_GLOBAL_VAR:
+		case OPCode::OP_SET_GLOBAL_VAR:
+		{
+			const Value* value = vm.findGlobal(chunk.constantPool[chunk.data[offset + 1]]);
+			instruction.variable = value ? value->type : ValueType::VT_NONE;
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	instructions.push_back(instruction);
+}
+
+void yo::TracingJit::backEdge(size_t header)
+{
+	if (isRecording)
+	{
+		// A for loop reaches its condition through a second back-edge, so only a repeated header is a real inner loop.
+		if (header != recordHeader)
+		{
+			if (std::find(jumpedHeaders.begin(), jumpedHeaders.end(), header) == jumpedHeaders.end())
+				return jumpedHeaders.push_back(header);
+
+			stopRecording("inner loop");
+		}
+		else
+			finishRecording();
+	}
+
+	if (Trace* trace = traces[header].get())
+		return run(*trace);
+
+	if (aborts[header] < MAX_ABORTS && ++counters[header] >= HOT_LOOP_THRESHOLD)
+		startRecording(header);
+}
+
+void yo::TracingJit::startRecording(size_t header)
+{
+	#ifdef DEBUG_TRACE_JIT
+	printf("[trace] recording loop at %zu\n", header);
+	#endif
+
+	isRecording = true;
+	recordHeader = header;
+	recordEnd = loopEnds[header];
+	recordStackSize = vm.vmStack.size();
+	instructions.clear();
+	jumpedHeaders.clear();
+}
+
+void yo::TracingJit::stopRecording([[maybe_unused]] const char* reason)
+{
+	#ifdef DEBUG_TRACE_JIT
+	printf("[trace] aborted loop at %zu: %s\n", recordHeader, reason);
+	#endif
+
+	isRecording = false;
+	instructions.clear();
+
+	++statistics.aborted;
+	++aborts[recordHeader];
+	counters[recordHeader] = 0;
+}
+
+void yo::TracingJit::finishRecording()
+{
+	TraceCompiler compiler(chunk, recordHeader, recordStackSize);
+	std::unique_ptr<Trace> trace = compiler.compile(instructions);
+
+	if (!trace)
+		return stopRecording(compiler.abortReason());
+
+	#ifdef DEBUG_TRACE_JIT
+	printf("[trace] compiled loop at %zu: %zu ops, %zu variables, %zu exits, %zu bytes\n",
+		recordHeader, instructions.size(), trace->variables.size(), trace->exits.size(), trace->memory.size());
+	#endif
+
+	isRecording = false;
+	instructions.clear();
+
+	++statistics.recorded;
+	traces[recordHeader] = std::move(trace);
+}
+
+void yo::TracingJit::run(Trace& trace)
+{
+	if (vm.vmStack.size() != trace.stackSize)
+		return;
+
+	frame.resize(trace.frameSize);
+	slots.resize(trace.variables.size());
+
+	// Every variable's type guard is hoisted to trace entry, so the native loop body runs unguarded on them.
+	for (size_t i = 0; i < trace.variables.size(); ++i)
+	{
+		const TraceVariable& variable = trace.variables[i];
+		Value* value = variable.global ? vm.findGlobal(chunk.constantPool[variable.index]) : &vm.vmStack[variable.index];
+
+		if (!value || !unbox(*value, variable.type, frame[i]))
+			return discard(trace.header, "entry guard failed");
+
+		slots[i] = value;
+	}
+
+	++statistics.entered;
+	frame[Trace::ITERATIONS_SLOT] = 0;
+	frame[Trace::ITERATION_LIMIT_SLOT] = std::max<int64_t>(vm.fuel / (int64_t)trace.fuelPerIteration, 1);
+
+	auto start = std::chrono::steady_clock::now();
+	uint32_t exit = trace.function()(frame.data());
+	statistics.nativeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const TraceExit& snapshot = trace.exits[exit];
+
+	for (size_t i = 0; i < trace.variables.size(); ++i)
+	{
+		TraceType type = i < snapshot.variableTypes.size() ? snapshot.variableTypes[i] : trace.variables[i].type;
+		*slots[i] = boxTraceValue(frame[i], type);
+	}
+
+	for (const TraceOperand& operand : snapshot.stack)
+		vm.vmStack.push_back(boxTraceValue(operand.constant ? operand.bits : frame[operand.slot], operand.type));
+
+	vm.IP = chunk.data.data() + snapshot.resumeOffset;
+	vm.fuel -= frame[Trace::ITERATIONS_SLOT] * (int64_t)trace.fuelPerIteration;
+
+	// A trace that keeps leaving before its first back-edge was recorded down a path the loop no longer takes.
+	if (frame[Trace::ITERATIONS_SLOT] != 0)
+		trace.shortRuns = 0;
+	else if (++trace.shortRuns >= MAX_SHORT_RUNS)
+		discard(trace.header, "side exit taken on every entry");
+}
+
+void yo::TracingJit::discard(size_t header, [[maybe_unused]] const char* reason)
+{
+	#ifdef DEBUG_TRACE_JIT
+	printf("[trace] discarded loop at %zu: %s\n", header, reason);
+	#endif
+
+	traces[header].reset();
+	counters[header] = 0;
+	++aborts[header];
+}
+
+bool yo::TracingJit::unbox(const Value& value, TraceType type, int64_t& bits)
+{
+	switch (type)
+	{
+	case TraceType::INTEGER:
+		if (value.type != ValueType::VT_INTEGER)
+			return false;
+
+		bits = std::get<int64_t>(value.variantValue);
+		return true;
+
+	case TraceType::NUMERIC:
+		if (value.type != ValueType::VT_NUMERIC)
+			return false;
+
+		std::memcpy(&bits, &std::get<double>(value.variantValue), sizeof(bits));
+		return true;
+
+	case TraceType::BOOL:
+		if (value.type != ValueType::VT_BOOL)
+			return false;
+
+		bits = std::get<bool>(value.variantValue);
+		return true;
+	}
+
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "Trace.h"
+#include "Chunk.h"
+
+namespace yo
+{
+	class VirtualMachine;
+
+	struct TraceStatistics
+	{
+	public:
+		size_t recorded = 0;
+		size_t aborted = 0;
+		size_t entered = 0;
+		double nativeSeconds = 0.0;
+	};
+
+	class TracingJit
+	{
+	public:
+		static constexpr uint16_t HOT_LOOP_THRESHOLD = 50;
+		static constexpr size_t MAX_TRACE_LENGTH = 1024;
+		static constexpr uint8_t MAX_ABORTS = 4;
+		static constexpr uint32_t MAX_SHORT_RUNS = 16;
+
+	public:
+		TracingJit(VirtualMachine& vm, const Chunk& chunk, TraceStatistics& statistics);
+
+	public:
+		bool recording() const { return isRecording; }
+
+		void record(size_t offset);
+
+		void backEdge(size_t header);
+
+	private:
+		void startRecording(size_t header);
+
+		void stopRecording(const char* reason);
+
+		void finishRecording();
+
+		void run(Trace& trace);
+
+		void discard(size_t header, const char* reason);
+
+	private:
+		static bool unbox(const Value& value, TraceType type, int64_t& bits);
+
+	private:
+		VirtualMachine& vm;
+		const Chunk& chunk;
+		TraceStatistics& statistics;
+
+		std::vector<uint16_t> counters;
+		std::vector<uint8_t> aborts;
+		std::vector<size_t> loopEnds;
+		std::vector<std::unique_ptr<Trace>> traces;
+
+	private:
+		bool isRecording = false;
+		size_t recordHeader = 0;
+		size_t recordEnd = 0;
+		size_t recordStackSize = 0;
+		std::vector<TraceInstruction> instructions;
+		std::vector<size_t> jumpedHeaders;
+
+	private:
+		std::vector<int64_t> frame;
+		std::vector<Value*> slots;
+	};
+}
\ No newline at end of file
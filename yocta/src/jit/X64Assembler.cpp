@@ -0,0 +1,335 @@
+#include "X64Assembler.h"
+
+void yo::X64Assembler::push(X64Register reg)
+{
+	emit(0x50 + (uint8_t)reg);
+}
+
+void yo::X64Assembler::pop(X64Register reg)
+{
+	emit(0x58 + (uint8_t)reg);
+}
+
+void yo::X64Assembler::ret()
+{
+	emit(0xC3);
+}
+
+void yo::X64Assembler::movRegister(X64Register destination, X64Register source)
+{
+	emit(0x48);
+	emit(0x89);
+	emit(0xC0 | ((uint8_t)source << 3) | (uint8_t)destination);
+}
+
+void yo::X64Assembler::movImmediate32(X64Register destination, uint32_t immediate)
+{
+	emit(0xB8 + (uint8_t)destination);
+	emit32(immediate);
+}
+
+void yo::X64Assembler::movImmediate64(X64Register destination, uint64_t immediate)
+{
+	emit(0x48);
+	emit(0xB8 + (uint8_t)destination);
+	emit64(immediate);
+}
+
+void yo::X64Assembler::callRegister(X64Register reg)
+{
+	emit(0xFF);
+	emit(0xD0 | (uint8_t)reg);
+}
+
+void yo::X64Assembler::jumpRegister(X64Register reg)
+{
+	emit(0xFF);
+	emit(0xE0 | (uint8_t)reg);
+}
+
+void yo::X64Assembler::testEax()
+{
+	emit(0x85);
+	emit(0xC0);
+}
+
+void yo::X64Assembler::testAl()
+{
+	emit(0x84);
+	emit(0xC0);
+}
+
+void yo::X64Assembler::load(X64Register destination, X64Register base, int32_t displacement)
+{
+	emit(0x48);
+	emit(0x8B);
+	emitModRM(2, (uint8_t)destination, (uint8_t)base);
+	emit32((uint32_t)displacement);
+}
+
+void yo::X64Assembler::store(X64Register base, int32_t displacement, X64Register source)
+{
+	emit(0x48);
+	emit(0x89);
+	emitModRM(2, (uint8_t)source, (uint8_t)base);
+	emit32((uint32_t)displacement);
+}
+
+void yo::X64Assembler::load32(X64Register destination, X64Register base, int32_t displacement)
+{
+	emit(0x8B);
+	emitModRM(2, (uint8_t)destination, (uint8_t)base);
+	emit32((uint32_t)displacement);
+}
+
+void yo::X64Assembler::lea(X64Register destination, X64Register base, int32_t displacement)
+{
+	emit(0x48);
+	emit(0x8D);
+	emitModRM(2, (uint8_t)destination, (uint8_t)base);
+	emit32((uint32_t)displacement);
+}
+
+void yo::X64Assembler::cmpMemory32(X64Register base, int32_t displacement, int8_t immediate)
+{
+	emit(0x83);
+	emitModRM(2, 7, (uint8_t)base);
+	emit32((uint32_t)displacement);
+	emit((uint8_t)immediate);
+}
+
+void yo::X64Assembler::cmpMemory8(X64Register base, int32_t displacement, int8_t immediate)
+{
+	emit(0x80);
+	emitModRM(2, 7, (uint8_t)base);
+	emit32((uint32_t)displacement);
+	emit((uint8_t)immediate);
+}
+
+void yo::X64Assembler::addMemory(X64Register base, int32_t displacement, int32_t immediate)
+{
+	emit(0x48);
+	emit(0x81);
+	emitModRM(2, 0, (uint8_t)base);
+	emit32((uint32_t)displacement);
+	emit32((uint32_t)immediate);
+}
+
+void yo::X64Assembler::subMemory(X64Register base, int32_t displacement, int32_t immediate)
+{
+	emit(0x48);
+	emit(0x81);
+	emitModRM(2, 5, (uint8_t)base);
+	emit32((uint32_t)displacement);
+	emit32((uint32_t)immediate);
+}
+
+void yo::X64Assembler::add(X64Register destination, X64Register source)
+{
+	emitRegisters(0x01, destination, source);
+}
+
+void yo::X64Assembler::sub(X64Register destination, X64Register source)
+{
+	emitRegisters(0x29, destination, source);
+}
+
+void yo::X64Assembler::imul(X64Register destination, X64Register source)
+{
+	emit(0x48);
+	emit(0x0F);
+	emit(0xAF);
+	emitModRM(3, (uint8_t)destination, (uint8_t)source);
+}
+
+void yo::X64Assembler::xorRegister(X64Register destination, X64Register source)
+{
+	emitRegisters(0x31, destination, source);
+}
+
+void yo::X64Assembler::cmp(X64Register destination, X64Register source)
+{
+	emitRegisters(0x39, destination, source);
+}
+
+void yo::X64Assembler::cmpImmediate8(X64Register destination, int8_t immediate)
+{
+	emit(0x48);
+	emit(0x83);
+	emitModRM(3, 7, (uint8_t)destination);
+	emit((uint8_t)immediate);
+}
+
+void yo::X64Assembler::testRegister(X64Register reg)
+{
+	emitRegisters(0x85, reg, reg);
+}
+
+void yo::X64Assembler::neg(X64Register reg)
+{
+	emit(0x48);
+	emit(0xF7);
+	emitModRM(3, 3, (uint8_t)reg);
+}
+
+void yo::X64Assembler::cqo()
+{
+	emit(0x48);
+	emit(0x99);
+}
+
+void yo::X64Assembler::idiv(X64Register divisor)
+{
+	emit(0x48);
+	emit(0xF7);
+	emitModRM(3, 7, (uint8_t)divisor);
+}
+
+void yo::X64Assembler::setCondition(X64Condition condition, X64Register destination)
+{
+	emit(0x0F);
+	emit(0x90 | (uint8_t)condition);
+	emitModRM(3, 0, (uint8_t)destination);
+}
+
+void yo::X64Assembler::andByte(X64Register destination, X64Register source)
+{
+	emit(0x20);
+	emitModRM(3, (uint8_t)source, (uint8_t)destination);
+}
+
+void yo::X64Assembler::movzxByte(X64Register reg)
+{
+	emit(0x0F);
+	emit(0xB6);
+	emitModRM(3, (uint8_t)reg, (uint8_t)reg);
+}
+
+void yo::X64Assembler::loadDouble(X64FloatRegister destination, X64Register base, int32_t displacement)
+{
+	emit(0xF2);
+	emit(0x0F);
+	emit(0x10);
+	emitModRM(2, (uint8_t)destination, (uint8_t)base);
+	emit32((uint32_t)displacement);
+}
+
+void yo::X64Assembler::storeDouble(X64Register base, int32_t displacement, X64FloatRegister source)
+{
+	emit(0xF2);
+	emit(0x0F);
+	emit(0x11);
+	emitModRM(2, (uint8_t)source, (uint8_t)base);
+	emit32((uint32_t)displacement);
+}
+
+void yo::X64Assembler::addDouble(X64FloatRegister destination, X64FloatRegister source)
+{
+	emitDouble(0xF2, 0x58, destination, source);
+}
+
+void yo::X64Assembler::subDouble(X64FloatRegister destination, X64FloatRegister source)
+{
+	emitDouble(0xF2, 0x5C, destination, source);
+}
+
+void yo::X64Assembler::multDouble(X64FloatRegister destination, X64FloatRegister source)
+{
+	emitDouble(0xF2, 0x59, destination, source);
+}
+
+void yo::X64Assembler::divDouble(X64FloatRegister destination, X64FloatRegister source)
+{
+	emitDouble(0xF2, 0x5E, destination, source);
+}
+
+void yo::X64Assembler::compareDouble(X64FloatRegister left, X64FloatRegister right)
+{
+	emitDouble(0x66, 0x2E, left, right);
+}
+
+void yo::X64Assembler::convertToDouble(X64FloatRegister destination, X64Register source)
+{
+	emit(0xF2);
+	emit(0x48);
+	emit(0x0F);
+	emit(0x2A);
+	emitModRM(3, (uint8_t)destination, (uint8_t)source);
+}
+
+void yo::X64Assembler::moveToDouble(X64FloatRegister destination, X64Register source)
+{
+	emit(0x66);
+	emit(0x48);
+	emit(0x0F);
+	emit(0x6E);
+	emitModRM(3, (uint8_t)destination, (uint8_t)source);
+}
+
+size_t yo::X64Assembler::jump()
+{
+	emit(0xE9);
+	emit32(0);
+	return position() - 4;
+}
+
+size_t yo::X64Assembler::jumpIf(X64Condition condition)
+{
+	emit(0x0F);
+	emit(0x80 | (uint8_t)condition);
+	emit32(0);
+	return position() - 4;
+}
+
+size_t yo::X64Assembler::jumpShortIf(X64Condition condition)
+{
+	emit(0x70 | (uint8_t)condition);
+	emit(0);
+	return position() - 1;
+}
+
+void yo::X64Assembler::patchRelative32(size_t fixup, size_t target)
+{
+	int32_t relative = (int32_t)((int64_t)target - (int64_t)(fixup + 4));
+
+	for (int i = 0; i < 4; ++i)
+		code[fixup + i] = (uint8_t)(relative >> (i * 8));
+}
+
+void yo::X64Assembler::patchRelative8(size_t fixup, size_t target)
+{
+	code[fixup] = (uint8_t)(int8_t)((int64_t)target - (int64_t)(fixup + 1));
+}
+
+void yo::X64Assembler::callAbsolute(const void* function)
+{
+	movImmediate64(X64Register::RAX, (uint64_t)(uintptr_t)function);
+	callRegister(X64Register::RAX);
+}
+
+void yo::X64Assembler::emit32(uint32_t value)
+{
+	for (int i = 0; i < 4; ++i)
+		emit((uint8_t)(value >> (i * 8)));
+}
+
+void yo::X64Assembler::emit64(uint64_t value)
+{
+	for (int i = 0; i < 8; ++i)
+		emit((uint8_t)(value >> (i * 8)));
+}
+
+void yo::X64Assembler::emitRegisters(uint8_t opcode, X64Register destination, X64Register source)
+{
+	emit(0x48);
+	emit(opcode);
+	emitModRM(3, (uint8_t)source, (uint8_t)destination);
+}
+
+void yo::X64Assembler::emitDouble(uint8_t prefix, uint8_t opcode, X64FloatRegister destination, X64FloatRegister source)
+{
+	emit(prefix);
+	emit(0x0F);
+	emit(opcode);
+	emitModRM(3, (uint8_t)destination, (uint8_t)source);
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace yo
+{
+	enum class X64Register : uint8_t
+	{
+		RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI
+	};
+
+	enum class X64FloatRegister : uint8_t
+	{
+		XMM0 = 0, XMM1
+	};
+
+	enum class X64Condition : uint8_t
+	{
+		OVERFLOW = 0x0,
+		EQUAL = 0x4,
+		NOT_EQUAL = 0x5,
+		BELOW_OR_EQUAL = 0x6,
+		ABOVE = 0x7,
+		NOT_PARITY = 0xB,
+		LESS = 0xC,
+		GREATER_OR_EQUAL = 0xD,
+		LESS_OR_EQUAL = 0xE,
+		GREATER = 0xF
+	};
+
+	class X64Assembler
+	{
+	public:
+		void push(X64Register reg);
+
+		void pop(X64Register reg);
+
+		void ret();
+
+		void movRegister(X64Register destination, X64Register source);
+
+		void movImmediate32(X64Register destination, uint32_t immediate);
+
+		void movImmediate64(X64Register destination, uint64_t immediate);
+
+		void callRegister(X64Register reg);
+
+		void jumpRegister(X64Register reg);
+
+		void testEax();
+
+		void testAl();
+
+	public:
+		void load(X64Register destination, X64Register base, int32_t displacement);
+
+		void store(X64Register base, int32_t displacement, X64Register source);
+
+		// Loads 32 bits and clears the upper half of the destination.
+		void load32(X64Register destination, X64Register base, int32_t displacement);
+
+		void lea(X64Register destination, X64Register base, int32_t displacement);
+
+		// Compares the 32 or 8 bits at base + displacement with a sign-extended immediate.
+		void cmpMemory32(X64Register base, int32_t displacement, int8_t immediate);
+
+		void cmpMemory8(X64Register base, int32_t displacement, int8_t immediate);
+
+		void addMemory(X64Register base, int32_t displacement, int32_t immediate);
+
+		void subMemory(X64Register base, int32_t displacement, int32_t immediate);
+
+		void add(X64Register destination, X64Register source);
+
+		void sub(X64Register destination, X64Register source);
+
+		void imul(X64Register destination, X64Register source);
+
+		void xorRegister(X64Register destination, X64Register source);
+
+		void cmp(X64Register destination, X64Register source);
+
+		void cmpImmediate8(X64Register destination, int8_t immediate);
+
+		void testRegister(X64Register reg);
+
+		void neg(X64Register reg);
+
+		void cqo();
+
+		void idiv(X64Register divisor);
+
+		void setCondition(X64Condition condition, X64Register destination);
+
+		void andByte(X64Register destination, X64Register source);
+
+		void movzxByte(X64Register reg);
+
+	public:
+		void loadDouble(X64FloatRegister destination, X64Register base, int32_t displacement);
+
+		void storeDouble(X64Register base, int32_t displacement, X64FloatRegister source);
+
+		void addDouble(X64FloatRegister destination, X64FloatRegister source);
+
+		void subDouble(X64FloatRegister destination, X64FloatRegister source);
+
+		void multDouble(X64FloatRegister destination, X64FloatRegister source);
+
+		void divDouble(X64FloatRegister destination, X64FloatRegister source);
+
+		void compareDouble(X64FloatRegister left, X64FloatRegister right);
+
+		void convertToDouble(X64FloatRegister destination, X64Register source);
+
+		void moveToDouble(X64FloatRegister destination, X64Register source);
+
+	public:
+		size_t jump();
+
+		size_t jumpIf(X64Condition condition);
+
+		size_t jumpShortIf(X64Condition condition);
+
+		void patchRelative32(size_t fixup, size_t target);
+
+		void patchRelative8(size_t fixup, size_t target);
+
+	public:
+		void callAbsolute(const void* function);
+
+	public:
+		size_t position() const { return code.size(); }
+
+	public:
+		std::vector<uint8_t> code;
+
+	private:
+		void emit(uint8_t byte) { code.push_back(byte); }
+
+		void emitModRM(uint8_t mode, uint8_t reg, uint8_t rm) { emit((uint8_t)((mode << 6) | ((reg & 7) << 3) | (rm & 7))); }
+
+		void emitRegisters(uint8_t opcode, X64Register destination, X64Register source);
+
+		void emitDouble(uint8_t prefix, uint8_t opcode, X64FloatRegister destination, X64FloatRegister source);
+
+		void emit32(uint32_t value);
+
+		void emit64(uint64_t value);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,544 @@
+#include "NumericKernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define YOCTA_KERNELS_X86
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define YOCTA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define YOCTA_TARGET_AVX2
+#endif
+
+namespace
+{
+	using namespace yo;
+
+	// Scalar fallbacks. These also finish the tails of the vector loops.
+
+	double scalarSum(const double* x, size_t n)
+	{
+		double sum = 0.0;
+		for (size_t i = 0; i < n; ++i)
+			sum += x[i];
+
+		return sum;
+	}
+
+	double scalarMin(const double* x, size_t n)
+	{
+		double result = n ? x[0] : NAN;
+		for (size_t i = 1; i < n; ++i)
+			result = std::min(result, x[i]);
+
+		return result;
+	}
+
+	double scalarMax(const double* x, size_t n)
+	{
+		double result = n ? x[0] : NAN;
+		for (size_t i = 1; i < n; ++i)
+			result = std::max(result, x[i]);
+
+		return result;
+	}
+
+	double scalarDot(const double* x, const double* y, size_t n)
+	{
+		double sum = 0.0;
+		for (size_t i = 0; i < n; ++i)
+			sum += x[i] * y[i];
+
+		return sum;
+	}
+
+	void scalarAxpy(double a, const double* x, double* y, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			y[i] += a * x[i];
+	}
+
+	void scalarScale(double a, const double* x, double* out, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			out[i] = a * x[i];
+	}
+
+	void scalarAdd(const double* x, const double* y, double* out, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			out[i] = x[i] + y[i];
+	}
+
+	void scalarSub(const double* x, const double* y, double* out, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			out[i] = x[i] - y[i];
+	}
+
+	void scalarMult(const double* x, const double* y, double* out, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			out[i] = x[i] * y[i];
+	}
+
+	void scalarDiv(const double* x, const double* y, double* out, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			out[i] = x[i] / y[i];
+	}
+
+	void scalarLess(const double* x, const double* y, double* out, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			out[i] = x[i] < y[i] ? 1.0 : 0.0;
+	}
+
+	void scalarGreater(const double* x, const double* y, double* out, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			out[i] = x[i] > y[i] ? 1.0 : 0.0;
+	}
+
+	void scalarEqual(const double* x, const double* y, double* out, size_t n)
+	{
+		for (size_t i = 0; i < n; ++i)
+			out[i] = x[i] == y[i] ? 1.0 : 0.0;
+	}
+
+	#ifdef YOCTA_KERNELS_X86
+
+	// SSE2 is part of the x86-64 baseline, so these need no dispatch guard.
+
+	double sse2Sum(const double* x, size_t n)
+	{
+		__m128d a = _mm_setzero_pd(), b = _mm_setzero_pd();
+
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+		{
+			a = _mm_add_pd(a, _mm_loadu_pd(x + i));
+			b = _mm_add_pd(b, _mm_loadu_pd(x + i + 2));
+		}
+
+		double lanes[2];
+		_mm_storeu_pd(lanes, _mm_add_pd(a, b));
+
+		return lanes[0] + lanes[1] + scalarSum(x + i, n - i);
+	}
+
+	double sse2Min(const double* x, size_t n)
+	{
+		if (n < 2)
+			return scalarMin(x, n);
+
+		__m128d result = _mm_loadu_pd(x);
+
+		size_t i = 2;
+		for (; i + 2 <= n; i += 2)
+			result = _mm_min_pd(result, _mm_loadu_pd(x + i));
+
+		double lanes[2];
+		_mm_storeu_pd(lanes, result);
+
+		double tail = i < n ? x[i] : lanes[0];
+		return std::min(std::min(lanes[0], lanes[1]), tail);
+	}
+
+	double sse2Max(const double* x, size_t n)
+	{
+		if (n < 2)
+			return scalarMax(x, n);
+
+		__m128d result = _mm_loadu_pd(x);
+
+		size_t i = 2;
+		for (; i + 2 <= n; i += 2)
+			result = _mm_max_pd(result, _mm_loadu_pd(x + i));
+
+		double lanes[2];
+		_mm_storeu_pd(lanes, result);
+
+		double tail = i < n ? x[i] : lanes[0];
+		return std::max(std::max(lanes[0], lanes[1]), tail);
+	}
+
+	double sse2Dot(const double* x, const double* y, size_t n)
+	{
+		__m128d a = _mm_setzero_pd(), b = _mm_setzero_pd();
+
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+		{
+			a = _mm_add_pd(a, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+			b = _mm_add_pd(b, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2)));
+		}
+
+		double lanes[2];
+		_mm_storeu_pd(lanes, _mm_add_pd(a, b));
+
+		return lanes[0] + lanes[1] + scalarDot(x + i, y + i, n - i);
+	}
+
+	void sse2Axpy(double a, const double* x, double* y, size_t n)
+	{
+		__m128d factor = _mm_set1_pd(a);
+
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(factor, _mm_loadu_pd(x + i))));
+
+		scalarAxpy(a, x + i, y + i, n - i);
+	}
+
+	void sse2Scale(double a, const double* x, double* out, size_t n)
+	{
+		__m128d factor = _mm_set1_pd(a);
+
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(out + i, _mm_mul_pd(factor, _mm_loadu_pd(x + i)));
+
+		scalarScale(a, x + i, out + i, n - i);
+	}
+
+	void sse2Add(const double* x, const double* y, double* out, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+
+		scalarAdd(x + i, y + i, out + i, n - i);
+	}
+
+	void sse2Sub(const double* x, const double* y, double* out, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(out + i, _mm_sub_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+
+		scalarSub(x + i, y + i, out + i, n - i);
+	}
+
+	void sse2Mult(const double* x, const double* y, double* out, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+
+		scalarMult(x + i, y + i, out + i, n - i);
+	}
+
+	void sse2Div(const double* x, const double* y, double* out, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(out + i, _mm_div_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+
+		scalarDiv(x + i, y + i, out + i, n - i);
+	}
+
+	void sse2Less(const double* x, const double* y, double* out, size_t n)
+	{
+		__m128d one = _mm_set1_pd(1.0);
+
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(out + i, _mm_and_pd(_mm_cmplt_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)), one));
+
+		scalarLess(x + i, y + i, out + i, n - i);
+	}
+
+	void sse2Greater(const double* x, const double* y, double* out, size_t n)
+	{
+		__m128d one = _mm_set1_pd(1.0);
+
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(out + i, _mm_and_pd(_mm_cmpgt_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)), one));
+
+		scalarGreater(x + i, y + i, out + i, n - i);
+	}
+
+	void sse2Equal(const double* x, const double* y, double* out, size_t n)
+	{
+		__m128d one = _mm_set1_pd(1.0);
+
+		size_t i = 0;
+		for (; i + 2 <= n; i += 2)
+			_mm_storeu_pd(out + i, _mm_and_pd(_mm_cmpeq_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)), one));
+
+		scalarEqual(x + i, y + i, out + i, n - i);
+	}
+
+	// AVX2 variants, only called after detectKernelLevel() confirmed support.
+
+	YOCTA_TARGET_AVX2 double avx2Sum(const double* x, size_t n)
+	{
+		__m256d a = _mm256_setzero_pd(), b = _mm256_setzero_pd();
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+		{
+			a = _mm256_add_pd(a, _mm256_loadu_pd(x + i));
+			b = _mm256_add_pd(b, _mm256_loadu_pd(x + i + 4));
+		}
+
+		double lanes[4];
+		_mm256_storeu_pd(lanes, _mm256_add_pd(a, b));
+
+		return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + scalarSum(x + i, n - i);
+	}
+
+	YOCTA_TARGET_AVX2 double avx2Min(const double* x, size_t n)
+	{
+		if (n < 4)
+			return scalarMin(x, n);
+
+		__m256d result = _mm256_loadu_pd(x);
+
+		size_t i = 4;
+		for (; i + 4 <= n; i += 4)
+			result = _mm256_min_pd(result, _mm256_loadu_pd(x + i));
+
+		double lanes[4];
+		_mm256_storeu_pd(lanes, result);
+
+		double tail = scalarMin(lanes, 4);
+		return i < n ? std::min(tail, scalarMin(x + i, n - i)) : tail;
+	}
+
+	YOCTA_TARGET_AVX2 double avx2Max(const double* x, size_t n)
+	{
+		if (n < 4)
+			return scalarMax(x, n);
+
+		__m256d result = _mm256_loadu_pd(x);
+
+		size_t i = 4;
+		for (; i + 4 <= n; i += 4)
+			result = _mm256_max_pd(result, _mm256_loadu_pd(x + i));
+
+		double lanes[4];
+		_mm256_storeu_pd(lanes, result);
+
+		double tail = scalarMax(lanes, 4);
+		return i < n ? std::max(tail, scalarMax(x + i, n - i)) : tail;
+	}
+
+	YOCTA_TARGET_AVX2 double avx2Dot(const double* x, const double* y, size_t n)
+	{
+		__m256d a = _mm256_setzero_pd(), b = _mm256_setzero_pd();
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8)
+		{
+			a = _mm256_add_pd(a, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+			b = _mm256_add_pd(b, _mm256_mul_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+		}
+
+		double lanes[4];
+		_mm256_storeu_pd(lanes, _mm256_add_pd(a, b));
+
+		return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + scalarDot(x + i, y + i, n - i);
+	}
+
+	YOCTA_TARGET_AVX2 void avx2Axpy(double a, const double* x, double* y, size_t n)
+	{
+		__m256d factor = _mm256_set1_pd(a);
+
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i), _mm256_mul_pd(factor, _mm256_loadu_pd(x + i))));
+
+		scalarAxpy(a, x + i, y + i, n - i);
+	}
+
+	YOCTA_TARGET_AVX2 void avx2Scale(double a, const double* x, double* out, size_t n)
+	{
+		__m256d factor = _mm256_set1_pd(a);
+
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(out + i, _mm256_mul_pd(factor, _mm256_loadu_pd(x + i)));
+
+		scalarScale(a, x + i, out + i, n - i);
+	}
+
+	YOCTA_TARGET_AVX2 void avx2Add(const double* x, const double* y, double* out, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+
+		scalarAdd(x + i, y + i, out + i, n - i);
+	}
+
+	YOCTA_TARGET_AVX2 void avx2Sub(const double* x, const double* y, double* out, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+
+		scalarSub(x + i, y + i, out + i, n - i);
+	}
+
+	YOCTA_TARGET_AVX2 void avx2Mult(const double* x, const double* y, double* out, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+
+		scalarMult(x + i, y + i, out + i, n - i);
+	}
+
+	YOCTA_TARGET_AVX2 void avx2Div(const double* x, const double* y, double* out, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+
+		scalarDiv(x + i, y + i, out + i, n - i);
+	}
+
+	YOCTA_TARGET_AVX2 void avx2Less(const double* x, const double* y, double* out, size_t n)
+	{
+		__m256d one = _mm256_set1_pd(1.0);
+
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(out + i, _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), _CMP_LT_OQ), one));
+
+		scalarLess(x + i, y + i, out + i, n - i);
+	}
+
+	YOCTA_TARGET_AVX2 void avx2Greater(const double* x, const double* y, double* out, size_t n)
+	{
+		__m256d one = _mm256_set1_pd(1.0);
+
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(out + i, _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), _CMP_GT_OQ), one));
+
+		scalarGreater(x + i, y + i, out + i, n - i);
+	}
+
+	YOCTA_TARGET_AVX2 void avx2Equal(const double* x, const double* y, double* out, size_t n)
+	{
+		__m256d one = _mm256_set1_pd(1.0);
+
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4)
+			_mm256_storeu_pd(out + i, _mm256_and_pd(_mm256_cmp_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), _CMP_EQ_OQ), one));
+
+		scalarEqual(x + i, y + i, out + i, n - i);
+	}
+
+	#endif
+
+	const NumericKernels scalarKernels = {
+		scalarSum, scalarMin, scalarMax, scalarDot, scalarAxpy, scalarScale,
+		scalarAdd, scalarSub, scalarMult, scalarDiv,
+		scalarLess, scalarGreater, scalarEqual,
+		KernelLevel::SCALAR
+	};
+
+	#ifdef YOCTA_KERNELS_X86
+	const NumericKernels sse2Kernels = {
+		sse2Sum, sse2Min, sse2Max, sse2Dot, sse2Axpy, sse2Scale,
+		sse2Add, sse2Sub, sse2Mult, sse2Div,
+		sse2Less, sse2Greater, sse2Equal,
+		KernelLevel::SSE2
+	};
+
+	const NumericKernels avx2Kernels = {
+		avx2Sum, avx2Min, avx2Max, avx2Dot, avx2Axpy, avx2Scale,
+		avx2Add, avx2Sub, avx2Mult, avx2Div,
+		avx2Less, avx2Greater, avx2Equal,
+		KernelLevel::AVX2
+	};
+	#endif
+
+	const NumericKernels* kernelsFor(KernelLevel level)
+	{
+		#ifdef YOCTA_KERNELS_X86
+		if (level == KernelLevel::AVX2)
+			return &avx2Kernels;
+
+		if (level == KernelLevel::SSE2)
+			return &sse2Kernels;
+		#endif
+
+		return &scalarKernels;
+	}
+
+	// Selected once by the host but read from every isolate's thread.
+	std::atomic<const NumericKernels*> activeKernels = nullptr;
+}
+
+yo::KernelLevel yo::detectKernelLevel()
+{
+	#if defined(YOCTA_KERNELS_X86) && defined(_MSC_VER)
+	int info[4];
+
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return KernelLevel::SSE2;
+
+	__cpuid(info, 1);
+	bool osUsesXSave = (info[2] & (1 << 27)) != 0;
+	bool cpuHasAvx = (info[2] & (1 << 28)) != 0;
+
+	if (!osUsesXSave || !cpuHasAvx || (_xgetbv(0) & 0x6) != 0x6)
+		return KernelLevel::SSE2;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) ? KernelLevel::AVX2 : KernelLevel::SSE2;
+
+	#elif defined(YOCTA_KERNELS_X86)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? KernelLevel::AVX2 : KernelLevel::SSE2;
+
+	#else
+	return KernelLevel::SCALAR;
+	#endif
+}
+
+void yo::selectKernelLevel(KernelLevel level)
+{
+	activeKernels.store(kernelsFor(std::min(level, detectKernelLevel())), std::memory_order_release);
+}
+
+const yo::NumericKernels& yo::numericKernels()
+{
+	static const NumericKernels* detectedKernels = kernelsFor(detectKernelLevel());
+
+	const NumericKernels* selected = activeKernels.load(std::memory_order_acquire);
+	return selected ? *selected : *detectedKernels;
+}
+
+const char* yo::translateKernelLevel(KernelLevel level)
+{
+	switch (level)
+	{
+		case KernelLevel::SCALAR:
+			return "scalar";
+
+		case KernelLevel::SSE2:
+			return "sse2";
+
+		case KernelLevel::AVX2:
+			return "avx2";
+	}
+
+	return "";
+}
\ No newline at end of file
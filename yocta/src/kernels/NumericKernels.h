@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+
+namespace yo
+{
+	enum class KernelLevel
+	{
+		SCALAR = 0,
+		SSE2,
+		AVX2
+	};
+
+	struct NumericKernels
+	{
+	public:
+		double (*sum)(const double* x, size_t n);
+
+		double (*min)(const double* x, size_t n);
+
+		double (*max)(const double* x, size_t n);
+
+		double (*dot)(const double* x, const double* y, size_t n);
+
+		void (*axpy)(double a, const double* x, double* y, size_t n);
+
+		void (*scale)(double a, const double* x, double* out, size_t n);
+
+		void (*add)(const double* x, const double* y, double* out, size_t n);
+
+		void (*sub)(const double* x, const double* y, double* out, size_t n);
+
+		void (*mult)(const double* x, const double* y, double* out, size_t n);
+
+		void (*div)(const double* x, const double* y, double* out, size_t n);
+
+		void (*less)(const double* x, const double* y, double* out, size_t n);
+
+		void (*greater)(const double* x, const double* y, double* out, size_t n);
+
+		void (*equal)(const double* x, const double* y, double* out, size_t n);
+
+	public:
+		KernelLevel level;
+	};
+
+	const NumericKernels& numericKernels();
+
+	KernelLevel detectKernelLevel();
+
+	void selectKernelLevel(KernelLevel level);
+
+	const char* translateKernelLevel(KernelLevel level);
+}
\ No newline at end of file
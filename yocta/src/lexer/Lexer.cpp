@@ -1,4 +1,5 @@
 #include "Lexer.h"
+#include <algorithm>
 #include <string>
 
 yo::Lexer::Lexer(const char* source)
@@ -13,11 +14,21 @@ void yo::Lexer::open(const char* source)
 
 yo::Token yo::Lexer::nextToken()
 {
-	while (std::isspace(peek()))
-		nextCharacter();
+	while (true)
+	{
+		while (std::isspace(peek()))
+		{
+			if (peek() == '\n')
+				m_Line++;
+
+			nextCharacter();
+		}
+
+		if (peek() != '/' || (peek(1) != '/' && peek(1) != '*'))
+			break;
 
-	if (peek() == '/')
 		handleComments();
+	}
 
 	if (peek() == '\0')
 		return createToken("\0", TokenType::T_EOF);
@@ -45,10 +56,18 @@ yo::Token yo::Lexer::handleNumeric()
 	while (std::isdigit(peek()))
 		nextCharacter();
 
-	std::string tokenData;
-	tokenData.assign(start, m_Source - start);
+	TokenType type = TokenType::T_INTEGER;
+
+	if (peek() == '.' && std::isdigit(peek(1)))
+	{
+		type = TokenType::T_NUMERIC;
+
+		nextCharacter();
+		while (std::isdigit(peek()))
+			nextCharacter();
+	}
 
-	return createToken(tokenData, TokenType::T_NUMERIC);
+	return createToken({ start, (size_t)(m_Source - start) }, type);
 }
 
 yo::Token yo::Lexer::handleIdentifier()
@@ -60,10 +79,8 @@ yo::Token yo::Lexer::handleIdentifier()
 	while (validIdentifier(peek()))
 		nextCharacter();
 
-	std::string tokenData;
-	tokenData.assign(start, m_Source - start);
-
-	return createToken(tokenData, getIdentifierType(tokenData));
+	std::string_view identifier(start, m_Source - start);
+	return createToken(identifier, getIdentifierType(identifier));
 }
 
 yo::Token yo::Lexer::handleSymbol(char symbol)
@@ -82,17 +99,20 @@ yo::Token yo::Lexer::handleSymbol(char symbol)
 		case ';': return createToken(";", TokenType::T_SEMICOLON);
 		case '.': return createToken(".", TokenType::T_DOT);
 		case ',': return createToken(",", TokenType::T_COMMA);
+		case ':': return createToken(":", TokenType::T_COLON);
 
 		case '+': return createToken("+", TokenType::T_PLUS);
 		case '-': return createToken("-", TokenType::T_MINUS);
 		case '*': return createToken("*", TokenType::T_ASTERISTIC);
 		case '/': return createToken("/", TokenType::T_SLASH);
+		case '%': return createToken("%", TokenType::T_PERCENT);
 
 		case '&': 
 		{
 			TokenType type = matchesNext('&') ? TokenType::T_AND : TokenType::T_AMPERSTAND;
 			const char* symbol = matchesNext('&') ? "&&" : "&";
-			nextCharacter();
+			if (type == TokenType::T_AND)
+				nextCharacter();
 			return createToken(symbol, type);
 		}
 
@@ -100,7 +120,8 @@ yo::Token yo::Lexer::handleSymbol(char symbol)
 		{
 			TokenType type = matchesNext('|') ? TokenType::T_OR : TokenType::T_PIPE;
 			const char* symbol = matchesNext('|') ? "||" : "|";
-			nextCharacter();
+			if (type == TokenType::T_OR)
+				nextCharacter();
 			return createToken(symbol, type);
 		}
 
@@ -108,7 +129,8 @@ yo::Token yo::Lexer::handleSymbol(char symbol)
 		{
 			TokenType type = matchesNext('=') ? TokenType::T_EXCLAMATION_EQUAL : TokenType::T_EXCLAMATION;
 			const char* symbol = matchesNext('=') ? "!=" : "!";
-			nextCharacter();
+			if (type == TokenType::T_EXCLAMATION_EQUAL)
+				nextCharacter();
 			return createToken(symbol, type);
 		}
 
@@ -116,7 +138,8 @@ yo::Token yo::Lexer::handleSymbol(char symbol)
 		{
 			TokenType type = matchesNext('=') ? TokenType::T_EQUAL_EQUAL : TokenType::T_EQUAL;
 			const char* symbol = matchesNext('=') ? "==" : "=";
-			nextCharacter();
+			if (type == TokenType::T_EQUAL_EQUAL)
+				nextCharacter();
 			return createToken(symbol, type);
 		}
 
@@ -124,14 +147,16 @@ yo::Token yo::Lexer::handleSymbol(char symbol)
 		{
 			TokenType type = matchesNext('=') ? TokenType::T_GREATER_EQUAL : TokenType::T_GREATER;
 			const char* symbol = matchesNext('=') ? ">=" : ">";
-			nextCharacter();
+			if (type == TokenType::T_GREATER_EQUAL)
+				nextCharacter();
 			return createToken(symbol, type);
 		}
 		case '<':
 		{
 			TokenType type = matchesNext('=') ? TokenType::T_LESS_EQUAL : TokenType::T_LESS;
 			const char* symbol = matchesNext('=') ? "<=" : "<";
-			nextCharacter();
+			if (type == TokenType::T_LESS_EQUAL)
+				nextCharacter();
 			return createToken(symbol, type);
 		}
 	}
@@ -155,42 +180,38 @@ yo::Token yo::Lexer::handleString()
 	if (peek() == '\0')
 		return createErrorToken("Missing close quote");
 
-	std::string tokenString;
-	tokenString.assign(start, m_Source - start);
-
+	std::string_view string(start, m_Source - start);
 	nextCharacter();
 
-	return { tokenString, TokenType::T_STRING, m_Line };
+	return { string, TokenType::T_STRING, m_Line };
 }
 
 void yo::Lexer::handleComments()
 {
-	bool isMultiline = false;
 	nextCharacter();
 
 	if (peek() == '/')
 	{
-		while (peek() != '\n')
+		while (peek() != '\n' && peek() != '\0')
 			nextCharacter();
-
-		nextCharacter();
-
-		if (peek() == '/')
-			handleComments();
 	}
 	else if (peek() == '*')
 	{
-		isMultiline = true;
 		nextCharacter();
-		while (peek() != '*' && peek(1) != '/')
+
+		while (peek() != '\0' && !(peek() == '*' && peek(1) == '/'))
+		{
+			if (peek() == '\n')
+				m_Line++;
+
 			nextCharacter();
-		nextCharacter();
-	}
+		}
 
-	if (isMultiline)
-	{
-		nextCharacter();
-		nextCharacter();
+		if (peek() != '\0')
+		{
+			nextCharacter();
+			nextCharacter();
+		}
 	}
 }
 
@@ -213,10 +234,8 @@ bool yo::Lexer::matchesNext(char expected)
 	return peek() == expected;
 }
 
-yo::TokenType yo::Lexer::getIdentifierType(const std::string& identifier) const
+yo::TokenType yo::Lexer::getIdentifierType(std::string_view identifier) const
 {
-	if (identifierTable.find(identifier) == identifierTable.end())
-		return TokenType::T_IDENTIFIER;
-
-	return identifierTable[identifier];
+	auto keyword = identifierTable.find(identifier);
+	return keyword == identifierTable.end() ? TokenType::T_IDENTIFIER : keyword->second;
 }
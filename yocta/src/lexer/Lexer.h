@@ -2,7 +2,7 @@
 #include "StringHelper.h"
 #include "Token.h"
 
-#include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -22,7 +22,7 @@ namespace yo
 		Token nextToken();
 
 	private:
-		Token createToken(const std::string& data, TokenType type) const { return { data, type, m_Line }; }
+		Token createToken(std::string_view data, TokenType type) const { return { data, type, m_Line }; }
 
 		Token createErrorToken(const char* details) const { return { details, TokenType::T_ERROR, m_Line }; }
 
@@ -45,7 +45,7 @@ namespace yo
 		inline bool matchesNext(char expected);
 
 	private:
-		TokenType getIdentifierType(const std::string& identifier) const;
+		TokenType getIdentifierType(std::string_view identifier) const;
 
 	private:
 		inline char peek(int offset = 0) const { return *(m_Source + offset); }
@@ -57,16 +57,16 @@ namespace yo
 		unsigned int m_Line = 1;
 
 	private:
-		inline static std::vector<char> m_ValidSymbols = {
+		inline static const std::vector<char> m_ValidSymbols = {
 			'(', ')', '[', ']', '{', '}',
-			';', '.', ',',
-			'+', '-', '*', '/',
+			';', '.', ',', ':',
+			'+', '-', '*', '/', '%',
 			'!', '=',
 			'>', '<',
 			'|', '&'
 		};
 
-		inline static std::unordered_map<std::string, TokenType> identifierTable = {
+		inline static const std::unordered_map<std::string_view, TokenType> identifierTable = {
 			{ "and", TokenType::T_AND },
 			{ "or", TokenType::T_OR },
 			{ "none", TokenType::T_NONE },
@@ -76,6 +76,10 @@ namespace yo
 			{ "func", TokenType::T_FUNC },
 			{ "return", TokenType::T_RETURN },
 
+			{ "coroutine", TokenType::T_COROUTINE },
+			{ "yield", TokenType::T_YIELD },
+			{ "resume", TokenType::T_RESUME },
+
 			{ "if", TokenType::T_IF },
 			{ "else", TokenType::T_ELSE },
 			{ "this", TokenType::T_THIS },
@@ -85,6 +89,9 @@ namespace yo
 
 			{ "while", TokenType::T_WHILE },
 			{ "for", TokenType::T_FOR },
+			{ "in", TokenType::T_IN },
+
+			{ "delete", TokenType::T_DELETE },
 
 			{ "class", TokenType::T_CLASS },
 			{ "super", TokenType::T_SUPER },
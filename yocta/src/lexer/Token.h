@@ -1,5 +1,6 @@
 #pragma once
-#include <string>
+#include <cstddef>
+#include <string_view>
 
 namespace yo
 {
@@ -9,6 +10,7 @@ namespace yo
 		T_IDENTIFIER,
 		T_STRING,
 		T_NUMERIC,
+		T_INTEGER,
 		T_ERROR, T_EOF,
 
 		// Single Character:
@@ -16,8 +18,8 @@ namespace yo
 		T_LEFT_BRACKETS, T_RIGHT_BRACKETS,
 		T_LEFT_BRACES, T_RIGHT_BRACES,
 		T_COMMA, T_DOT, T_MINUS, T_PLUS,
-		T_SEMICOLON, T_SLASH, T_ASTERISTIC,
-		T_PIPE, T_AMPERSTAND,
+		T_SEMICOLON, T_SLASH, T_ASTERISTIC, T_PERCENT,
+		T_PIPE, T_AMPERSTAND, T_COLON,
 
 		// Multi-character:
 		T_EXCLAMATION, T_EXCLAMATION_EQUAL,
@@ -28,24 +30,28 @@ namespace yo
 		// Keywords:
 		T_AND, T_OR, T_NONE, T_RETURN,
 		T_IF, T_ELSE, T_TRUE, T_FALSE,
-		T_WHILE, T_FOR,
+		T_WHILE, T_FOR, T_IN, T_DELETE,
 		T_VAR, T_FUNC, T_CLASS, T_SUPER, T_THIS,
+		T_COROUTINE, T_YIELD, T_RESUME,
 
 		// Function:
 		T_PRINT
 	};
 
+	constexpr size_t TOKEN_TYPE_COUNT = (size_t)TokenType::T_PRINT + 1;
+
 	class Token
 	{
 	public:
-		Token(std::string data, TokenType type, unsigned int line)
+		Token(std::string_view data, TokenType type, unsigned int line)
 			: type(type), data(data), line(line) { }
 
 		Token() = default;
 
 	public:
 		TokenType type = TokenType::T_NONE;
-		std::string data;
+		// Views into the source being compiled, or into a string literal for symbols and errors.
+		std::string_view data;
 		unsigned int line = 0;
 
 	public:
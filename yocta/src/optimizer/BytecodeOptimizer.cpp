@@ -0,0 +1,241 @@
+#include "BytecodeOptimizer.h"
+
+yo::BytecodeOptimizer::BytecodeOptimizer(const Chunk& chunk)
+	: chunk(chunk), constants(chunk.constantPool)
+{
+}
+
+std::shared_ptr<yo::Chunk> yo::BytecodeOptimizer::optimize(std::vector<int32_t>& offsetMap)
+{
+	decode();
+	threadJumps();
+	rewrite();
+
+	return emit(offsetMap);
+}
+
+void yo::BytecodeOptimizer::decode()
+{
+	std::vector<bool> targets(chunk.data.size() + 1, false);
+
+	for (size_t offset = 0; offset < chunk.data.size(); offset += instructionLength(chunk.data[offset]))
+	{
+		const uint8_t* code = &chunk.data[offset];
+		int length = instructionLength(*code);
+
+		// Quickened forms are per-site runtime state; the optimized chunk starts generic again.
+		Instruction instruction = { offset, (uint8_t)genericOperation((OPCode)*code), { 0, 0 }, chunk.lines[offset], 0, false };
+
+		for (int i = 1; i < length; ++i)
+			instruction.operands[i - 1] = code[i];
+
+		if (isJump(*code))
+		{
+			uint16_t jump = (uint16_t)((code[1] << 8) | code[2]);
+			instruction.target = *code == (uint8_t)OPCode::OP_LOOP ? offset + 3 - jump : offset + 3 + jump;
+			targets[instruction.target] = true;
+		}
+
+		input.push_back(instruction);
+	}
+
+	for (Instruction& instruction : input)
+		instruction.jumpTarget = targets[instruction.origin];
+}
+
+void yo::BytecodeOptimizer::threadJumps()
+{
+	std::vector<int32_t> indices(chunk.data.size() + 1, -1);
+
+	for (size_t i = 0; i < input.size(); ++i)
+		indices[input[i].origin] = (int32_t)i;
+
+	// Forward jumps that land on an unconditional jump go straight to its destination instead.
+	for (Instruction& instruction : input)
+	{
+		if (instruction.code != (uint8_t)OPCode::OP_JUMP && instruction.code != (uint8_t)OPCode::OP_JUMP_IF_FALSE)
+			continue;
+
+		for (int hops = 0; hops < 16; ++hops)
+		{
+			int32_t index = indices[instruction.target];
+			if (index < 0 || input[index].code != (uint8_t)OPCode::OP_JUMP)
+				break;
+
+			instruction.target = input[index].target;
+			++optimizerStatistics.threaded;
+		}
+	}
+}
+
+void yo::BytecodeOptimizer::rewrite()
+{
+	for (size_t i = 0; i < input.size();)
+	{
+		if (fuseIncrement(i))
+		{
+			i += 5;
+			continue;
+		}
+
+		Instruction instruction = input[i++];
+
+		if (foldConstants(instruction))
+			continue;
+
+		specialize(instruction);
+		output.push_back(instruction);
+	}
+}
+
+bool yo::BytecodeOptimizer::fuseIncrement(size_t index)
+{
+	// GET_LOCAL s; CONSTANT c; ADD; SET_LOCAL s; POP_BACK is what 'x = x + c;' compiles to.
+	static const OPCode pattern[] = { OPCode::OP_GET_LOCAL_VAR, OPCode::OP_CONSTANT, OPCode::OP_ADD, OPCode::OP_SET_LOCAL_VAR, OPCode::OP_POP_BACK };
+
+	if (index + 5 > input.size())
+		return false;
+
+	for (size_t i = 0; i < 5; ++i)
+	{
+		if (input[index + i].code != (uint8_t)pattern[i] || (i > 0 && input[index + i].jumpTarget))
+			return false;
+	}
+
+	const Instruction& get = input[index];
+	const Instruction& constant = input[index + 1];
+
+	if (input[index + 3].operands[0] != get.operands[0] || !isNumber(constants[constant.operands[0]]))
+		return false;
+
+	output.push_back({ get.origin, (uint8_t)OPCode::OP_INCREMENT_LOCAL, { get.operands[0], constant.operands[0] }, input[index + 2].line, 0, get.jumpTarget });
+	++optimizerStatistics.fused;
+
+	return true;
+}
+
+bool yo::BytecodeOptimizer::foldConstants(const Instruction& instruction)
+{
+	OPCode operation = (OPCode)instruction.code;
+
+	bool unary = operation == OPCode::OP_NEGATE;
+	bool binary = operation == OPCode::OP_ADD || operation == OPCode::OP_SUB || operation == OPCode::OP_MULT ||
+		operation == OPCode::OP_DIV || operation == OPCode::OP_MOD;
+
+	size_t arity = unary ? 1 : 2;
+
+	if ((!unary && !binary) || instruction.jumpTarget || output.size() < arity || constants.size() >= 256)
+		return false;
+
+	for (size_t i = 1; i <= arity; ++i)
+	{
+		const Instruction& operand = output[output.size() - i];
+
+		if (operand.code != (uint8_t)OPCode::OP_CONSTANT || !isNumber(constants[operand.operands[0]]))
+			return false;
+
+		if (i < arity && operand.jumpTarget)
+			return false;
+	}
+
+	const Value& b = constants[output.back().operands[0]];
+	Value result;
+
+	if (unary)
+		result = -b;
+	else
+	{
+		const Value& a = constants[output[output.size() - 2].operands[0]];
+
+		// Integer division by zero is a runtime error, so it has to stay in the bytecode.
+		bool integers = a.type == ValueType::VT_INTEGER && b.type == ValueType::VT_INTEGER;
+		if (integers && (operation == OPCode::OP_DIV || operation == OPCode::OP_MOD) && std::get<int64_t>(b.variantValue) == 0)
+			return false;
+
+		switch (operation)
+		{
+		case OPCode::OP_ADD: result = a + b; break;
+		case OPCode::OP_SUB: result = a - b; break;
+		case OPCode::OP_MULT: result = a * b; break;
+		case OPCode::OP_DIV: result = a / b; break;
+		case OPCode::OP_MOD: result = a % b; break;
+		default: break;
+		}
+
+		output.pop_back();
+	}
+
+	constants.push_back(result);
+	output.back().operands[0] = (uint8_t)(constants.size() - 1);
+
+	++optimizerStatistics.folded;
+	return true;
+}
+
+void yo::BytecodeOptimizer::specialize(Instruction& instruction)
+{
+	const std::vector<uint8_t>& types = chunk.profile.operandTypes;
+
+	if (types.empty() || types[instruction.origin] != ChunkProfile::SEEN_INTEGERS)
+		return;
+
+	switch ((OPCode)instruction.code)
+	{
+	case OPCode::OP_ADD: instruction.code = (uint8_t)OPCode::OP_ADD_INT; break;
+	case OPCode::OP_SUB: instruction.code = (uint8_t)OPCode::OP_SUB_INT; break;
+	case OPCode::OP_MULT: instruction.code = (uint8_t)OPCode::OP_MULT_INT; break;
+	case OPCode::OP_LESS: instruction.code = (uint8_t)OPCode::OP_LESS_INT; break;
+	case OPCode::OP_GREATER: instruction.code = (uint8_t)OPCode::OP_GREATER_INT; break;
+	default: return;
+	}
+
+	++optimizerStatistics.specialized;
+}
+
+std::shared_ptr<yo::Chunk> yo::BytecodeOptimizer::emit(std::vector<int32_t>& offsetMap) const
+{
+	offsetMap.assign(chunk.data.size() + 1, -1);
+
+	size_t position = 0;
+	for (const Instruction& instruction : output)
+	{
+		offsetMap[instruction.origin] = (int32_t)position;
+		position += instructionLength(instruction.code);
+	}
+
+	offsetMap[chunk.data.size()] = (int32_t)position;
+
+	auto optimized = std::make_shared<Chunk>();
+	optimized->constantPool = constants;
+
+	for (const Instruction& instruction : output)
+	{
+		size_t start = optimized->data.size();
+		optimized->push_back(instruction.code, instruction.line);
+
+		if (isJump(instruction.code))
+		{
+			int32_t target = offsetMap[instruction.target];
+			if (target < 0)
+				return nullptr;
+
+			int64_t distance = instruction.code == (uint8_t)OPCode::OP_LOOP ? (int64_t)start + 3 - target : target - ((int64_t)start + 3);
+			if (distance < 0 || distance > UINT16_MAX)
+				return nullptr;
+
+			optimized->push_back((uint8_t)((distance >> 8) & 0xFF), instruction.line);
+			optimized->push_back((uint8_t)(distance & 0xFF), instruction.line);
+			continue;
+		}
+
+		for (int i = 1; i < instructionLength(instruction.code); ++i)
+			optimized->push_back(instruction.operands[i - 1], instruction.line);
+	}
+
+	return optimized;
+}
+
+bool yo::BytecodeOptimizer::isJump(uint8_t code)
+{
+	return code == (uint8_t)OPCode::OP_JUMP || code == (uint8_t)OPCode::OP_JUMP_IF_FALSE || code == (uint8_t)OPCode::OP_LOOP;
+}
\ No newline at end of file
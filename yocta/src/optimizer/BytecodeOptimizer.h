@@ -0,0 +1,66 @@
+#pragma once
+#include <memory>
+
+#include "Chunk.h"
+
+namespace yo
+{
+	struct OptimizerStatistics
+	{
+	public:
+		size_t folded = 0;
+		size_t fused = 0;
+		size_t specialized = 0;
+		size_t threaded = 0;
+	};
+
+	class BytecodeOptimizer
+	{
+	public:
+		explicit BytecodeOptimizer(const Chunk& chunk);
+
+	public:
+		std::shared_ptr<Chunk> optimize(std::vector<int32_t>& offsetMap);
+
+		const OptimizerStatistics& statistics() const { return optimizerStatistics; }
+
+	private:
+		struct Instruction
+		{
+		public:
+			size_t origin;
+			uint8_t code;
+			uint8_t operands[2];
+			int line;
+			size_t target;
+			bool jumpTarget;
+		};
+
+	private:
+		void decode();
+
+		void threadJumps();
+
+		void rewrite();
+
+		bool fuseIncrement(size_t index);
+
+		bool foldConstants(const Instruction& instruction);
+
+		void specialize(Instruction& instruction);
+
+		std::shared_ptr<Chunk> emit(std::vector<int32_t>& offsetMap) const;
+
+	private:
+		static bool isJump(uint8_t code);
+
+	private:
+		const Chunk& chunk;
+
+		std::vector<Instruction> input;
+		std::vector<Instruction> output;
+		std::vector<Value> constants;
+
+		OptimizerStatistics optimizerStatistics;
+	};
+}
\ No newline at end of file
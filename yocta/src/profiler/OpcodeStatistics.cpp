@@ -0,0 +1,123 @@
+#include "OpcodeStatistics.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <numeric>
+
+namespace
+{
+	double share(uint64_t count, uint64_t total)
+	{
+		return total ? 100.0 * count / total : 0.0;
+	}
+}
+
+yo::OpcodeStatistics::OpcodeStatistics()
+	: operations(OPCODE_COUNT), pairs(OPCODE_COUNT * OPCODE_COUNT), triples(OPCODE_COUNT * OPCODE_COUNT * OPCODE_COUNT) { }
+
+uint64_t yo::OpcodeStatistics::executed() const
+{
+	return std::accumulate(operations.begin(), operations.end(), (uint64_t)0);
+}
+
+std::vector<yo::OpcodeStatistics::Sequence> yo::OpcodeStatistics::sorted(const std::vector<uint64_t>& counts)
+{
+	std::vector<Sequence> sequences;
+
+	for (size_t index = 0; index < counts.size(); ++index)
+	{
+		if (counts[index])
+			sequences.push_back({ index, counts[index] });
+	}
+
+	std::sort(sequences.begin(), sequences.end(), [](const Sequence& a, const Sequence& b)
+	{
+		return a.count != b.count ? a.count > b.count : a.index < b.index;
+	});
+
+	return sequences;
+}
+
+void yo::OpcodeStatistics::writeTable(FILE* file) const
+{
+	uint64_t total = executed();
+	uint64_t pairTotal = std::accumulate(pairs.begin(), pairs.end(), (uint64_t)0);
+	uint64_t tripleTotal = std::accumulate(triples.begin(), triples.end(), (uint64_t)0);
+
+	fprintf(file, "Instructions executed: %" PRIu64 "\n\n", total);
+	fprintf(file, "%8s %14s  %s\n", "share", "count", "operation");
+
+	for (const Sequence& operation : sorted(operations))
+		fprintf(file, "%7.2f%% %14" PRIu64 "  %s\n", share(operation.count, total), operation.count, translateCode((OPCode)operation.index));
+
+	std::vector<Sequence> sequences = sorted(pairs);
+	fprintf(file, "\nPairs (%zu distinct):\n", sequences.size());
+
+	for (size_t row = 0; row < std::min(sequences.size(), TABLE_ROWS); ++row)
+	{
+		size_t index = sequences[row].index;
+
+		fprintf(file, "%7.2f%% %14" PRIu64 "  %s %s\n", share(sequences[row].count, pairTotal), sequences[row].count,
+			translateCode((OPCode)(index / OPCODE_COUNT)), translateCode((OPCode)(index % OPCODE_COUNT)));
+	}
+
+	sequences = sorted(triples);
+	fprintf(file, "\nTriples (%zu distinct):\n", sequences.size());
+
+	for (size_t row = 0; row < std::min(sequences.size(), TABLE_ROWS); ++row)
+	{
+		size_t index = sequences[row].index;
+
+		fprintf(file, "%7.2f%% %14" PRIu64 "  %s %s %s\n", share(sequences[row].count, tripleTotal), sequences[row].count,
+			translateCode((OPCode)(index / (OPCODE_COUNT * OPCODE_COUNT))), translateCode((OPCode)(index / OPCODE_COUNT % OPCODE_COUNT)),
+			translateCode((OPCode)(index % OPCODE_COUNT)));
+	}
+
+	uint64_t jumps = jumpsTaken + jumpsNotTaken;
+	uint64_t globals = globalReads + globalWrites;
+	uint64_t locals = localReads + localWrites;
+
+	fprintf(file, "\nConditional jumps: %" PRIu64 " taken (%.2f%%), %" PRIu64 " not taken (%.2f%%)\n",
+		jumpsTaken, share(jumpsTaken, jumps), jumpsNotTaken, share(jumpsNotTaken, jumps));
+
+	fprintf(file, "Variable accesses: %" PRIu64 " global (%.2f%%; %" PRIu64 " reads, %" PRIu64 " writes), %" PRIu64 " local (%.2f%%; %" PRIu64 " reads, %" PRIu64 " writes)\n",
+		globals, share(globals, globals + locals), globalReads, globalWrites, locals, share(locals, globals + locals), localReads, localWrites);
+}
+
+void yo::OpcodeStatistics::writeJson(FILE* file) const
+{
+	fprintf(file, "{\n  \"instructions\": %" PRIu64 ",\n  \"operations\": {", executed());
+
+	const char* separator = "";
+
+	for (const Sequence& operation : sorted(operations))
+	{
+		fprintf(file, "%s\n    \"%s\": %" PRIu64, separator, translateCode((OPCode)operation.index), operation.count);
+		separator = ",";
+	}
+
+	fprintf(file, "\n  },\n  \"pairs\": [");
+	separator = "";
+
+	for (const Sequence& pair : sorted(pairs))
+	{
+		fprintf(file, "%s\n    { \"sequence\": [\"%s\", \"%s\"], \"count\": %" PRIu64 " }", separator,
+			translateCode((OPCode)(pair.index / OPCODE_COUNT)), translateCode((OPCode)(pair.index % OPCODE_COUNT)), pair.count);
+		separator = ",";
+	}
+
+	fprintf(file, "\n  ],\n  \"triples\": [");
+	separator = "";
+
+	for (const Sequence& triple : sorted(triples))
+	{
+		fprintf(file, "%s\n    { \"sequence\": [\"%s\", \"%s\", \"%s\"], \"count\": %" PRIu64 " }", separator,
+			translateCode((OPCode)(triple.index / (OPCODE_COUNT * OPCODE_COUNT))), translateCode((OPCode)(triple.index / OPCODE_COUNT % OPCODE_COUNT)),
+			translateCode((OPCode)(triple.index % OPCODE_COUNT)), triple.count);
+		separator = ",";
+	}
+
+	fprintf(file, "\n  ],\n  \"conditionalJumps\": { \"taken\": %" PRIu64 ", \"notTaken\": %" PRIu64 " },\n", jumpsTaken, jumpsNotTaken);
+	fprintf(file, "  \"globals\": { \"reads\": %" PRIu64 ", \"writes\": %" PRIu64 " },\n", globalReads, globalWrites);
+	fprintf(file, "  \"locals\": { \"reads\": %" PRIu64 ", \"writes\": %" PRIu64 " }\n}\n", localReads, localWrites);
+}
\ No newline at end of file
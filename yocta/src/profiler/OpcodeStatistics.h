@@ -0,0 +1,114 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "OperationCodes.h"
+
+namespace yo
+{
+	// Counts what the interpreter executes: every operation, the pairs and triples of operations that follow each
+	// other, which way conditional jumps go and how often variables are reached through globals or locals. Only the
+	// counting instantiation of the dispatch loop calls into it. Code the JITs run natively is not seen; quickened
+	// and optimized operations are counted under their own names, as they are what actually ran.
+	class OpcodeStatistics
+	{
+	public:
+		// OP_RESUME is the last operation code.
+		static constexpr size_t OPCODE_COUNT = (size_t)OPCode::OP_RESUME + 1;
+		static constexpr size_t TABLE_ROWS = 20;
+
+	public:
+		OpcodeStatistics();
+
+	public:
+		void count(uint8_t instruction)
+		{
+			size_t operation = instruction < OPCODE_COUNT ? instruction : 0;
+			++operations[operation];
+
+			// Operation zero is never executed, so it marks the start of a sequence.
+			if (previous[0])
+			{
+				++pairs[previous[0] * OPCODE_COUNT + operation];
+
+				if (previous[1])
+					++triples[(previous[1] * OPCODE_COUNT + previous[0]) * OPCODE_COUNT + operation];
+			}
+
+			previous[1] = previous[0];
+			previous[0] = (uint8_t)operation;
+
+			switch ((OPCode)operation)
+			{
+				case OPCode::OP_GET_GLOBAL_VAR:
+				case OPCode::OP_GET_GLOBAL_CACHED:
+					++globalReads;
+					break;
+
+				case OPCode::OP_DEFINE_GLOBAL_VAR:
+				case OPCode::OP_SET_GLOBAL_VAR:
+				case OPCode::OP_SET_GLOBAL_CACHED:
+					++globalWrites;
+					break;
+
+				case OPCode::OP_GET_LOCAL_VAR:
+					++localReads;
+					break;
+
+				case OPCode::OP_SET_LOCAL_VAR:
+					++localWrites;
+					break;
+
+				// Reads the local and writes it back.
+				case OPCode::OP_INCREMENT_LOCAL:
+					++localReads;
+					++localWrites;
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		void branch(bool taken) { ++(taken ? jumpsTaken : jumpsNotTaken); }
+
+		// A new run does not continue the sequence the last one ended with.
+		void breakSequence() { previous[0] = previous[1] = 0; }
+
+		uint64_t executed() const;
+
+	public:
+		// The operations, and the most frequent pairs and triples.
+		void writeTable(FILE* file) const;
+
+		// Every counter, with each pair and triple that occurred.
+		void writeJson(FILE* file) const;
+
+	private:
+		struct Sequence
+		{
+		public:
+			size_t index;
+			uint64_t count;
+		};
+
+	private:
+		static std::vector<Sequence> sorted(const std::vector<uint64_t>& counts);
+
+	private:
+		std::vector<uint64_t> operations;
+		std::vector<uint64_t> pairs;
+		std::vector<uint64_t> triples;
+		uint8_t previous[2] = {};
+
+	private:
+		uint64_t jumpsTaken = 0;
+		uint64_t jumpsNotTaken = 0;
+		uint64_t globalReads = 0;
+		uint64_t globalWrites = 0;
+		uint64_t localReads = 0;
+		uint64_t localWrites = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,331 @@
+#include "SamplingProfiler.h"
+#include "VirtualMachine.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#define YOCTA_SIGPROF_SUPPORTED
+#define YOCTA_THREAD_TIMER_SUPPORTED
+#include <signal.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#define YOCTA_SIGPROF_SUPPORTED
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+#if defined(YOCTA_THREAD_TIMER_SUPPORTED) && !defined(sigev_notify_thread_id)
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+namespace
+{
+	std::atomic<yo::SamplingProfiler*> activeProfiler = nullptr;
+
+	#ifdef YOCTA_THREAD_TIMER_SUPPORTED
+	timer_t profilingTimer;
+	#endif
+
+	// Stands in for the chunk of a sample taken while the heap was collecting.
+	constexpr uint32_t COLLECTION_OFFSET = UINT32_MAX;
+
+	std::string_view sourceLine(std::string_view source, int line)
+	{
+		for (int current = 1; current < line; ++current)
+		{
+			size_t end = source.find('\n');
+			if (end == std::string_view::npos)
+				return {};
+
+			source.remove_prefix(end + 1);
+		}
+
+		source = source.substr(0, source.find('\n'));
+
+		while (!source.empty() && (source.front() == ' ' || source.front() == '\t'))
+			source.remove_prefix(1);
+
+		while (!source.empty() && (source.back() == '\r' || source.back() == ' ' || source.back() == '\t'))
+			source.remove_suffix(1);
+
+		return source;
+	}
+}
+
+yo::SamplingProfiler::SamplingProfiler(const VirtualMachine& vm, unsigned int frequency)
+	: vm(vm), frequency(std::max(1u, frequency)) { }
+
+yo::SamplingProfiler::~SamplingProfiler()
+{
+	stop();
+}
+
+bool yo::SamplingProfiler::start()
+{
+	#ifdef YOCTA_SIGPROF_SUPPORTED
+	SamplingProfiler* expected = nullptr;
+	if (!activeProfiler.compare_exchange_strong(expected, this))
+		return false;
+
+	if (!stacks)
+		stacks = std::make_unique<Stack[]>(CAPACITY);
+
+	struct sigaction action = {};
+	action.sa_handler = &SamplingProfiler::handleSignal;
+	action.sa_flags = SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGPROF, &action, nullptr);
+
+	#ifdef YOCTA_THREAD_TIMER_SUPPORTED
+	// CPU-time timers only fire on the scheduler tick, a hundred times a second on many kernels, so the VM's
+	// thread is sampled on the monotonic clock instead; time it spends blocked in a native is then seen too.
+	sigevent event = {};
+	event.sigev_notify = SIGEV_THREAD_ID;
+	event.sigev_signo = SIGPROF;
+	event.sigev_notify_thread_id = (pid_t)syscall(SYS_gettid);
+
+	// Both fields must stay in range, so periods of a second or more carry into tv_sec.
+	uint64_t period = std::max<uint64_t>(1000, 1000000000ull / frequency);
+
+	itimerspec interval = {};
+	interval.it_interval.tv_sec = (time_t)(period / 1000000000);
+	interval.it_interval.tv_nsec = (long)(period % 1000000000);
+	interval.it_value = interval.it_interval;
+
+	bool armed = timer_create(CLOCK_MONOTONIC, &event, &profilingTimer) == 0;
+
+	if (armed && timer_settime(profilingTimer, 0, &interval, nullptr) != 0)
+	{
+		timer_delete(profilingTimer);
+		armed = false;
+	}
+	#else
+	uint64_t period = std::max<uint64_t>(1, 1000000ull / frequency);
+
+	itimerval interval = {};
+	interval.it_interval.tv_sec = (time_t)(period / 1000000);
+	interval.it_interval.tv_usec = (suseconds_t)(period % 1000000);
+	interval.it_value = interval.it_interval;
+
+	bool armed = setitimer(ITIMER_PROF, &interval, nullptr) == 0;
+	#endif
+
+	if (!armed)
+	{
+		signal(SIGPROF, SIG_IGN);
+		activeProfiler = nullptr;
+		return false;
+	}
+
+	running = true;
+	return true;
+	#else
+	return false;
+	#endif
+}
+
+void yo::SamplingProfiler::stop()
+{
+	#ifdef YOCTA_SIGPROF_SUPPORTED
+	if (!running)
+		return;
+
+	#ifdef YOCTA_THREAD_TIMER_SUPPORTED
+	timer_delete(profilingTimer);
+	#else
+	itimerval interval = {};
+	setitimer(ITIMER_PROF, &interval, nullptr);
+	#endif
+
+	// A signal already pending finds the handler ignoring it, rather than the default action that ends the process.
+	signal(SIGPROF, SIG_IGN);
+
+	activeProfiler = nullptr;
+	running = false;
+	#endif
+}
+
+void yo::SamplingProfiler::handleSignal(int)
+{
+	if (SamplingProfiler* profiler = activeProfiler.load(std::memory_order_relaxed))
+		profiler->sample();
+}
+
+void yo::SamplingProfiler::sample()
+{
+	const Chunk* chunk = vm.vmChunk;
+	const uint8_t* IP = vm.IP;
+
+	// Outside of a run there is no script to attribute the time to.
+	if (!chunk)
+		return;
+
+	++samples;
+
+	Frame frames[MAX_DEPTH];
+	uint32_t depth = 0;
+
+	// The signal may land between the halves of a context switch, so every frame is checked against its chunk.
+	auto push = [&](const Chunk* chunk, const uint8_t* IP)
+	{
+		const uint8_t* code = chunk ? chunk->data.data() : nullptr;
+
+		if (!code || IP <= code || IP > code + chunk->data.size())
+			return false;
+
+		// The instruction pointer has moved past the opcode running, or past the resume a resumer waits in.
+		frames[depth++] = { chunk, (uint32_t)(IP - code - 1) };
+		return true;
+	};
+
+	// A collection moves coroutines, so their resumers are not followed while one runs.
+	bool collecting = vm.vmHeap.collecting();
+
+	if (collecting)
+		frames[depth++] = { nullptr, COLLECTION_OFFSET };
+
+	if (!push(chunk, IP))
+	{
+		++dropped;
+		return;
+	}
+
+	// The running coroutine holds its resumer's context, which holds its own resumer's, and so on outwards.
+	for (const CoroutineObject* coroutine = vm.activeCoroutine; !collecting && coroutine && depth < MAX_DEPTH; coroutine = coroutine->caller)
+	{
+		if (!push(coroutine->chunk, coroutine->IP))
+			break;
+	}
+
+	uint64_t hash = 14695981039346656037ull;
+
+	for (uint32_t index = 0; index < depth; ++index)
+	{
+		hash = (hash ^ (uint64_t)(uintptr_t)frames[index].chunk) * 1099511628211ull;
+		hash = (hash ^ frames[index].offset) * 1099511628211ull;
+	}
+
+	for (size_t probe = 0; probe < CAPACITY; ++probe)
+	{
+		Stack& stack = stacks[(hash + probe) % CAPACITY];
+
+		if (stack.count == 0)
+		{
+			stack.hash = hash;
+			stack.depth = depth;
+			std::copy(frames, frames + depth, stack.frames);
+			stack.count = 1;
+			return;
+		}
+
+		if (stack.hash == hash && stack.depth == depth && std::equal(frames, frames + depth, stack.frames,
+			[](const Frame& a, const Frame& b) { return a.chunk == b.chunk && a.offset == b.offset; }))
+		{
+			++stack.count;
+			return;
+		}
+	}
+
+	++dropped;
+}
+
+void yo::SamplingProfiler::writeLines(FILE* file, std::string_view source) const
+{
+	struct LineSamples
+	{
+	public:
+		int line;
+		size_t self;
+		size_t total;
+	};
+
+	// Line zero stands for the collector, which no script line owns.
+	std::map<int, LineSamples> lines;
+
+	for (size_t index = 0; stacks && index < CAPACITY; ++index)
+	{
+		const Stack& stack = stacks[index];
+
+		if (stack.count == 0)
+			continue;
+
+		std::vector<int> seen;
+
+		for (uint32_t frame = 0; frame < stack.depth; ++frame)
+		{
+			int line = stack.frames[frame].chunk ? lineOf(stack.frames[frame]) : 0;
+			LineSamples& entry = lines.try_emplace(line, LineSamples{ line, 0, 0 }).first->second;
+
+			if (frame == 0)
+				entry.self += stack.count;
+
+			// A line a coroutine is resumed from inside itself still counts once per sample.
+			if (std::find(seen.begin(), seen.end(), line) == seen.end())
+			{
+				entry.total += stack.count;
+				seen.push_back(line);
+			}
+		}
+	}
+
+	std::vector<LineSamples> sorted;
+
+	for (const auto& [line, entry] : lines)
+		sorted.push_back(entry);
+
+	std::sort(sorted.begin(), sorted.end(), [](const LineSamples& a, const LineSamples& b)
+	{
+		return a.self != b.self ? a.self > b.self : a.total != b.total ? a.total > b.total : a.line < b.line;
+	});
+
+	fprintf(file, "Samples: %zu at %u Hz, %zu dropped\n", samples, frequency, dropped);
+	fprintf(file, "%7s %7s %7s %7s %6s  %s\n", "self %", "self", "total %", "total", "line", "source");
+
+	double percent = samples ? 100.0 / samples : 0.0;
+
+	for (const LineSamples& line : sorted)
+	{
+		std::string_view text = line.line ? sourceLine(source, line.line) : "[garbage collection]";
+
+		fprintf(file, "%6.2f%% %7zu %6.2f%% %7zu %6d  %.*s\n", line.self * percent, line.self, line.total * percent, line.total,
+			line.line, (int)std::min<size_t>(text.size(), 80), text.data());
+	}
+}
+
+void yo::SamplingProfiler::writeFolded(FILE* file, const char* scriptName) const
+{
+	// Stacks that differ only in the instruction within a line fold into one.
+	std::map<std::string, size_t> folded;
+
+	for (size_t index = 0; stacks && index < CAPACITY; ++index)
+	{
+		const Stack& stack = stacks[index];
+
+		if (stack.count == 0)
+			continue;
+
+		std::string line;
+
+		for (uint32_t frame = stack.depth; frame-- > 0;)
+		{
+			if (!line.empty())
+				line += ';';
+
+			if (stack.frames[frame].chunk)
+				line += std::string(scriptName) + ":" + std::to_string(lineOf(stack.frames[frame]));
+			else
+				line += "[gc]";
+		}
+
+		folded[line] += stack.count;
+	}
+
+	for (const auto& [line, count] : folded)
+		fprintf(file, "%s %zu\n", line.c_str(), count);
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string_view>
+
+#include "Chunk.h"
+
+namespace yo
+{
+	class VirtualMachine;
+
+	// Samples where a VM is in its script, on a timer aimed at the VM's thread. The signal handler reads the
+	// instruction pointer the interpreter already keeps, and the resumers of the running coroutine, so the
+	// dispatch loop does nothing extra for it. Samples are counted per distinct stack in a table sized up front,
+	// since the handler cannot allocate; stacks that find it full are counted as dropped. Time in native code
+	// goes to the instruction the VM last left its pointer at: the call for natives, the entry for the JIT.
+	class SamplingProfiler
+	{
+	public:
+		static constexpr unsigned int DEFAULT_FREQUENCY = 1000;
+		static constexpr size_t MAX_DEPTH = 16;
+		static constexpr size_t CAPACITY = 8192;
+
+	public:
+		explicit SamplingProfiler(const VirtualMachine& vm, unsigned int frequency = DEFAULT_FREQUENCY);
+
+		~SamplingProfiler();
+
+		SamplingProfiler(const SamplingProfiler&) = delete;
+		SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+	public:
+		// Fails where there is no profiling timer, or while another profiler is running; one process has one timer.
+		bool start();
+
+		void stop();
+
+		size_t sampleCount() const { return samples; }
+
+		size_t droppedCount() const { return dropped; }
+
+	public:
+		// Samples per source line: where the VM was (self) and where it was or resumed from (total).
+		void writeLines(FILE* file, std::string_view source) const;
+
+		// One line per stack, outermost frame first, as flame graph tools read them.
+		void writeFolded(FILE* file, const char* scriptName) const;
+
+	private:
+		struct Frame
+		{
+		public:
+			const Chunk* chunk;
+			uint32_t offset;
+		};
+
+		struct Stack
+		{
+		public:
+			uint64_t hash;
+			uint32_t depth;
+			uint32_t count;
+			Frame frames[MAX_DEPTH];
+		};
+
+	private:
+		static void handleSignal(int signal);
+
+		void sample();
+
+		static int lineOf(const Frame& frame) { return frame.chunk->lines[frame.offset]; }
+
+	private:
+		const VirtualMachine& vm;
+		unsigned int frequency;
+		std::unique_ptr<Stack[]> stacks;
+		size_t samples = 0;
+		size_t dropped = 0;
+		bool running = false;
+	};
+}
\ No newline at end of file
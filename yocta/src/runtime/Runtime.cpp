@@ -0,0 +1,259 @@
+#include "Runtime.h"
+#include "Natives.h"
+
+yo::Runtime::Runtime()
+{
+	registerNumericNatives(*this);
+}
+
+void yo::Runtime::defineNative(const char* name, NativeFunction function)
+{
+	globals.insert(Value::makeString(name, strlen(name)), { (YoctaObject*)new NativeObject(name, function) });
+}
+
+bool yo::Runtime::negate(Value& value, int line)
+{
+	if (!isNumber(value))
+		return runtimeError(line, "Operand must be a number.\n");
+
+	value = -value;
+	return true;
+}
+
+bool yo::Runtime::defineGlobal(const Value& name, const Value& value, int line)
+{
+	if (!globals.insert(name, value))
+	{
+		std::string_view str = stringView(name);
+		return runtimeError(line, "Variable '%.*s' is already defined.\n", (int)str.size(), str.data());
+	}
+
+	return true;
+}
+
+bool yo::Runtime::lookupGlobal(GlobalCache& cache, const Value& name, int line)
+{
+	Value* value = globals.find(name);
+
+	if (!value)
+	{
+		std::string_view str = stringView(name);
+		return runtimeError(line, "Undefined variable '%.*s'.\n", (int)str.size(), str.data());
+	}
+
+	cache = { value, globals.version() };
+	return true;
+}
+
+bool yo::Runtime::binaryOperation(OPCode operation, Value& a, const Value& b, int line)
+{
+	if (operation == OPCode::OP_ADD && isString(a) && isString(b))
+	{
+		if (stringLength(a) + stringLength(b) > StringObject::MAX_LENGTH)
+			return runtimeError(line, "Strings cannot be longer than %zu characters.\n", StringObject::MAX_LENGTH);
+	}
+	else if (operation == OPCode::OP_BIT_AND || operation == OPCode::OP_BIT_OR)
+	{
+		if (a.type != ValueType::VT_INTEGER || b.type != ValueType::VT_INTEGER)
+			return runtimeError(line, "Operands must be integers.\n");
+	}
+	else if (!isNumber(a) || !isNumber(b))
+		return runtimeError(line, operation == OPCode::OP_ADD ? "Operands must be two numbers or two strings.\n" : "Operands must be numbers.\n");
+
+	else if ((operation == OPCode::OP_DIV || operation == OPCode::OP_MOD) &&
+		a.type == ValueType::VT_INTEGER && b.type == ValueType::VT_INTEGER && std::get<int64_t>(b.variantValue) == 0)
+		return runtimeError(line, "Division by zero.\n");
+
+	switch (operation)
+	{
+	case OPCode::OP_ADD:
+		a = a + b;
+		break;
+
+	case OPCode::OP_SUB:
+		a = a - b;
+		break;
+
+	case OPCode::OP_MULT:
+		a = a * b;
+		break;
+
+	case OPCode::OP_DIV:
+		a = a / b;
+		break;
+
+	case OPCode::OP_MOD:
+		a = a % b;
+		break;
+
+	case OPCode::OP_BIT_AND:
+		a = a & b;
+		break;
+
+	case OPCode::OP_BIT_OR:
+		a = a | b;
+		break;
+
+	case OPCode::OP_GREATER:
+		a = { a > b };
+		break;
+
+	case OPCode::OP_LESS:
+		a = { a < b };
+		break;
+
+	default:
+		break;
+	}
+
+	return true;
+}
+
+bool yo::Runtime::getIndex(Value& container, const Value& key, int line)
+{
+	if (isObjectType(container, ObjectType::NUMERIC_ARRAY))
+	{
+		const std::vector<double>& data = static_cast<NumericArrayObject*>(std::get<YoctaObject*>(container.variantValue))->data;
+
+		if (key.type != ValueType::VT_INTEGER)
+			return runtimeError(line, "Array indices must be integers.\n");
+
+		int64_t index = std::get<int64_t>(key.variantValue);
+		if (index < 0 || (uint64_t)index >= data.size())
+			return runtimeError(line, "Array index %lld out of range.\n", (long long)index);
+
+		container = { data[index] };
+		return true;
+	}
+
+	if (!isObjectType(container, ObjectType::MAP))
+		return runtimeError(line, "Only maps and arrays can be indexed.\n");
+
+	Value* value = getMapObject(container)->table.find(key);
+	container = value ? *value : Value();
+	return true;
+}
+
+bool yo::Runtime::setIndex(Value& container, const Value& key, const Value& value, int line)
+{
+	if (isObjectType(container, ObjectType::NUMERIC_ARRAY))
+	{
+		std::vector<double>& data = static_cast<NumericArrayObject*>(std::get<YoctaObject*>(container.variantValue))->data;
+
+		if (key.type != ValueType::VT_INTEGER)
+			return runtimeError(line, "Array indices must be integers.\n");
+
+		int64_t index = std::get<int64_t>(key.variantValue);
+		if (index < 0 || (uint64_t)index >= data.size())
+			return runtimeError(line, "Array index %lld out of range.\n", (long long)index);
+
+		if (!isNumber(value))
+			return runtimeError(line, "Array elements must be numbers.\n");
+
+		data[index] = toDouble(value);
+		container = value;
+		return true;
+	}
+
+	if (!isObjectType(container, ObjectType::MAP))
+		return runtimeError(line, "Only maps and arrays can be indexed.\n");
+
+	getMapObject(container)->table.insert(key, value);
+	container = value;
+	return true;
+}
+
+bool yo::Runtime::deleteIndex(const Value& container, const Value& key, int line)
+{
+	if (isObjectType(container, ObjectType::NUMERIC_ARRAY))
+	{
+		if (key.type != ValueType::VT_INTEGER)
+			return runtimeError(line, "Array indices must be integers.\n");
+
+		int64_t index = std::get<int64_t>(key.variantValue);
+		if (index < 0 || (uint64_t)index >= static_cast<NumericArrayObject*>(std::get<YoctaObject*>(container.variantValue))->data.size())
+			return runtimeError(line, "Array index %lld out of range.\n", (long long)index);
+
+		return runtimeError(line, "Array elements cannot be deleted.\n");
+	}
+
+	if (!isObjectType(container, ObjectType::MAP))
+		return runtimeError(line, "Only maps and arrays can be indexed.\n");
+
+	getMapObject(container)->table.erase(key);
+	return true;
+}
+
+bool yo::Runtime::forIn(Value& key, const Value& container, Value& iterator, Value& found, int line)
+{
+	if (!isObjectType(container, ObjectType::MAP))
+		return runtimeError(line, "Only maps can be iterated.\n");
+
+	const Table& table = getMapObject(container)->table;
+	int index = table.next((int)std::get<int64_t>(iterator.variantValue));
+
+	if (index == -1)
+	{
+		found = { false };
+		return true;
+	}
+
+	key = table.entryAt(index).key;
+	iterator = { (int64_t)(index + 1) };
+	found = { true };
+
+	return true;
+}
+
+bool yo::Runtime::buildArray(Value& target, const Value* elements, uint8_t count, int line)
+{
+	NumericArrayObject* array = new NumericArrayObject(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (!isNumber(elements[i]))
+			return runtimeError(line, "Array elements must be numbers.\n");
+
+		array->data[i] = toDouble(elements[i]);
+	}
+
+	target = { (YoctaObject*)array };
+	return true;
+}
+
+void yo::Runtime::buildMap(Value& target, const Value* entries, uint8_t count)
+{
+	MapObject* map = new MapObject();
+
+	for (size_t i = 0; i < count * 2u; i += 2)
+		map->table.insert(entries[i], entries[i + 1]);
+
+	target = { (YoctaObject*)map };
+}
+
+bool yo::Runtime::call(Value& callee, Value* args, uint8_t argCount, int line)
+{
+	if (!isObjectType(callee, ObjectType::NATIVE))
+		return runtimeError(line, "Only functions can be called.\n");
+
+	NativeObject* native = static_cast<NativeObject*>(std::get<YoctaObject*>(callee.variantValue));
+	Value result;
+
+	nativeLine = line;
+	if (!native->function(*this, argCount, args, result))
+		return false;
+
+	callee = result;
+	return true;
+}
+
+void yo::Runtime::print(const Value& value)
+{
+	displayValue(value);
+	printf("\n");
+}
+
+void yo::Runtime::reportError(const char* message)
+{
+	runtimeError(nativeLine, "%s", message);
+}
\ No newline at end of file
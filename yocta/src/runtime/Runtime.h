@@ -0,0 +1,146 @@
+#pragma once
+#include <cstdio>
+
+#include "NativeHost.h"
+#include "Chunk.h"
+#include "Table.h"
+
+namespace yo
+{
+	class Runtime : public NativeHost
+	{
+	public:
+		Runtime();
+
+	public:
+		void defineNative(const char* name, NativeFunction function) override;
+
+	public:
+		template<OPCode Operation>
+		bool binary(Value& a, const Value& b, int line)
+		{
+			if (Operation != OPCode::OP_DIV && a.type == ValueType::VT_INTEGER && b.type == ValueType::VT_INTEGER)
+			{
+				int64_t x = std::get<int64_t>(a.variantValue);
+				int64_t y = std::get<int64_t>(b.variantValue);
+				int64_t result;
+
+				switch (Operation)
+				{
+				case OPCode::OP_ADD:
+					if (!checkedAdd(x, y, result))
+						break;
+					a = { result };
+					return true;
+
+				case OPCode::OP_SUB:
+					if (!checkedSub(x, y, result))
+						break;
+					a = { result };
+					return true;
+
+				case OPCode::OP_MULT:
+					if (!checkedMult(x, y, result))
+						break;
+					a = { result };
+					return true;
+
+				case OPCode::OP_LESS:
+					a = { x < y };
+					return true;
+
+				case OPCode::OP_GREATER:
+					a = { x > y };
+					return true;
+
+				default:
+					break;
+				}
+			}
+
+			if (Operation != OPCode::OP_MOD && a.type == ValueType::VT_NUMERIC && b.type == ValueType::VT_NUMERIC)
+			{
+				double x = std::get<double>(a.variantValue);
+				double y = std::get<double>(b.variantValue);
+
+				switch (Operation)
+				{
+				case OPCode::OP_ADD: a = { x + y }; return true;
+				case OPCode::OP_SUB: a = { x - y }; return true;
+				case OPCode::OP_MULT: a = { x * y }; return true;
+				case OPCode::OP_DIV: a = { x / y }; return true;
+				case OPCode::OP_LESS: a = { x < y }; return true;
+				case OPCode::OP_GREATER: a = { x > y }; return true;
+				default: break;
+				}
+			}
+
+			return binaryOperation(Operation, a, b, line);
+		}
+
+		bool negate(Value& value, int line);
+
+		bool getGlobal(GlobalCache& cache, const Value& name, Value& value, int line)
+		{
+			if (cache.version != globals.version() && !lookupGlobal(cache, name, line))
+				return false;
+
+			value = *cache.value;
+			return true;
+		}
+
+		bool setGlobal(GlobalCache& cache, const Value& name, const Value& value, int line)
+		{
+			if (cache.version != globals.version() && !lookupGlobal(cache, name, line))
+				return false;
+
+			*cache.value = value;
+			return true;
+		}
+
+		bool defineGlobal(const Value& name, const Value& value, int line);
+
+	public:
+		bool getIndex(Value& container, const Value& key, int line);
+
+		bool setIndex(Value& container, const Value& key, const Value& value, int line);
+
+		bool deleteIndex(const Value& container, const Value& key, int line);
+
+		bool forIn(Value& key, const Value& container, Value& iterator, Value& found, int line);
+
+		bool buildArray(Value& target, const Value* elements, uint8_t count, int line);
+
+		void buildMap(Value& target, const Value* entries, uint8_t count);
+
+		bool call(Value& callee, Value* args, uint8_t argCount, int line);
+
+		void print(const Value& value);
+
+	public:
+		static bool isFalse(const Value& value)
+		{
+			return value.type == ValueType::VT_NONE || (value.type == ValueType::VT_BOOL && !std::get<bool>(value.variantValue));
+		}
+
+	protected:
+		void reportError(const char* message) override;
+
+	private:
+		bool binaryOperation(OPCode operation, Value& a, const Value& b, int line);
+
+		bool lookupGlobal(GlobalCache& cache, const Value& name, int line);
+
+		template<typename... Values>
+		bool runtimeError(int line, const char* format, Values... value)
+		{
+			printf("<Line %d> ", line);
+			printf(format, value...);
+			return false;
+		}
+
+	private:
+		Table globals;
+		int nativeLine = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,840 @@
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__linux__) || defined(__APPLE__)
+#define YOCTA_MMAP_SUPPORTED
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	constexpr char MAGIC[8] = { 'Y', 'O', 'C', 'T', 'A', 'I', 'M', 'G' };
+
+	// Entries follow in slot order, a key and a value for each full slot, then the control bytes.
+	struct MapRecord
+	{
+	public:
+		uint32_t identity;
+		// Native keys hash by an identity the restoring process gives them anew, so such a map is filled by inserting.
+		uint32_t rekey;
+		uint64_t capacity;
+		uint64_t count;
+	};
+
+	struct ArrayRecord
+	{
+	public:
+		uint32_t identity;
+		uint32_t padding;
+		uint64_t length;
+	};
+
+	struct NativeRecord
+	{
+	public:
+		uint64_t length;
+	};
+
+	// The constants follow, then a line for every byte of code, then the code.
+	struct PrototypeRecord
+	{
+	public:
+		uint32_t identity;
+		uint32_t padding;
+		uint64_t codeSize;
+		uint64_t constantCount;
+	};
+
+	struct CoroutineRecord
+	{
+	public:
+		uint32_t identity;
+		uint32_t state;
+		uint64_t prototype;
+		uint64_t offset;
+		uint64_t stackSize;
+	};
+
+	size_t align(size_t size)
+	{
+		return (size + 7) & ~(size_t)7;
+	}
+
+	// Whether count items of the given size, starting at data, lie inside the image.
+	bool fits(const uint8_t* image, size_t length, const void* data, uint64_t count, size_t size)
+	{
+		size_t start = static_cast<const uint8_t*>(data) - image;
+		return start <= length && count <= (length - start) / size;
+	}
+
+	// Images come from disk, so an offset is only followed once the whole record it names is known to be inside.
+	template<typename Record>
+	const Record* recordAt(const uint8_t* image, size_t length, uint64_t offset)
+	{
+		if (offset % 8 != 0 || offset < sizeof(yo::SnapshotHeader) || offset > length || length - offset < sizeof(Record))
+			return nullptr;
+
+		return reinterpret_cast<const Record*>(image + offset);
+	}
+
+	// Strings are used where they lie, so one must look exactly like a permanent string the writer laid out.
+	bool validString(const uint8_t* image, size_t length, const yo::ValueRecord& record)
+	{
+		if (record.type == yo::ValueType::VT_SHORT_STRING)
+		{
+			yo::ShortString str;
+			std::memcpy(&str, &record.payload, sizeof(str));
+			return str.length <= yo::ShortString::CAPACITY;
+		}
+
+		if (record.type != yo::ValueType::VT_OBJECT || record.objectType != yo::ObjectType::STRING)
+			return false;
+
+		const yo::StringObject* string = recordAt<yo::StringObject>(image, length, record.payload);
+
+		return string && string->type == yo::ObjectType::STRING && string->generation == yo::Generation::PERMANENT &&
+			fits(image, length, string + 1, (uint64_t)string->length + 1, 1);
+	}
+
+	// The interpreter trusts the code it runs, so restored code must be whole instructions whose constants exist and
+	// whose jumps land on an instruction, and must end in one that never falls off the chunk. Coroutine bodies are
+	// never quickened, so cached global accesses, whose caches are not saved, cannot appear.
+	bool validCode(const uint8_t* image, size_t length, const uint8_t* code, uint64_t size, const yo::ValueRecord* constants, uint64_t constantCount)
+	{
+		using yo::OPCode;
+
+		for (size_t index = 0; index < size; index += yo::instructionLength(code[index]))
+		{
+			OPCode operation = (OPCode)code[index];
+
+			if (operation == OPCode::None || operation > OPCode::OP_RESUME || operation == OPCode::OP_GET_GLOBAL_CACHED ||
+				operation == OPCode::OP_SET_GLOBAL_CACHED || size - index < (size_t)yo::instructionLength(code[index]))
+				return false;
+
+			switch (operation)
+			{
+				case OPCode::OP_CONSTANT:
+					if (code[index + 1] >= constantCount)
+						return false;
+					break;
+
+				case OPCode::OP_INCREMENT_LOCAL:
+					if (code[index + 2] >= constantCount)
+						return false;
+					break;
+
+				case OPCode::OP_DEFINE_GLOBAL_VAR:
+				case OPCode::OP_GET_GLOBAL_VAR:
+				case OPCode::OP_SET_GLOBAL_VAR:
+					if (code[index + 1] >= constantCount || !validString(image, length, constants[code[index + 1]]))
+						return false;
+					break;
+
+				case OPCode::OP_COROUTINE:
+					if (code[index + 1] >= constantCount || constants[code[index + 1]].type != yo::ValueType::VT_OBJECT ||
+						constants[code[index + 1]].objectType != yo::ObjectType::PROTOTYPE)
+						return false;
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		std::vector<int> depths;
+		return yo::stackDepths(code, size, depths);
+	}
+}
+
+static_assert(sizeof(yo::ShortString) == sizeof(uint64_t), "Short strings are stored in the payload of a value record.");
+static_assert(sizeof(yo::StringObject) % 8 == 0, "Records must stay 8-byte aligned.");
+
+std::shared_ptr<const yo::Snapshot> yo::Snapshot::load(const char* path)
+{
+	std::shared_ptr<Snapshot> snapshot(new Snapshot());
+
+	#ifdef YOCTA_MMAP_SUPPORTED
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return nullptr;
+
+	struct stat status;
+	if (fstat(fd, &status) != 0 || (size_t)status.st_size < sizeof(SnapshotHeader))
+	{
+		close(fd);
+		return nullptr;
+	}
+
+	// Pages are read in as they are touched. Mapped strings are permanent and hold no references, so the
+	// collector never writes to them and the mapping can stay read-only.
+	void* region = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (region == MAP_FAILED)
+		return nullptr;
+
+	snapshot->image = static_cast<const uint8_t*>(region);
+	snapshot->length = (size_t)status.st_size;
+	snapshot->mapped = true;
+	#else
+	FILE* file = fopen(path, "rb");
+	if (!file)
+		return nullptr;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	if (size < (long)sizeof(SnapshotHeader))
+	{
+		fclose(file);
+		return nullptr;
+	}
+
+	uint8_t* buffer = static_cast<uint8_t*>(::operator new((size_t)size));
+	snapshot->image = buffer;
+	snapshot->length = (size_t)size;
+
+	bool read = fread(buffer, 1, (size_t)size, file) == (size_t)size;
+	fclose(file);
+
+	if (!read)
+		return nullptr;
+	#endif
+
+	const SnapshotHeader* header = snapshot->header();
+
+	if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION ||
+		header->objectLayout != sizeof(StringObject) || header->size != snapshot->length)
+		return nullptr;
+
+	// Names are searched on every lookup, so they are checked up front; what the globals hold waits for restore.
+	if (header->globalCount > (snapshot->length - sizeof(SnapshotHeader)) / sizeof(GlobalRecord))
+		return nullptr;
+
+	for (size_t index = 0; index < header->globalCount; ++index)
+	{
+		if (!validString(snapshot->image, snapshot->length, snapshot->globalRecords()[index].name))
+			return nullptr;
+	}
+
+	return snapshot;
+}
+
+yo::Snapshot::~Snapshot()
+{
+	#ifdef YOCTA_MMAP_SUPPORTED
+	if (mapped)
+	{
+		munmap(const_cast<uint8_t*>(image), length);
+		return;
+	}
+	#endif
+
+	::operator delete(const_cast<uint8_t*>(image));
+}
+
+const yo::GlobalRecord* yo::Snapshot::findGlobal(std::string_view name) const
+{
+	const GlobalRecord* first = globalRecords();
+	const GlobalRecord* last = first + globalCount();
+
+	const GlobalRecord* found = std::lower_bound(first, last, name, [this](const GlobalRecord& global, std::string_view name)
+		{ return stringView(decode(global.name)) < name; });
+
+	return found != last && stringView(decode(found->name)) == name ? found : nullptr;
+}
+
+bool yo::Snapshot::restore(const ValueRecord& record, RestoredObjects& objects, const Table& natives, Value& value) const
+{
+	// Objects are made before what they point at is filled in, so cycles and deep nesting need no recursion.
+	PendingObjects pending;
+	bool restored = decode(record, objects, natives, pending, value);
+
+	for (size_t index = 0; restored && index < pending.size(); ++index)
+		restored = link(pending[index].first, pending[index].second, objects, natives, pending);
+
+	// Half-linked objects must not be found by the next restore; nothing else points at them yet.
+	if (!restored)
+	{
+		for (const auto& [object, offset] : pending)
+			objects.erase(offset);
+	}
+
+	return restored;
+}
+
+yo::Value yo::Snapshot::decode(const ValueRecord& record) const
+{
+	switch (record.type)
+	{
+		case ValueType::VT_BOOL:
+			return { record.payload != 0 };
+
+		case ValueType::VT_NUMERIC:
+		{
+			double number;
+			std::memcpy(&number, &record.payload, sizeof(number));
+			return { number };
+		}
+
+		case ValueType::VT_INTEGER:
+			return { (int64_t)record.payload };
+
+		case ValueType::VT_SHORT_STRING:
+		{
+			ShortString str;
+			std::memcpy(&str, &record.payload, sizeof(str));
+			return { str };
+		}
+
+		// Only strings are used in place; the mapping is read-only, but nothing writes to a permanent string.
+		case ValueType::VT_OBJECT:
+			return { reinterpret_cast<YoctaObject*>(const_cast<uint8_t*>(image + record.payload)) };
+
+		default:
+			return {};
+	}
+}
+
+bool yo::Snapshot::decode(const ValueRecord& record, RestoredObjects& objects, const Table& natives, PendingObjects& pending, Value& value) const
+{
+	if (record.type == ValueType::VT_SHORT_STRING || (record.type == ValueType::VT_OBJECT && record.objectType == ObjectType::STRING))
+	{
+		if (!validString(image, length, record))
+			return false;
+
+		value = decode(record);
+		return true;
+	}
+
+	if (record.type != ValueType::VT_OBJECT)
+	{
+		value = decode(record);
+		return true;
+	}
+
+	auto found = objects.find(record.payload);
+	if (found != objects.end())
+	{
+		value = { found->second };
+		return found->second->type == record.objectType;
+	}
+
+	YoctaObject* object = nullptr;
+
+	switch (record.objectType)
+	{
+		case ObjectType::MAP:
+		{
+			const MapRecord* map = recordAt<MapRecord>(image, length, record.payload);
+			if (!map || !fits(image, length, map + 1, map->count, 2 * sizeof(ValueRecord)) ||
+				!fits(image, length, reinterpret_cast<const ValueRecord*>(map + 1) + map->count * 2, map->capacity, 1))
+				return false;
+
+			object = createObject<MapObject>();
+			object->identity = map->identity;
+			break;
+		}
+
+		case ObjectType::NUMERIC_ARRAY:
+		{
+			const ArrayRecord* array = recordAt<ArrayRecord>(image, length, record.payload);
+			if (!array || !fits(image, length, array + 1, array->length, sizeof(double)))
+				return false;
+
+			NumericArrayObject* copy = createObject<NumericArrayObject>((size_t)array->length);
+
+			std::memcpy(copy->data.data(), array + 1, array->length * sizeof(double));
+			copy->identity = array->identity;
+
+			object = copy;
+			break;
+		}
+
+		case ObjectType::NATIVE:
+		{
+			const NativeRecord* native = recordAt<NativeRecord>(image, length, record.payload);
+			if (!native || !fits(image, length, native + 1, native->length, 1) || native->length > StringObject::MAX_LENGTH)
+				return false;
+
+			const Value* defined = natives.find(Value::makeString(reinterpret_cast<const char*>(native + 1), native->length));
+
+			if (!defined || !isObjectType(*defined, ObjectType::NATIVE))
+			{
+				value = {};
+				return true;
+			}
+
+			objects.emplace(record.payload, std::get<YoctaObject*>(defined->variantValue));
+			pending.push_back({ std::get<YoctaObject*>(defined->variantValue), record.payload });
+
+			value = *defined;
+			return true;
+		}
+
+		case ObjectType::PROTOTYPE:
+		{
+			const PrototypeRecord* prototype = recordAt<PrototypeRecord>(image, length, record.payload);
+			if (!prototype || !fits(image, length, prototype + 1, prototype->constantCount, sizeof(ValueRecord)))
+				return false;
+
+			const ValueRecord* constants = reinterpret_cast<const ValueRecord*>(prototype + 1);
+			const int32_t* lines = reinterpret_cast<const int32_t*>(constants + prototype->constantCount);
+
+			if (!fits(image, length, lines, prototype->codeSize, sizeof(int32_t) + 1))
+				return false;
+
+			const uint8_t* code = reinterpret_cast<const uint8_t*>(lines + prototype->codeSize);
+
+			if (!validCode(image, length, code, prototype->codeSize, constants, prototype->constantCount))
+				return false;
+
+			// Coroutines point into the chunk of their prototype without tracing it, so like the ones the
+			// compiler makes, restored prototypes are permanent.
+			Heap::Scope detached(nullptr);
+
+			PrototypeObject* copy = createObject<PrototypeObject>();
+			copy->chunk.data.assign(code, code + prototype->codeSize);
+			copy->chunk.lines.assign(lines, lines + prototype->codeSize);
+			copy->identity = prototype->identity;
+
+			object = copy;
+			break;
+		}
+
+		case ObjectType::COROUTINE:
+		{
+			const CoroutineRecord* coroutine = recordAt<CoroutineRecord>(image, length, record.payload);
+			if (!coroutine || !fits(image, length, coroutine + 1, coroutine->stackSize, sizeof(ValueRecord)) ||
+				(coroutine->state != (uint32_t)CoroutineState::SUSPENDED && coroutine->state != (uint32_t)CoroutineState::DEAD))
+				return false;
+
+			ValueRecord prototype = {};
+			prototype.type = ValueType::VT_OBJECT;
+			prototype.objectType = ObjectType::PROTOTYPE;
+			prototype.payload = coroutine->prototype;
+
+			Value decoded;
+			if (!decode(prototype, objects, natives, pending, decoded))
+				return false;
+
+			// A suspended coroutine resumes at its offset, with the stack the code has there; a finished one never runs again.
+			const Chunk& chunk = static_cast<PrototypeObject*>(std::get<YoctaObject*>(decoded.variantValue))->chunk;
+			bool valid = coroutine->offset <= chunk.data.size();
+
+			if (valid && coroutine->state == (uint32_t)CoroutineState::SUSPENDED)
+			{
+				std::vector<int> depths;
+				valid = stackDepths(chunk.data.data(), chunk.data.size(), depths) && coroutine->offset < chunk.data.size() &&
+					depths[coroutine->offset] >= 0 && (uint64_t)depths[coroutine->offset] == coroutine->stackSize;
+			}
+
+			if (!valid)
+				return false;
+
+			CoroutineObject* copy = createObject<CoroutineObject>(static_cast<PrototypeObject*>(std::get<YoctaObject*>(decoded.variantValue)));
+			copy->IP += coroutine->offset;
+			copy->state = (CoroutineState)coroutine->state;
+			copy->identity = coroutine->identity;
+
+			object = copy;
+			break;
+		}
+
+		default:
+			return false;
+	}
+
+	objects.emplace(record.payload, object);
+	pending.push_back({ object, record.payload });
+
+	value = { object };
+	return true;
+}
+
+bool yo::Snapshot::link(YoctaObject* object, uint64_t offset, RestoredObjects& objects, const Table& natives, PendingObjects& pending) const
+{
+	// decode made this object from the record at offset, so the record has been checked to lie inside the image.
+	switch (object->type)
+	{
+		case ObjectType::MAP:
+		{
+			const MapRecord* map = recordAt<MapRecord>(image, length, offset);
+			const ValueRecord* entries = reinterpret_cast<const ValueRecord*>(map + 1);
+			const uint8_t* controls = reinterpret_cast<const uint8_t*>(entries + map->count * 2);
+
+			Table& table = static_cast<MapObject*>(object)->table;
+			Value key;
+			Value value;
+
+			if (map->rekey)
+			{
+				for (size_t entry = 0; entry < map->count; ++entry)
+				{
+					if (!decode(entries[entry * 2], objects, natives, pending, key) || !decode(entries[entry * 2 + 1], objects, natives, pending, value))
+						return false;
+
+					table.insert(key, value);
+				}
+			}
+			else
+			{
+				if (!table.restore(std::vector<uint8_t>(controls, controls + map->capacity)) || table.size() != map->count)
+					return false;
+
+				for (int index = table.next(0); index != -1; index = table.next(index + 1), entries += 2)
+				{
+					if (!decode(entries[0], objects, natives, pending, key) || !decode(entries[1], objects, natives, pending, value))
+						return false;
+
+					table.entryAt(index) = { key, value };
+				}
+			}
+
+			if (Heap* heap = Heap::active())
+				heap->chargeGrowth(object, 0, table.footprint());
+			break;
+		}
+
+		case ObjectType::PROTOTYPE:
+		{
+			const PrototypeRecord* prototype = recordAt<PrototypeRecord>(image, length, offset);
+			const ValueRecord* constants = reinterpret_cast<const ValueRecord*>(prototype + 1);
+
+			std::vector<Value>& constantPool = static_cast<PrototypeObject*>(object)->chunk.constantPool;
+			Value constant;
+
+			for (size_t index = 0; index < prototype->constantCount; ++index)
+			{
+				if (!decode(constants[index], objects, natives, pending, constant))
+					return false;
+
+				constantPool.push_back(constant);
+			}
+			break;
+		}
+
+		case ObjectType::COROUTINE:
+		{
+			const CoroutineRecord* coroutine = recordAt<CoroutineRecord>(image, length, offset);
+			const ValueRecord* stack = reinterpret_cast<const ValueRecord*>(coroutine + 1);
+
+			CoroutineObject* copy = static_cast<CoroutineObject*>(object);
+			Value value;
+
+			for (size_t index = 0; index < coroutine->stackSize; ++index)
+			{
+				if (!decode(stack[index], objects, natives, pending, value))
+					return false;
+
+				copy->stack.push_back(value);
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	return true;
+}
+
+void yo::SnapshotWriter::addPrototypes(const Chunk& chunk)
+{
+	for (const Value& constant : chunk.constantPool)
+	{
+		if (isObjectType(constant, ObjectType::PROTOTYPE))
+			addPrototype(static_cast<PrototypeObject*>(std::get<YoctaObject*>(constant.variantValue)));
+	}
+}
+
+void yo::SnapshotWriter::addPrototype(PrototypeObject* prototype)
+{
+	if (prototypes.emplace(&prototype->chunk, prototype).second)
+		addPrototypes(prototype->chunk);
+}
+
+void yo::SnapshotWriter::addGlobal(const Value& name, const Value& value)
+{
+	globals.push_back({ name, value });
+}
+
+bool yo::SnapshotWriter::write(const char* path)
+{
+	// Globals are sorted by name, so a process that maps the image can find one without reading the others.
+	std::sort(globals.begin(), globals.end(), [](const auto& a, const auto& b) { return stringView(a.first) < stringView(b.first); });
+
+	imageSize = sizeof(SnapshotHeader) + globals.size() * sizeof(GlobalRecord);
+
+	std::vector<GlobalRecord> records;
+	records.reserve(globals.size());
+
+	for (const auto& [name, value] : globals)
+		records.push_back({ encode(name), encode(value) });
+
+	std::vector<uint8_t> image(sizeof(SnapshotHeader) + records.size() * sizeof(GlobalRecord));
+
+	// Writing a record can reach more objects, which are laid out after everything reached so far.
+	for (size_t index = 0; index < pending.size(); ++index)
+	{
+		YoctaObject* object = pending[index];
+		size_t offset = image.size();
+
+		image.resize(offset + recordSize(object));
+		writeRecord(object, image.data() + offset);
+	}
+
+	if (error)
+		return false;
+
+	SnapshotHeader header = {};
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = Snapshot::VERSION;
+	header.objectLayout = sizeof(StringObject);
+	header.size = image.size();
+	header.globalCount = records.size();
+
+	std::memcpy(image.data(), &header, sizeof(header));
+	std::memcpy(image.data() + sizeof(header), records.data(), records.size() * sizeof(GlobalRecord));
+
+	FILE* file = fopen(path, "wb");
+	if (!file)
+	{
+		fail("the file cannot be opened");
+		return false;
+	}
+
+	bool written = fwrite(image.data(), 1, image.size(), file) == image.size();
+	written = fclose(file) == 0 && written;
+
+	if (!written)
+		fail("the file cannot be written");
+
+	return written;
+}
+
+yo::ValueRecord yo::SnapshotWriter::encode(const Value& value)
+{
+	ValueRecord record = {};
+	record.type = value.type;
+
+	switch (value.type)
+	{
+		case ValueType::VT_BOOL:
+			record.payload = std::get<bool>(value.variantValue);
+			break;
+
+		case ValueType::VT_NUMERIC:
+			std::memcpy(&record.payload, &std::get<double>(value.variantValue), sizeof(record.payload));
+			break;
+
+		case ValueType::VT_INTEGER:
+			record.payload = (uint64_t)std::get<int64_t>(value.variantValue);
+			break;
+
+		case ValueType::VT_SHORT_STRING:
+			std::memcpy(&record.payload, &std::get<ShortString>(value.variantValue), sizeof(record.payload));
+			break;
+
+		case ValueType::VT_OBJECT:
+		{
+			YoctaObject* object = std::get<YoctaObject*>(value.variantValue);
+
+			// A rope is saved as the string it spells.
+			if (object->type == ObjectType::ROPE)
+				object = flattenRope(static_cast<RopeObject*>(object));
+
+			record.objectType = object->type;
+			record.payload = reference(object);
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	return record;
+}
+
+uint64_t yo::SnapshotWriter::reference(YoctaObject* object)
+{
+	auto found = offsets.find(object);
+	if (found != offsets.end())
+		return found->second;
+
+	if (object->type == ObjectType::STRING)
+	{
+		auto interned = strings.find(static_cast<StringObject*>(object)->view());
+		if (interned != strings.end())
+			return interned->second;
+
+		strings.emplace(static_cast<StringObject*>(object)->view(), imageSize);
+	}
+
+	uint64_t offset = imageSize;
+	imageSize += recordSize(object);
+
+	offsets.emplace(object, offset);
+	pending.push_back(object);
+
+	return offset;
+}
+
+size_t yo::SnapshotWriter::recordSize(const YoctaObject* object) const
+{
+	switch (object->type)
+	{
+		case ObjectType::STRING:
+			return align(sizeof(StringObject) + static_cast<const StringObject*>(object)->length + 1);
+
+		case ObjectType::MAP:
+		{
+			const Table& table = static_cast<const MapObject*>(object)->table;
+			return sizeof(MapRecord) + table.size() * 2 * sizeof(ValueRecord) + align(table.capacity());
+		}
+
+		case ObjectType::NUMERIC_ARRAY:
+			return sizeof(ArrayRecord) + static_cast<const NumericArrayObject*>(object)->data.size() * sizeof(double);
+
+		case ObjectType::NATIVE:
+			return align(sizeof(NativeRecord) + strlen(static_cast<const NativeObject*>(object)->name));
+
+		case ObjectType::PROTOTYPE:
+		{
+			const Chunk& chunk = static_cast<const PrototypeObject*>(object)->chunk;
+			return sizeof(PrototypeRecord) + chunk.constantPool.size() * sizeof(ValueRecord) + align(chunk.data.size() * (sizeof(int32_t) + 1));
+		}
+
+		case ObjectType::COROUTINE:
+			return sizeof(CoroutineRecord) + static_cast<const CoroutineObject*>(object)->stack.size() * sizeof(ValueRecord);
+
+		default:
+			return 0;
+	}
+}
+
+void yo::SnapshotWriter::writeRecord(YoctaObject* object, uint8_t* record)
+{
+	switch (object->type)
+	{
+		case ObjectType::STRING:
+		{
+			StringObject* string = static_cast<StringObject*>(object);
+			std::memcpy(record, string, sizeof(StringObject) + string->length + 1);
+
+			StringObject* copy = reinterpret_cast<StringObject*>(record);
+			copy->generation = Generation::PERMANENT;
+			copy->marked = false;
+			copy->remembered = false;
+			break;
+		}
+
+		case ObjectType::MAP:
+		{
+			const Table& table = static_cast<MapObject*>(object)->table;
+
+			MapRecord* map = reinterpret_cast<MapRecord*>(record);
+			map->identity = object->identity;
+			map->capacity = table.capacity();
+			map->count = table.size();
+
+			ValueRecord* entries = reinterpret_cast<ValueRecord*>(map + 1);
+
+			for (int index = table.next(0); index != -1; index = table.next(index + 1))
+			{
+				const Table::Entry& entry = table.entryAt(index);
+				map->rekey |= isObjectType(entry.key, ObjectType::NATIVE);
+
+				*entries++ = encode(entry.key);
+				*entries++ = encode(entry.value);
+			}
+
+			uint8_t* controls = reinterpret_cast<uint8_t*>(entries);
+
+			for (size_t index = 0; index < table.capacity(); ++index)
+				controls[index] = table.controlAt((int)index);
+			break;
+		}
+
+		case ObjectType::NUMERIC_ARRAY:
+		{
+			const std::vector<double>& data = static_cast<NumericArrayObject*>(object)->data;
+
+			ArrayRecord* array = reinterpret_cast<ArrayRecord*>(record);
+			array->identity = object->identity;
+			array->length = data.size();
+
+			std::memcpy(array + 1, data.data(), data.size() * sizeof(double));
+			break;
+		}
+
+		case ObjectType::NATIVE:
+		{
+			const char* name = static_cast<NativeObject*>(object)->name;
+
+			NativeRecord* native = reinterpret_cast<NativeRecord*>(record);
+			native->length = strlen(name);
+
+			std::memcpy(native + 1, name, native->length);
+			break;
+		}
+
+		case ObjectType::PROTOTYPE:
+		{
+			const Chunk& chunk = static_cast<PrototypeObject*>(object)->chunk;
+
+			PrototypeRecord* prototype = reinterpret_cast<PrototypeRecord*>(record);
+			prototype->identity = object->identity;
+			prototype->codeSize = chunk.data.size();
+			prototype->constantCount = chunk.constantPool.size();
+
+			ValueRecord* constants = reinterpret_cast<ValueRecord*>(prototype + 1);
+
+			for (size_t index = 0; index < chunk.constantPool.size(); ++index)
+				constants[index] = encode(chunk.constantPool[index]);
+
+			int32_t* lines = reinterpret_cast<int32_t*>(constants + chunk.constantPool.size());
+
+			for (size_t index = 0; index < chunk.data.size() && index < chunk.lines.size(); ++index)
+				lines[index] = chunk.lines[index];
+
+			std::memcpy(lines + chunk.data.size(), chunk.data.data(), chunk.data.size());
+			break;
+		}
+
+		case ObjectType::COROUTINE:
+		{
+			CoroutineObject* coroutine = static_cast<CoroutineObject*>(object);
+			auto prototype = prototypes.find(coroutine->chunk);
+
+			if (coroutine->state == CoroutineState::RUNNING || prototype == prototypes.end())
+			{
+				fail(prototype == prototypes.end() ? "a coroutine runs code no registered prototype holds" : "a coroutine is still running");
+				break;
+			}
+
+			CoroutineRecord* saved = reinterpret_cast<CoroutineRecord*>(record);
+			saved->identity = object->identity;
+			saved->state = (uint32_t)coroutine->state;
+			saved->prototype = reference(prototype->second);
+			saved->offset = coroutine->IP - coroutine->chunk->data.data();
+			saved->stackSize = coroutine->stack.size();
+
+			ValueRecord* stack = reinterpret_cast<ValueRecord*>(saved + 1);
+
+			for (size_t index = 0; index < coroutine->stack.size(); ++index)
+				stack[index] = encode(coroutine->stack[index]);
+			break;
+		}
+
+		default:
+			break;
+	}
+}
\ No newline at end of file
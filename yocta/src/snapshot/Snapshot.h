@@ -0,0 +1,138 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Coroutine.h"
+#include "Table.h"
+
+namespace yo
+{
+	// Objects a VM has rebuilt from an image, by record offset, so everything that shared one keeps sharing it.
+	using RestoredObjects = std::unordered_map<uint64_t, YoctaObject*>;
+
+	// A value as an image holds it: an object is the offset of its record from the start of the image.
+	struct ValueRecord
+	{
+	public:
+		ValueType type;
+		ObjectType objectType;
+		uint8_t padding[6];
+		uint64_t payload;
+	};
+
+	struct GlobalRecord
+	{
+	public:
+		ValueRecord name;
+		ValueRecord value;
+	};
+
+	struct SnapshotHeader
+	{
+	public:
+		char magic[8];
+		uint32_t version;
+		uint32_t objectLayout;
+		uint64_t size;
+		uint64_t globalCount;
+	};
+
+	// The globals of a VM and everything they reach, mapped from an image written by the same build. Strings
+	// keep their in-memory layout and are used where they lie, so only the pages a script reads are loaded;
+	// maps, arrays, prototypes and coroutines are rebuilt the first time a global that reaches them is looked up.
+	class Snapshot
+	{
+	public:
+		static constexpr uint32_t VERSION = 1;
+
+	public:
+		// Nullptr when the file cannot be read or was written by an incompatible build.
+		static std::shared_ptr<const Snapshot> load(const char* path);
+
+		~Snapshot();
+
+		Snapshot(const Snapshot&) = delete;
+		Snapshot& operator=(const Snapshot&) = delete;
+
+	public:
+		size_t globalCount() const { return header()->globalCount; }
+
+		// Names are strings, which need no rebuilding.
+		Value globalName(size_t index) const { return decode(globalRecords()[index].name); }
+
+		const GlobalRecord* findGlobal(std::string_view name) const;
+
+		// Rebuilds what a record points at in the active heap. Natives are looked up by name among the
+		// globals given; one they do not define restores as none. False when a record it reaches is damaged,
+		// in which case none of the objects made on the way are kept.
+		bool restore(const ValueRecord& record, RestoredObjects& objects, const Table& natives, Value& value) const;
+
+	private:
+		using PendingObjects = std::vector<std::pair<YoctaObject*, uint64_t>>;
+
+	private:
+		Snapshot() = default;
+
+	private:
+		const SnapshotHeader* header() const { return reinterpret_cast<const SnapshotHeader*>(image); }
+
+		const GlobalRecord* globalRecords() const { return reinterpret_cast<const GlobalRecord*>(image + sizeof(SnapshotHeader)); }
+
+		Value decode(const ValueRecord& record) const;
+
+		bool decode(const ValueRecord& record, RestoredObjects& objects, const Table& natives, PendingObjects& pending, Value& value) const;
+
+		bool link(YoctaObject* object, uint64_t offset, RestoredObjects& objects, const Table& natives, PendingObjects& pending) const;
+
+	private:
+		const uint8_t* image = nullptr;
+		size_t length = 0;
+		bool mapped = false;
+	};
+
+	// Lays out the globals of a VM, and the objects they reach, as an image. Strings are interned on the way,
+	// so equal strings share one record however many objects held their own copy.
+	class SnapshotWriter
+	{
+	public:
+		// Coroutines only point at the chunk they run, so the prototypes holding those chunks are registered up front.
+		void addPrototypes(const Chunk& chunk);
+
+		void addPrototype(PrototypeObject* prototype);
+
+		void addGlobal(const Value& name, const Value& value);
+
+		bool write(const char* path);
+
+		const char* errorMessage() const { return error; }
+
+	private:
+		ValueRecord encode(const Value& value);
+
+		uint64_t reference(YoctaObject* object);
+
+		size_t recordSize(const YoctaObject* object) const;
+
+		void writeRecord(YoctaObject* object, uint8_t* record);
+
+		void fail(const char* message)
+		{
+			if (!error)
+				error = message;
+		}
+
+	private:
+		std::vector<std::pair<Value, Value>> globals;
+		std::unordered_map<const Chunk*, PrototypeObject*> prototypes;
+
+	private:
+		std::unordered_map<const YoctaObject*, uint64_t> offsets;
+		std::unordered_map<std::string_view, uint64_t> strings;
+		std::vector<YoctaObject*> pending;
+		size_t imageSize = 0;
+		const char* error = nullptr;
+	};
+}
\ No newline at end of file
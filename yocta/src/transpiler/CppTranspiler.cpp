@@ -0,0 +1,436 @@
+#include "CppTranspiler.h"
+
+namespace
+{
+	using namespace yo;
+
+	int stackEffect(const uint8_t* code)
+	{
+		switch (genericOperation((OPCode)*code))
+		{
+			case OPCode::OP_CONSTANT:
+			case OPCode::OP_NONE:
+			case OPCode::OP_TRUE:
+			case OPCode::OP_FALSE:
+			case OPCode::OP_GET_GLOBAL_VAR:
+			case OPCode::OP_GET_LOCAL_VAR:
+			case OPCode::OP_FOR_IN:
+			case OPCode::OP_COROUTINE:
+				return 1;
+
+			case OPCode::OP_ADD:
+			case OPCode::OP_SUB:
+			case OPCode::OP_MULT:
+			case OPCode::OP_DIV:
+			case OPCode::OP_MOD:
+			case OPCode::OP_BIT_AND:
+			case OPCode::OP_BIT_OR:
+			case OPCode::OP_EQUAL:
+			case OPCode::OP_LESS:
+			case OPCode::OP_GREATER:
+			case OPCode::OP_PRINT:
+			case OPCode::OP_POP_BACK:
+			case OPCode::OP_DEFINE_GLOBAL_VAR:
+			case OPCode::OP_GET_INDEX:
+			case OPCode::OP_YIELD:
+				return -1;
+
+			case OPCode::OP_SET_INDEX:
+			case OPCode::OP_DELETE_INDEX:
+				return -2;
+
+			case OPCode::OP_BUILD_MAP:
+				return 1 - 2 * code[1];
+
+			case OPCode::OP_BUILD_ARRAY:
+				return 1 - code[1];
+
+			case OPCode::OP_CALL:
+				return -code[1];
+
+			default:
+				return 0;
+		}
+	}
+
+	const char* binaryTemplate(OPCode operation)
+	{
+		switch (operation)
+		{
+			case OPCode::OP_ADD: return "OP_ADD";
+			case OPCode::OP_SUB: return "OP_SUB";
+			case OPCode::OP_MULT: return "OP_MULT";
+			case OPCode::OP_DIV: return "OP_DIV";
+			case OPCode::OP_MOD: return "OP_MOD";
+			case OPCode::OP_BIT_AND: return "OP_BIT_AND";
+			case OPCode::OP_BIT_OR: return "OP_BIT_OR";
+			case OPCode::OP_LESS: return "OP_LESS";
+			case OPCode::OP_GREATER: return "OP_GREATER";
+			default: return nullptr;
+		}
+	}
+
+	std::string escapeString(std::string_view str)
+	{
+		std::string escaped;
+
+		for (char c : str)
+		{
+			if (c == '"' || c == '\\')
+				escaped += '\\', escaped += c;
+
+			else if (c < 0x20 || c > 0x7E)
+			{
+				char octal[5];
+				snprintf(octal, sizeof(octal), "\\%03o", (unsigned char)c);
+				escaped += octal;
+			}
+
+			else
+				escaped += c;
+		}
+
+		return escaped;
+	}
+}
+
+yo::CppTranspiler::CppTranspiler(const Chunk& chunk, const char* sourceName)
+	: chunk(chunk), sourceName(sourceName)
+{
+}
+
+bool yo::CppTranspiler::transpile(std::string& result)
+{
+	output.clear();
+
+	if (!computeDepths())
+		return false;
+
+	emit("// Generated by yocta --emit-cpp from %s.\n", sourceName);
+	emit("// Link against yocta_transpiled_runtime; define YOCTA_NO_MAIN to embed yoctaScript() in a host.\n");
+	emit("#include \"Runtime.h\"\n\n");
+	emit("using namespace yo;\n\n");
+	emit("extern \"C\" bool yoctaScript(Runtime& runtime)\n{\n");
+
+	if (!emitConstants())
+		return false;
+
+	if (maxDepth > 0)
+	{
+		emit("\tValue");
+		for (int slot = 0; slot < maxDepth; ++slot)
+			emit(slot ? ", s%d" : " s%d", slot);
+		emit(";\n");
+	}
+
+	bool firstCache = true;
+	for (size_t offset = 0; offset < chunk.data.size(); offset += instructionLength(chunk.data[offset]))
+	{
+		OPCode operation = genericOperation((OPCode)chunk.data[offset]);
+
+		if (depths[offset] >= 0 && (operation == OPCode::OP_GET_GLOBAL_VAR || operation == OPCode::OP_SET_GLOBAL_VAR))
+		{
+			emit(firstCache ? "\tGlobalCache g%zu" : ", g%zu", offset);
+			firstCache = false;
+		}
+	}
+
+	emit(firstCache ? "\n" : ";\n\n");
+
+	int line = -1;
+	for (size_t offset = 0; offset < chunk.data.size(); offset += instructionLength(chunk.data[offset]))
+	{
+		if (depths[offset] < 0)
+			continue;
+
+		if (targets[offset])
+			emit("L%zu:\n", offset);
+
+		if (chunk.lines[offset] != line)
+		{
+			line = chunk.lines[offset];
+			emit("\t// line %d\n", line);
+		}
+
+		if (!emitInstruction(offset))
+			return false;
+	}
+
+	emit("}\n\n");
+	emit("#ifndef YOCTA_NO_MAIN\n");
+	emit("int main()\n{\n");
+	emit("\tRuntime runtime;\n");
+	emit("\treturn yoctaScript(runtime) ? 0 : 70;\n");
+	emit("}\n");
+	emit("#endif\n");
+
+	result.swap(output);
+	return true;
+}
+
+bool yo::CppTranspiler::computeDepths()
+{
+	depths.assign(chunk.data.size() + 1, -1);
+	targets.assign(chunk.data.size() + 1, false);
+
+	std::vector<size_t> worklist = { 0 };
+	depths[0] = 0;
+
+	// Every path into an instruction has to agree on the stack depth, so each slot can be a plain C++ local.
+	while (!worklist.empty())
+	{
+		size_t offset = worklist.back();
+		worklist.pop_back();
+
+		const uint8_t* code = &chunk.data[offset];
+		OPCode operation = genericOperation((OPCode)*code);
+		int depth = depths[offset] + stackEffect(code);
+
+		if (depth < 0)
+			return fail("stack underflow in compiled chunk");
+
+		maxDepth = std::max(maxDepth, std::max(depth, depths[offset]));
+
+		std::vector<size_t> successors;
+
+		switch (operation)
+		{
+			case OPCode::OP_RETURN:
+				break;
+
+			case OPCode::OP_JUMP:
+			case OPCode::OP_LOOP:
+				successors.push_back(jumpTarget(offset));
+				targets[jumpTarget(offset)] = true;
+				break;
+
+			case OPCode::OP_JUMP_IF_FALSE:
+				successors.push_back(offset + 3);
+				successors.push_back(jumpTarget(offset));
+				targets[jumpTarget(offset)] = true;
+				break;
+
+			default:
+				successors.push_back(offset + instructionLength(*code));
+				break;
+		}
+
+		for (size_t successor : successors)
+		{
+			if (successor >= chunk.data.size())
+				return fail("control flow leaves the chunk");
+
+			if (depths[successor] == -1)
+			{
+				depths[successor] = depth;
+				worklist.push_back(successor);
+			}
+			else if (depths[successor] != depth)
+				return fail("stack depth is not statically known");
+		}
+	}
+
+	return true;
+}
+
+bool yo::CppTranspiler::emitConstants()
+{
+	if (chunk.constantPool.empty())
+		return true;
+
+	emit("\tstatic const Value constants[] = {\n");
+
+	for (const Value& constant : chunk.constantPool)
+	{
+		switch (constant.type)
+		{
+			case ValueType::VT_NONE:
+				emit("\t\tValue(),\n");
+				break;
+
+			case ValueType::VT_BOOL:
+				emit("\t\tValue(%s),\n", std::get<bool>(constant.variantValue) ? "true" : "false");
+				break;
+
+			case ValueType::VT_INTEGER:
+				emit("\t\tValue((int64_t)%lluULL),\n", (unsigned long long)std::get<int64_t>(constant.variantValue));
+				break;
+
+			case ValueType::VT_NUMERIC:
+			{
+				double number = std::get<double>(constant.variantValue);
+
+				if (std::isnan(number))
+					emit("\t\tValue((double)NAN),\n");
+				else if (std::isinf(number))
+					emit("\t\tValue(%sHUGE_VAL),\n", number < 0 ? "-" : "");
+				else
+					emit("\t\tValue(%a),\n", number);
+				break;
+			}
+
+			default:
+			{
+				if (!isString(constant))
+					return fail("constant pool holds a value that cannot be written as C++");
+
+				std::string_view str = stringView(constant);
+				output.append("\t\tValue::makeString(\"").append(escapeString(str));
+				emit("\", %zu),\n", str.size());
+				break;
+			}
+		}
+	}
+
+	emit("\t};\n\n");
+	return true;
+}
+
+bool yo::CppTranspiler::emitInstruction(size_t offset)
+{
+	const uint8_t* code = &chunk.data[offset];
+	OPCode operation = genericOperation((OPCode)*code);
+	int depth = depths[offset];
+	int line = chunk.lines[offset];
+
+	switch (operation)
+	{
+		case OPCode::OP_RETURN:
+			emit("\treturn true;\n");
+			return true;
+
+		case OPCode::OP_CONSTANT:
+			emit("\ts%d = constants[%d];\n", depth, code[1]);
+			return true;
+
+		case OPCode::OP_NONE:
+			emit("\ts%d = Value();\n", depth);
+			return true;
+
+		case OPCode::OP_TRUE:
+		case OPCode::OP_FALSE:
+			emit("\ts%d = Value(%s);\n", depth, operation == OPCode::OP_TRUE ? "true" : "false");
+			return true;
+
+		case OPCode::OP_NEGATE:
+			emit("\tif (!runtime.negate(s%d, %d)) return false;\n", depth - 1, line);
+			return true;
+
+		case OPCode::OP_ADD:
+		case OPCode::OP_SUB:
+		case OPCode::OP_MULT:
+		case OPCode::OP_DIV:
+		case OPCode::OP_MOD:
+		case OPCode::OP_BIT_AND:
+		case OPCode::OP_BIT_OR:
+		case OPCode::OP_LESS:
+		case OPCode::OP_GREATER:
+			emit("\tif (!runtime.binary<OPCode::%s>(s%d, s%d, %d)) return false;\n", binaryTemplate(operation), depth - 2, depth - 1, line);
+			return true;
+
+		case OPCode::OP_EQUAL:
+			emit("\ts%d = Value(s%d == s%d);\n", depth - 2, depth - 2, depth - 1);
+			return true;
+
+		case OPCode::OP_NOT:
+			emit("\ts%d = Value(Runtime::isFalse(s%d));\n", depth - 1, depth - 1);
+			return true;
+
+		case OPCode::OP_PRINT:
+			emit("\truntime.print(s%d);\n", depth - 1);
+			return true;
+
+		case OPCode::OP_POP_BACK:
+			return true;
+
+		case OPCode::OP_DEFINE_GLOBAL_VAR:
+			emit("\tif (!runtime.defineGlobal(constants[%d], s%d, %d)) return false;\n", code[1], depth - 1, line);
+			return true;
+
+		case OPCode::OP_GET_GLOBAL_VAR:
+			emit("\tif (!runtime.getGlobal(g%zu, constants[%d], s%d, %d)) return false;\n", offset, code[1], depth, line);
+			return true;
+
+		case OPCode::OP_SET_GLOBAL_VAR:
+			emit("\tif (!runtime.setGlobal(g%zu, constants[%d], s%d, %d)) return false;\n", offset, code[1], depth - 1, line);
+			return true;
+
+		case OPCode::OP_GET_LOCAL_VAR:
+			emit("\ts%d = s%d;\n", depth, code[1]);
+			return true;
+
+		case OPCode::OP_SET_LOCAL_VAR:
+			if (code[1] != depth - 1)
+				emit("\ts%d = s%d;\n", code[1], depth - 1);
+			return true;
+
+		case OPCode::OP_INCREMENT_LOCAL:
+			emit("\tif (!runtime.binary<OPCode::OP_ADD>(s%d, constants[%d], %d)) return false;\n", code[1], code[2], line);
+			return true;
+
+		case OPCode::OP_JUMP:
+		case OPCode::OP_LOOP:
+			emit("\tgoto L%zu;\n", jumpTarget(offset));
+			return true;
+
+		case OPCode::OP_JUMP_IF_FALSE:
+			emit("\tif (Runtime::isFalse(s%d)) goto L%zu;\n", depth - 1, jumpTarget(offset));
+			return true;
+
+		case OPCode::OP_GET_INDEX:
+			emit("\tif (!runtime.getIndex(s%d, s%d, %d)) return false;\n", depth - 2, depth - 1, line);
+			return true;
+
+		case OPCode::OP_SET_INDEX:
+			emit("\tif (!runtime.setIndex(s%d, s%d, s%d, %d)) return false;\n", depth - 3, depth - 2, depth - 1, line);
+			return true;
+
+		case OPCode::OP_DELETE_INDEX:
+			emit("\tif (!runtime.deleteIndex(s%d, s%d, %d)) return false;\n", depth - 2, depth - 1, line);
+			return true;
+
+		case OPCode::OP_FOR_IN:
+			emit("\tif (!runtime.forIn(s%d, s%d, s%d, s%d, %d)) return false;\n", code[1], code[1] + 1, code[1] + 2, depth, line);
+			return true;
+
+		case OPCode::OP_BUILD_MAP:
+		case OPCode::OP_BUILD_ARRAY:
+		case OPCode::OP_CALL:
+		{
+			int count = operation == OPCode::OP_BUILD_MAP ? code[1] * 2 : code[1];
+			int first = operation == OPCode::OP_CALL ? depth - count - 1 : depth - count;
+			int base = operation == OPCode::OP_CALL ? first + 1 : first;
+
+			if (count > 0)
+			{
+				emit("\t{\n\t\tValue values[] = {");
+				for (int i = 0; i < count; ++i)
+					emit(i ? ", s%d" : " s%d", base + i);
+				emit(" };\n\t\t");
+			}
+			else
+				emit("\t{\n\t\tValue* values = nullptr;\n\t\t");
+
+			if (operation == OPCode::OP_BUILD_MAP)
+				emit("runtime.buildMap(s%d, values, %d);\n", first, code[1]);
+			else if (operation == OPCode::OP_BUILD_ARRAY)
+				emit("if (!runtime.buildArray(s%d, values, %d, %d)) return false;\n", first, code[1], line);
+			else
+				emit("if (!runtime.call(s%d, values, %d, %d)) return false;\n", first, code[1], line);
+
+			emit("\t}\n");
+			return true;
+		}
+
+		default:
+			return fail("chunk contains an instruction the transpiler does not support");
+	}
+}
+
+size_t yo::CppTranspiler::jumpTarget(size_t offset) const
+{
+	const uint8_t* code = &chunk.data[offset];
+	uint16_t jump = (uint16_t)((code[1] << 8) | code[2]);
+
+	return *code == (uint8_t)OPCode::OP_LOOP ? offset + 3 - jump : offset + 3 + jump;
+}
\ No newline at end of file
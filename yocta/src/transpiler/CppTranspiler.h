@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "Chunk.h"
+
+namespace yo
+{
+	class CppTranspiler
+	{
+	public:
+		CppTranspiler(const Chunk& chunk, const char* sourceName);
+
+	public:
+		bool transpile(std::string& output);
+
+		const char* errorMessage() const { return error; }
+
+	private:
+		bool computeDepths();
+
+		bool emitConstants();
+
+		bool emitInstruction(size_t offset);
+
+		size_t jumpTarget(size_t offset) const;
+
+	private:
+		template<typename... Values>
+		void emit(const char* format, Values... value)
+		{
+			char line[512];
+			snprintf(line, sizeof(line), format, value...);
+			output.append(line);
+		}
+
+		bool fail(const char* message)
+		{
+			error = message;
+			return false;
+		}
+
+	private:
+		const Chunk& chunk;
+		const char* sourceName;
+
+		std::vector<int> depths;
+		std::vector<bool> targets;
+		int maxDepth = 0;
+
+		std::string output;
+		const char* error = nullptr;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "IsolatePool.h"
+
+yo::IsolatePool::IsolatePool(size_t threadCount, Configure configure)
+	: configure(std::move(configure))
+{
+	for (size_t i = 0; i < threadCount; ++i)
+		workers.emplace_back(&IsolatePool::work, this);
+}
+
+yo::IsolatePool::~IsolatePool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+
+	jobAvailable.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+void yo::IsolatePool::submit(const std::shared_ptr<const Program>& program, const std::vector<Binding>& bindings)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back({ program, bindings });
+		++pending;
+	}
+
+	jobAvailable.notify_one();
+}
+
+void yo::IsolatePool::wait()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	jobsFinished.wait(lock, [this] { return pending == 0; });
+}
+
+void yo::IsolatePool::work()
+{
+	// The VM is created on the worker so its heap and JIT code never leave the thread.
+	VirtualMachine vm;
+
+	if (configure)
+		configure(vm);
+
+	while (true)
+	{
+		Job job;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+
+			if (jobs.empty())
+				return;
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		VirtualMachine::InterpretResult result = vm.execute(job.program, job.bindings);
+
+		while (result == VirtualMachine::InterpretResult::YIELDED)
+			result = vm.resume();
+
+		(result == VirtualMachine::InterpretResult::OK ? completedCount : failedCount).fetch_add(1, std::memory_order_relaxed);
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (--pending == 0)
+			jobsFinished.notify_all();
+	}
+}
\ No newline at end of file
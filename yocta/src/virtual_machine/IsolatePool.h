@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "VirtualMachine.h"
+
+namespace yo
+{
+	// Every worker owns one VirtualMachine (stack, globals, heap); only the
+	// compiled Program is shared between them, and it is never written to.
+	class IsolatePool
+	{
+	public:
+		using Configure = std::function<void(VirtualMachine&)>;
+
+	public:
+		IsolatePool(size_t threadCount, Configure configure = {});
+
+		~IsolatePool();
+
+		IsolatePool(const IsolatePool&) = delete;
+		IsolatePool& operator=(const IsolatePool&) = delete;
+
+	public:
+		void submit(const std::shared_ptr<const Program>& program, const std::vector<Binding>& bindings = {});
+
+		void wait();
+
+	public:
+		size_t threadCount() const { return workers.size(); }
+
+		size_t completed() const { return completedCount.load(std::memory_order_relaxed); }
+
+		size_t failed() const { return failedCount.load(std::memory_order_relaxed); }
+
+	private:
+		void work();
+
+	private:
+		struct Job
+		{
+		public:
+			std::shared_ptr<const Program> program;
+			std::vector<Binding> bindings;
+		};
+
+	private:
+		Configure configure;
+		std::vector<std::thread> workers;
+
+		std::mutex mutex;
+		std::condition_variable jobAvailable;
+		std::condition_variable jobsFinished;
+		std::deque<Job> jobs;
+		size_t pending = 0;
+		bool stopping = false;
+
+		std::atomic<size_t> completedCount = 0;
+		std::atomic<size_t> failedCount = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdio>
+
+#include "YoctaObject.h"
+
+namespace yo
+{
+	struct AsyncRequest;
+
+	class NativeHost
+	{
+	public:
+		virtual ~NativeHost() = default;
+
+	public:
+		virtual void defineNative(const char* name, NativeFunction function) = 0;
+
+		// Parks the calling script until the request completes; hosts without an event loop refuse.
+		virtual bool await(const AsyncRequest& request);
+
+		template<typename... Values>
+		bool nativeError(const char* format, Values... value)
+		{
+			char message[256];
+			snprintf(message, sizeof(message), format, value...);
+
+			reportError(message);
+			return false;
+		}
+
+	protected:
+		virtual void reportError(const char* message) = 0;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,274 @@
+#include "Natives.h"
+#include "NumericKernels.h"
+#include "NativeHost.h"
+#include "Table.h"
+#include "Coroutine.h"
+
+namespace
+{
+	using namespace yo;
+
+	NumericArrayObject* asArray(const Value& value)
+	{
+		if (!isObjectType(value, ObjectType::NUMERIC_ARRAY))
+			return nullptr;
+
+		return static_cast<NumericArrayObject*>(std::get<YoctaObject*>(value.variantValue));
+	}
+
+	// Arrays are filled as soon as they are made, so one the memory limit cannot hold is refused up front.
+	bool fitsMemory(int64_t length)
+	{
+		MemoryAccount* account = MemoryAccount::active();
+		return !account || ((uint64_t)length <= SIZE_MAX / sizeof(double) && account->fits((size_t)length * sizeof(double)));
+	}
+
+	bool expectArguments(NativeHost& host, int argCount, int expected, const char* name)
+	{
+		if (argCount == expected)
+			return true;
+
+		return host.nativeError("%s() expects %d argument(s) but got %d.\n", name, expected, argCount);
+	}
+
+	bool arrayArgument(NativeHost& host, const Value& value, const char* name, NumericArrayObject*& array)
+	{
+		array = asArray(value);
+		if (array)
+			return true;
+
+		return host.nativeError("%s() expects a numeric array.\n", name);
+	}
+
+	bool pairArguments(NativeHost& host, int argCount, Value* args, const char* name, NumericArrayObject*& x, NumericArrayObject*& y)
+	{
+		if (!expectArguments(host, argCount, 2, name))
+			return false;
+
+		if (!arrayArgument(host, args[0], name, x) || !arrayArgument(host, args[1], name, y))
+			return false;
+
+		if (x->data.size() != y->data.size())
+			return host.nativeError("%s() expects arrays of the same length.\n", name);
+
+		return true;
+	}
+
+	bool lengthNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		if (!expectArguments(host, argCount, 1, "len"))
+			return false;
+
+		if (isString(args[0]))
+			result = { (int64_t)stringLength(args[0]) };
+		else if (isObjectType(args[0], ObjectType::MAP))
+			result = { (int64_t)getMapObject(args[0])->table.size() };
+		else if (NumericArrayObject* array = asArray(args[0]))
+			result = { (int64_t)array->data.size() };
+		else
+			return host.nativeError("len() expects a string, map or array.\n");
+
+		return true;
+	}
+
+	bool doneNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		if (!expectArguments(host, argCount, 1, "done"))
+			return false;
+
+		if (!isObjectType(args[0], ObjectType::COROUTINE))
+			return host.nativeError("done() expects a coroutine.\n");
+
+		result = { getCoroutineObject(args[0])->state == CoroutineState::DEAD };
+		return true;
+	}
+
+	bool arrayNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		if (argCount < 1 || argCount > 2)
+			return host.nativeError("array() expects a length and an optional fill value.\n");
+
+		if (args[0].type != ValueType::VT_INTEGER || std::get<int64_t>(args[0].variantValue) < 0)
+			return host.nativeError("array() expects a non-negative integer length.\n");
+
+		if (argCount == 2 && !isNumber(args[1]))
+			return host.nativeError("array() expects a numeric fill value.\n");
+
+		if (!fitsMemory(std::get<int64_t>(args[0].variantValue)))
+			return host.nativeError("array() of %lld elements exceeds the memory limit.\n", (long long)std::get<int64_t>(args[0].variantValue));
+
+		double fill = argCount == 2 ? toDouble(args[1]) : 0.0;
+		result = { (YoctaObject*)createObject<NumericArrayObject>((size_t)std::get<int64_t>(args[0].variantValue), fill) };
+
+		return true;
+	}
+
+	bool rangeNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		if (!expectArguments(host, argCount, 1, "range"))
+			return false;
+
+		if (args[0].type != ValueType::VT_INTEGER || std::get<int64_t>(args[0].variantValue) < 0)
+			return host.nativeError("range() expects a non-negative integer length.\n");
+
+		if (!fitsMemory(std::get<int64_t>(args[0].variantValue)))
+			return host.nativeError("range() of %lld elements exceeds the memory limit.\n", (long long)std::get<int64_t>(args[0].variantValue));
+
+		NumericArrayObject* array = createObject<NumericArrayObject>((size_t)std::get<int64_t>(args[0].variantValue));
+		for (size_t i = 0; i < array->data.size(); ++i)
+			array->data[i] = (double)i;
+
+		result = { (YoctaObject*)array };
+		return true;
+	}
+
+	template <double (*NumericKernels::* Kernel)(const double*, size_t)>
+	bool reduceNative(NativeHost& host, int argCount, Value* args, Value& result, const char* name)
+	{
+		NumericArrayObject* x = nullptr;
+		if (!expectArguments(host, argCount, 1, name) || !arrayArgument(host, args[0], name, x))
+			return false;
+
+		result = { (numericKernels().*Kernel)(x->data.data(), x->data.size()) };
+		return true;
+	}
+
+	template <void (*NumericKernels::* Kernel)(const double*, const double*, double*, size_t)>
+	bool elementwiseNative(NativeHost& host, int argCount, Value* args, Value& result, const char* name)
+	{
+		NumericArrayObject* x = nullptr;
+		NumericArrayObject* y = nullptr;
+
+		if (!pairArguments(host, argCount, args, name, x, y))
+			return false;
+
+		NumericArrayObject* out = createObject<NumericArrayObject>(x->data.size());
+		(numericKernels().*Kernel)(x->data.data(), y->data.data(), out->data.data(), out->data.size());
+
+		result = { (YoctaObject*)out };
+		return true;
+	}
+
+	bool sumNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		return reduceNative<&NumericKernels::sum>(host, argCount, args, result, "sum");
+	}
+
+	bool minNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		return reduceNative<&NumericKernels::min>(host, argCount, args, result, "min");
+	}
+
+	bool maxNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		return reduceNative<&NumericKernels::max>(host, argCount, args, result, "max");
+	}
+
+	bool dotNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		NumericArrayObject* x = nullptr;
+		NumericArrayObject* y = nullptr;
+
+		if (!pairArguments(host, argCount, args, "dot", x, y))
+			return false;
+
+		result = { numericKernels().dot(x->data.data(), y->data.data(), x->data.size()) };
+		return true;
+	}
+
+	bool axpyNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		NumericArrayObject* x = nullptr;
+		NumericArrayObject* y = nullptr;
+
+		if (!expectArguments(host, argCount, 3, "axpy"))
+			return false;
+
+		if (!isNumber(args[0]))
+			return host.nativeError("axpy() expects a numeric factor.\n");
+
+		if (!pairArguments(host, 2, args + 1, "axpy", x, y))
+			return false;
+
+		numericKernels().axpy(toDouble(args[0]), x->data.data(), y->data.data(), y->data.size());
+
+		result = args[2];
+		return true;
+	}
+
+	bool scaleNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		NumericArrayObject* x = nullptr;
+
+		if (!expectArguments(host, argCount, 2, "scale") || !arrayArgument(host, args[0], "scale", x))
+			return false;
+
+		if (!isNumber(args[1]))
+			return host.nativeError("scale() expects a numeric factor.\n");
+
+		NumericArrayObject* out = createObject<NumericArrayObject>(x->data.size());
+		numericKernels().scale(toDouble(args[1]), x->data.data(), out->data.data(), out->data.size());
+
+		result = { (YoctaObject*)out };
+		return true;
+	}
+
+	bool addNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		return elementwiseNative<&NumericKernels::add>(host, argCount, args, result, "add");
+	}
+
+	bool subNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		return elementwiseNative<&NumericKernels::sub>(host, argCount, args, result, "sub");
+	}
+
+	bool multNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		return elementwiseNative<&NumericKernels::mult>(host, argCount, args, result, "mul");
+	}
+
+	bool divNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		return elementwiseNative<&NumericKernels::div>(host, argCount, args, result, "div");
+	}
+
+	bool lessNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		return elementwiseNative<&NumericKernels::less>(host, argCount, args, result, "less");
+	}
+
+	bool greaterNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		return elementwiseNative<&NumericKernels::greater>(host, argCount, args, result, "greater");
+	}
+
+	bool equalNative(NativeHost& host, int argCount, Value* args, Value& result)
+	{
+		return elementwiseNative<&NumericKernels::equal>(host, argCount, args, result, "equal");
+	}
+}
+
+void yo::registerNumericNatives(NativeHost& host)
+{
+	host.defineNative("len", lengthNative);
+	host.defineNative("array", arrayNative);
+	host.defineNative("range", rangeNative);
+	host.defineNative("done", doneNative);
+
+	host.defineNative("sum", sumNative);
+	host.defineNative("min", minNative);
+	host.defineNative("max", maxNative);
+	host.defineNative("dot", dotNative);
+	host.defineNative("axpy", axpyNative);
+	host.defineNative("scale", scaleNative);
+
+	host.defineNative("add", addNative);
+	host.defineNative("sub", subNative);
+	host.defineNative("mul", multNative);
+	host.defineNative("div", divNative);
+
+	host.defineNative("less", lessNative);
+	host.defineNative("greater", greaterNative);
+	host.defineNative("equal", equalNative);
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+#pragma once
+
+namespace yo
+{
+	class NativeHost;
+
+	void registerNumericNatives(NativeHost& host);
+}
\ No newline at end of file
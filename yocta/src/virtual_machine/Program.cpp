@@ -0,0 +1,21 @@
+#include "Program.h"
+#include "Compiler.h"
+
+std::shared_ptr<const yo::Program> yo::Program::compile(const char* source)
+{
+	std::shared_ptr<Program> program = std::make_shared<Program>();
+	Compiler compiler;
+
+	if (!compiler.compile(source, &program->programChunk))
+		return nullptr;
+
+	return program;
+}
+
+std::shared_ptr<const yo::Program> yo::Program::assemble(Chunk chunk)
+{
+	std::shared_ptr<Program> program = std::make_shared<Program>();
+	program->programChunk = std::move(chunk);
+
+	return program;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+#include <memory>
+
+#include "Chunk.h"
+
+namespace yo
+{
+	struct Binding
+	{
+	public:
+		const char* name;
+		Value value;
+	};
+
+	class Program
+	{
+	public:
+		static std::shared_ptr<const Program> compile(const char* source);
+
+		// Wraps bytecode built without the compiler, such as the hand-assembled chunks of the dispatch benchmarks.
+		static std::shared_ptr<const Program> assemble(Chunk chunk);
+
+	public:
+		const Chunk& chunk() const { return programChunk; }
+
+	private:
+		Chunk programChunk;
+	};
+}
\ No newline at end of file
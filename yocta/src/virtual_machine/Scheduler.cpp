@@ -0,0 +1,34 @@
+#include "Scheduler.h"
+
+yo::Scheduler::Scheduler(uint64_t timeSlice)
+	: timeSlice(timeSlice)
+{
+}
+
+size_t yo::Scheduler::spawn(VirtualMachine& vm, const std::shared_ptr<const Program>& program, const std::vector<Binding>& bindings)
+{
+	vm.setBudget(timeSlice);
+
+	tasks.push_back({ &vm, program, bindings, InterpretResult::YIELDED, false });
+	ready.push_back(tasks.size() - 1);
+
+	return tasks.size() - 1;
+}
+
+void yo::Scheduler::run()
+{
+	// Each task runs until its fuel is spent, then goes to the back of the queue.
+	while (!ready.empty())
+	{
+		Task& task = tasks[ready.front()];
+		size_t index = ready.front();
+		ready.pop_front();
+
+		task.result = task.started ? task.vm->resume() : task.vm->execute(task.program, task.bindings);
+		task.started = true;
+		++sliceCount;
+
+		if (task.result == InterpretResult::YIELDED)
+			ready.push_back(index);
+	}
+}
\ No newline at end of file
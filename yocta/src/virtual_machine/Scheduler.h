@@ -0,0 +1,46 @@
+#pragma once
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "VirtualMachine.h"
+
+namespace yo
+{
+	class Scheduler
+	{
+	public:
+		using InterpretResult = VirtualMachine::InterpretResult;
+
+	public:
+		explicit Scheduler(uint64_t timeSlice);
+
+	public:
+		size_t spawn(VirtualMachine& vm, const std::shared_ptr<const Program>& program, const std::vector<Binding>& bindings = {});
+
+		void run();
+
+	public:
+		InterpretResult result(size_t task) const { return tasks[task].result; }
+
+		size_t slices() const { return sliceCount; }
+
+	private:
+		struct Task
+		{
+		public:
+			VirtualMachine* vm;
+			std::shared_ptr<const Program> program;
+			std::vector<Binding> bindings;
+			InterpretResult result;
+			bool started;
+		};
+
+	private:
+		uint64_t timeSlice;
+		size_t sliceCount = 0;
+
+		std::vector<Task> tasks;
+		std::deque<size_t> ready;
+	};
+}
\ No newline at end of file
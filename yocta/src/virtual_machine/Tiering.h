@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+
+namespace yo
+{
+	enum class Tier
+	{
+		INTERPRETER = 0,
+		OPTIMIZED
+	};
+
+	struct TieringOptions
+	{
+	public:
+		bool enabled = false;
+		bool trace = false;
+
+		uint32_t invocationThreshold = 2;
+		uint32_t backEdgeThreshold = 1000;
+	};
+
+	inline const char* translateTier(Tier tier)
+	{
+		switch (tier)
+		{
+			case Tier::INTERPRETER:
+				return "interpreter";
+
+			case Tier::OPTIMIZED:
+				return "optimized bytecode";
+		}
+
+		return "unknown";
+	}
+}
\ No newline at end of file
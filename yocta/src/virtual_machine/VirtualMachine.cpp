@@ -1,14 +1,94 @@
 #include "VirtualMachine.h"
+#include "Natives.h"
+#include "BytecodeOptimizer.h"
 
-yo::VirtualMachine::InterpretResult yo::VirtualMachine::run()
+yo::VirtualMachine::VirtualMachine()
+	: vmStack(AccountingAllocator<Value>(&vmHeap.account()))
+{
+	registerNumericNatives(*this);
+}
+
+yo::VirtualMachine::InterpretResult yo::VirtualMachine::run(Chunk& chunk)
 {
 	#ifdef DEBUG_VM_INSTRUCTION_TRACE
 	printf("-=-= Disassembly : Interpreter =-=-\n");
 	#endif
 
-	auto chunk = compiler.currentChunk;
-	IP = chunk->data.data();
+	Heap::Scope scope(&vmHeap);
+
+	vmChunk = &chunk;
+	vmStack.clear();
+	vmTier = Tier::INTERPRETER;
+	IP = vmChunk->data.data();
+
+	if (tieringOptions.enabled && ++vmChunk->profile.invocations >= tieringOptions.invocationThreshold)
+		tierUp("invocations");
+
+	profiling = tieringOptions.enabled && vmTier == Tier::INTERPRETER;
+
+	if (jitEnabled && jitChunk != vmChunk)
+	{
+		jitCode = BaselineJit::compile(*this, *vmChunk);
+		jitChunk = vmChunk;
+	}
+
+	fuel = fuelBudget ? (int64_t)fuelBudget : INT64_MAX;
+
+	int64_t exit = jitCode ? jitCode->enter(*this, 0) : 0;
+	if (exit == JitCode::RETURNED)
+		return finishRun(InterpretResult::OK);
+
+	IP = vmChunk->data.data() + exit;
+
+	if (tracingEnabled)
+		tracingJit = std::make_unique<TracingJit>(*this, *vmChunk, vmTraceStatistics);
+
+	if (vmStatistics)
+		vmStatistics->breakSequence();
+
+	InterpretResult result = vmStatistics ? dispatch<true>() : dispatch<false>();
+	return result == InterpretResult::YIELDED || result == InterpretResult::WAITING ? result : finishRun(result);
+}
+
+yo::VirtualMachine::InterpretResult yo::VirtualMachine::resume()
+{
+	if (!suspended())
+		return InterpretResult::OK;
+
+	Heap::Scope scope(&vmHeap);
+	fuel = fuelBudget ? (int64_t)fuelBudget : INT64_MAX;
+
+	InterpretResult result = vmStatistics ? dispatch<true>() : dispatch<false>();
+	return result == InterpretResult::YIELDED || result == InterpretResult::WAITING ? result : finishRun(result);
+}
+
+yo::VirtualMachine::InterpretResult yo::VirtualMachine::finishRun(InterpretResult result)
+{
+	// Coroutines left mid-run by an error hand their resumers' context back before the VM is reset.
+	while (activeCoroutine)
+		leaveCoroutine(CoroutineState::DEAD, {});
+
+	#ifdef DEBUG_QUICKENING_TRACE
+	Disassembler::disassemble(*vmChunk, "Quickened");
+	#endif
+
+	// Native code stays valid for as long as this VM keeps executing the same program copy.
+	if (vmChunk != &programChunk && vmChunk != programChunk.profile.optimized.get())
+	{
+		jitCode.reset();
+		jitChunk = nullptr;
+	}
+
+	tracingJit.reset();
+	vmChunk = nullptr;
+	awaiting = false;
+	scopedGlobals = false;
+	return result;
+}
 
+template<bool COUNTING>
+yo::VirtualMachine::InterpretResult yo::VirtualMachine::dispatch()
+{
 	while (true)
 	{
 		#ifdef DEBUG_VM_STACK_TRACE
@@ -24,52 +104,257 @@ yo::VirtualMachine::InterpretResult yo::VirtualMachine::run()
 		#endif
 
 		#ifdef DEBUG_VM_INSTRUCTION_TRACE
-		Disassembler::disassembleInstruction(*compiler.currentChunk, (int)(IP - chunk->data.data()));
+		Disassembler::disassembleInstruction(*vmChunk, (int)(IP - vmChunk->data.data()));
 		#endif
 
-		uint8_t instruction = 0;
+		if (tracingJit && tracingJit->recording() && !activeCoroutine)
+			tracingJit->record(IP - vmChunk->data.data());
 
-		switch (instruction = readByte())
+		uint8_t instruction = readByte();
+
+		if constexpr (COUNTING)
+			vmStatistics->count(instruction);
+
+		switch (instruction)
 		{
 			case (uint8_t)OPCode::OP_RETURN: 
-				return InterpretResult::OK;
+			{
+				if (!activeCoroutine)
+					return InterpretResult::OK;
+
+				leaveCoroutine(CoroutineState::DEAD, {});
+				break;
+			}
 
 			case (uint8_t)OPCode::OP_CONSTANT: 
 			{
-				Value constant = readConstant(*chunk);
+				Value constant = readConstant(*vmChunk);
 				vmStack.push_back(constant);
 				break;
 			}
 
 			case (uint8_t)OPCode::OP_NEGATE: 
 			{
-				Value back = vmStack.back();
-				vmStack.pop_back();
-				vmStack.push_back(-back);
+				if (!isNumber(vmStack.back()))
+				{
+					runtimeError("Operand must be a number.\n");
+					return InterpretResult::RUNTIME_ERROR;
+				}
+
+				vmStack.back() = -vmStack.back();
 				break;
 			}
 
 			case (uint8_t)OPCode::OP_ADD: 
 			{
-				binaryOperation(OPCode::OP_ADD);
+				Value& a = vmStack[vmStack.size() - 2];
+				const Value& b = vmStack.back();
+
+				if (profiling)
+					profileOperands(a, b);
+
+				if (quickeningEnabled)
+					quickenOperation((OPCode)instruction, a, b);
+
+				if (a.type == ValueType::VT_INTEGER && b.type == ValueType::VT_INTEGER)
+				{
+					int64_t& x = std::get<int64_t>(a.variantValue);
+					int64_t result;
+
+					if (checkedAdd(x, std::get<int64_t>(b.variantValue), result))
+					{
+						x = result;
+						vmStack.pop_back();
+						break;
+					}
+				}
+
+				if (!binaryOperation(OPCode::OP_ADD))
+					return InterpretResult::RUNTIME_ERROR;
 				break;
 			}
 
 			case (uint8_t)OPCode::OP_SUB: 
 			{
-				binaryOperation(OPCode::OP_SUB);
+				Value& a = vmStack[vmStack.size() - 2];
+				const Value& b = vmStack.back();
+
+				if (profiling)
+					profileOperands(a, b);
+
+				if (quickeningEnabled)
+					quickenOperation((OPCode)instruction, a, b);
+
+				if (a.type == ValueType::VT_INTEGER && b.type == ValueType::VT_INTEGER)
+				{
+					int64_t& x = std::get<int64_t>(a.variantValue);
+					int64_t result;
+
+					if (checkedSub(x, std::get<int64_t>(b.variantValue), result))
+					{
+						x = result;
+						vmStack.pop_back();
+						break;
+					}
+				}
+
+				if (!binaryOperation(OPCode::OP_SUB))
+					return InterpretResult::RUNTIME_ERROR;
 				break;
 			}
 
 			case (uint8_t)OPCode::OP_MULT: 
 			{
-				binaryOperation(OPCode::OP_MULT);
+				Value& a = vmStack[vmStack.size() - 2];
+				const Value& b = vmStack.back();
+
+				if (profiling)
+					profileOperands(a, b);
+
+				if (quickeningEnabled)
+					quickenOperation((OPCode)instruction, a, b);
+
+				if (a.type == ValueType::VT_INTEGER && b.type == ValueType::VT_INTEGER)
+				{
+					int64_t& x = std::get<int64_t>(a.variantValue);
+					int64_t result;
+
+					if (checkedMult(x, std::get<int64_t>(b.variantValue), result))
+					{
+						x = result;
+						vmStack.pop_back();
+						break;
+					}
+				}
+
+				if (!binaryOperation(OPCode::OP_MULT))
+					return InterpretResult::RUNTIME_ERROR;
 				break;
 			}
 
 			case (uint8_t)OPCode::OP_DIV: 
 			{
-				binaryOperation(OPCode::OP_DIV);
+				if (quickeningEnabled)
+					quickenOperation(OPCode::OP_DIV, vmStack[vmStack.size() - 2], vmStack.back());
+
+				if (!binaryOperation(OPCode::OP_DIV))
+					return InterpretResult::RUNTIME_ERROR;
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_MOD: 
+			case (uint8_t)OPCode::OP_BIT_AND: 
+			case (uint8_t)OPCode::OP_BIT_OR: 
+			{
+				if (!binaryOperation((OPCode)instruction))
+					return InterpretResult::RUNTIME_ERROR;
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_GREATER:
+			{
+				if (profiling)
+					profileOperands(vmStack[vmStack.size() - 2], vmStack.back());
+
+				if (quickeningEnabled)
+					quickenOperation(OPCode::OP_GREATER, vmStack[vmStack.size() - 2], vmStack.back());
+
+				if (!binaryOperation(OPCode::OP_GREATER))
+					return InterpretResult::RUNTIME_ERROR;
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_ADD_INT:
+			case (uint8_t)OPCode::OP_SUB_INT:
+			case (uint8_t)OPCode::OP_MULT_INT:
+			case (uint8_t)OPCode::OP_LESS_INT:
+			case (uint8_t)OPCode::OP_GREATER_INT:
+			{
+				if (vmStack[vmStack.size() - 2].type != ValueType::VT_INTEGER || vmStack.back().type != ValueType::VT_INTEGER)
+					deoptimize(IP - vmChunk->data.data() - 1);
+
+				// Overflow keeps the integer form; only a type change deoptimizes the site.
+				else if (integerOperation((OPCode)instruction))
+					break;
+
+				if (!binaryOperation(genericOperation((OPCode)instruction)))
+					return InterpretResult::RUNTIME_ERROR;
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_ADD_NUM_NUM:
+			case (uint8_t)OPCode::OP_SUB_NUM_NUM:
+			case (uint8_t)OPCode::OP_MULT_NUM_NUM:
+			case (uint8_t)OPCode::OP_DIV_NUM_NUM:
+			case (uint8_t)OPCode::OP_LESS_NUM_NUM:
+			case (uint8_t)OPCode::OP_GREATER_NUM_NUM:
+			{
+				Value& a = vmStack[vmStack.size() - 2];
+				const Value& b = vmStack.back();
+
+				if (a.type != ValueType::VT_NUMERIC || b.type != ValueType::VT_NUMERIC)
+				{
+					deoptimize(IP - vmChunk->data.data() - 1);
+
+					if (!binaryOperation(genericOperation((OPCode)instruction)))
+						return InterpretResult::RUNTIME_ERROR;
+					break;
+				}
+
+				double x = std::get<double>(a.variantValue);
+				double y = std::get<double>(b.variantValue);
+
+				switch ((OPCode)instruction)
+				{
+				case OPCode::OP_ADD_NUM_NUM: a = { x + y }; break;
+				case OPCode::OP_SUB_NUM_NUM: a = { x - y }; break;
+				case OPCode::OP_MULT_NUM_NUM: a = { x * y }; break;
+				case OPCode::OP_DIV_NUM_NUM: a = { x / y }; break;
+				case OPCode::OP_LESS_NUM_NUM: a = { x < y }; break;
+				case OPCode::OP_GREATER_NUM_NUM: a = { x > y }; break;
+				default: break;
+				}
+
+				vmStack.pop_back();
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_ADD_STR_STR:
+			{
+				if (!isString(vmStack[vmStack.size() - 2]) || !isString(vmStack.back()))
+					deoptimize(IP - vmChunk->data.data() - 1);
+
+				if (!binaryOperation(OPCode::OP_ADD))
+					return InterpretResult::RUNTIME_ERROR;
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_INCREMENT_LOCAL:
+			{
+				uint8_t slot = readByte();
+				const Value& step = vmChunk->constantPool[readByte()];
+				Value& local = vmStack[slot];
+
+				if (local.type == ValueType::VT_INTEGER && step.type == ValueType::VT_INTEGER)
+				{
+					int64_t& x = std::get<int64_t>(local.variantValue);
+					int64_t result;
+
+					if (checkedAdd(x, std::get<int64_t>(step.variantValue), result))
+					{
+						x = result;
+						break;
+					}
+				}
+
+				vmStack.push_back(vmStack[slot]);
+				vmStack.push_back(step);
+
+				if (!binaryOperation(OPCode::OP_ADD))
+					return InterpretResult::RUNTIME_ERROR;
+
+				vmStack[slot] = vmStack.back();
+				vmStack.pop_back();
 				break;
 			}
 
@@ -112,14 +397,26 @@ yo::VirtualMachine::InterpretResult yo::VirtualMachine::run()
 				break;
 			}
 
-			case (uint8_t)OPCode::OP_GREATER:
-			{
-				binaryOperation(OPCode::OP_GREATER);
-				break;
-			}
 			case (uint8_t)OPCode::OP_LESS:
 			{
-				binaryOperation(OPCode::OP_LESS);
+				Value& a = vmStack[vmStack.size() - 2];
+				const Value& b = vmStack.back();
+
+				if (profiling)
+					profileOperands(a, b);
+
+				if (quickeningEnabled)
+					quickenOperation((OPCode)instruction, a, b);
+
+				if (a.type == ValueType::VT_INTEGER && b.type == ValueType::VT_INTEGER)
+				{
+					a = { std::get<int64_t>(a.variantValue) < std::get<int64_t>(b.variantValue) };
+					vmStack.pop_back();
+					break;
+				}
+
+				if (!binaryOperation(OPCode::OP_LESS))
+					return InterpretResult::RUNTIME_ERROR;
 				break;
 			}
 
@@ -139,44 +436,80 @@ yo::VirtualMachine::InterpretResult yo::VirtualMachine::run()
 
 			case (uint8_t)OPCode::OP_DEFINE_GLOBAL_VAR:
 			{
-				StringObject* name = getStringObject(chunk->constantPool[readByte()]);
-				if (vmGlobals.find(name->data) != vmGlobals.end())
+				const Value& name = vmChunk->constantPool[readByte()];
+				if (!defineGlobal(name, vmStack.back()))
 				{
-					runtimeError("Variable '%s' is already defined.\n", name->data.c_str());
+					std::string_view str = stringView(name);
+					runtimeError("Variable '%.*s' is already defined.\n", (int)str.size(), str.data());
 					return InterpretResult::RUNTIME_ERROR;
 				}
 
-				vmGlobals[name->data] = vmStack.back();
 				vmStack.pop_back();
 				break;
 			}
 
 			case (uint8_t)OPCode::OP_GET_GLOBAL_VAR:
 			{
-				StringObject* name = getStringObject(chunk->constantPool[readByte()]);
-				Value value;
+				const Value& name = vmChunk->constantPool[readByte()];
+				Value* value = findGlobal(name);
 
-				if (vmGlobals.find(name->data) == vmGlobals.end())
+				if (!value)
 				{
-					runtimeError("Undefined variable '%s'.\n", name->data.c_str());
+					undefinedGlobal(name);
 					return InterpretResult::RUNTIME_ERROR;
 				}
 
-				vmStack.push_back(vmGlobals[name->data]);
+				if (quickeningEnabled)
+					quickenGlobal(OPCode::OP_GET_GLOBAL_CACHED, value);
+
+				vmStack.push_back(*value);
 				break;
 			}
 
 			case (uint8_t)OPCode::OP_SET_GLOBAL_VAR:
 			{
-				StringObject* name = getStringObject(chunk->constantPool[readByte()]);
+				const Value& name = vmChunk->constantPool[readByte()];
+				Value* value = findGlobal(name);
 
-				if (vmGlobals.find(name->data) == vmGlobals.end())
+				if (!value)
 				{
-					runtimeError("Undefined variable '%s'.\n", name->data.c_str());
+					undefinedGlobal(name);
 					return InterpretResult::RUNTIME_ERROR;
 				}
 
-				vmGlobals[name->data] = vmStack.back();
+				if (quickeningEnabled)
+					quickenGlobal(OPCode::OP_SET_GLOBAL_CACHED, value);
+
+				*value = vmStack.back();
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_GET_GLOBAL_CACHED:
+			case (uint8_t)OPCode::OP_SET_GLOBAL_CACHED:
+			{
+				size_t offset = IP - vmChunk->data.data() - 1;
+				const Value& name = vmChunk->constantPool[readByte()];
+				GlobalCache& cache = vmChunk->profile.globalCaches[offset];
+
+				if (cache.version != vmGlobals.version())
+				{
+					Value* value = findGlobal(name);
+
+					if (!value)
+					{
+						deoptimize(offset);
+
+						undefinedGlobal(name);
+						return InterpretResult::RUNTIME_ERROR;
+					}
+
+					cache = { value, vmGlobals.version() };
+				}
+
+				if (instruction == (uint8_t)OPCode::OP_GET_GLOBAL_CACHED)
+					vmStack.push_back(*cache.value);
+				else
+					*cache.value = vmStack.back();
 				break;
 			}
 
@@ -204,7 +537,12 @@ yo::VirtualMachine::InterpretResult yo::VirtualMachine::run()
 			case (uint8_t)OPCode::OP_JUMP_IF_FALSE:
 			{
 				uint16_t offset = readShort();
-				if (isBooleanFalse(peek(0)))
+				bool taken = isBooleanFalse(peek(0));
+
+				if constexpr (COUNTING)
+					vmStatistics->branch(taken);
+
+				if (taken)
 					IP += offset;
 				break;
 			}
@@ -213,6 +551,130 @@ yo::VirtualMachine::InterpretResult yo::VirtualMachine::run()
 			{
 				uint16_t offset = readShort();
 				IP -= offset;
+
+				// Everything live is on the stack, in the globals or in a coroutine here, so the heap can move objects.
+				if (vmHeap.collectionRequested() && !collectGarbage())
+					return InterpretResult::RUNTIME_ERROR;
+
+				// Back-edges and calls are the only places a script can run unbounded, so only they pay for fuel.
+				if ((fuel -= offset) <= 0)
+					return InterpretResult::YIELDED;
+
+				// Coroutine bodies belong to the shared program, so they are never profiled, traced or compiled.
+				if (activeCoroutine)
+					break;
+
+				if (profiling && ++vmChunk->profile.backEdges >= tieringOptions.backEdgeThreshold)
+					tierUp("back-edges");
+
+				if (tracingJit)
+					tracingJit->backEdge(IP - vmChunk->data.data());
+
+				// Native code bailed out inside this loop; go back in at the loop header.
+				else if (jitCode)
+				{
+					int64_t exit = jitCode->enter(*this, IP - vmChunk->data.data());
+					if (exit == JitCode::RETURNED)
+						return InterpretResult::OK;
+
+					IP = vmChunk->data.data() + exit;
+				}
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_BUILD_MAP:
+			{
+				uint8_t entries = readByte();
+				MapObject* map = createObject<MapObject>();
+
+				size_t first = vmStack.size() - entries * 2;
+				for (size_t i = first; i < vmStack.size(); i += 2)
+					map->table.insert(vmStack[i], vmStack[i + 1]);
+
+				vmHeap.chargeGrowth(map, 0, map->table.footprint());
+
+				vmStack.resize(first);
+				vmStack.push_back({ (YoctaObject*)map });
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_BUILD_ARRAY:
+			{
+				uint8_t elements = readByte();
+				NumericArrayObject* array = createObject<NumericArrayObject>(elements);
+
+				size_t first = vmStack.size() - elements;
+				for (size_t i = 0; i < elements; ++i)
+				{
+					if (!isNumber(vmStack[first + i]))
+					{
+						runtimeError("Array elements must be numbers.\n");
+						return InterpretResult::RUNTIME_ERROR;
+					}
+
+					array->data[i] = toDouble(vmStack[first + i]);
+				}
+
+				vmStack.resize(first);
+				vmStack.push_back({ (YoctaObject*)array });
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_CALL:
+			{
+				if (!callOperation(readByte()))
+					return InterpretResult::RUNTIME_ERROR;
+
+				if (vmHeap.collectionRequested() && !collectGarbage())
+					return InterpretResult::RUNTIME_ERROR;
+
+				if (awaiting)
+					return InterpretResult::WAITING;
+
+				if ((fuel -= CALL_FUEL) <= 0)
+					return InterpretResult::YIELDED;
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_COROUTINE:
+			{
+				PrototypeObject* prototype = static_cast<PrototypeObject*>(std::get<YoctaObject*>(readConstant(*vmChunk).variantValue));
+				vmStack.push_back({ (YoctaObject*)createObject<CoroutineObject>(prototype) });
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_YIELD:
+			{
+				Value value = vmStack.back();
+				vmStack.pop_back();
+
+				leaveCoroutine(CoroutineState::SUSPENDED, value);
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_RESUME:
+			{
+				if (!resumeCoroutine())
+					return InterpretResult::RUNTIME_ERROR;
+
+				if ((fuel -= CALL_FUEL) <= 0)
+					return InterpretResult::YIELDED;
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_GET_INDEX:
+			case (uint8_t)OPCode::OP_SET_INDEX:
+			case (uint8_t)OPCode::OP_DELETE_INDEX:
+			{
+				if (!indexOperation((OPCode)instruction))
+					return InterpretResult::RUNTIME_ERROR;
+				break;
+			}
+
+			case (uint8_t)OPCode::OP_FOR_IN:
+			{
+				if (!forInOperation(readByte()))
+					return InterpretResult::RUNTIME_ERROR;
 				break;
 			}
 		}
@@ -221,18 +683,339 @@ yo::VirtualMachine::InterpretResult yo::VirtualMachine::run()
 
 yo::VirtualMachine::InterpretResult yo::VirtualMachine::interpret(const char* source)
 {
-	Chunk chunk;
+	if (suspended())
+		finishRun(InterpretResult::OK);
+
+	scriptChunk.clear();
 
-	if (!compiler.compile(source, &chunk))
+	if (!compiler.compile(source, &scriptChunk))
 	{
-		chunk.clear();
+		scriptChunk.clear();
 		return InterpretResult::COMPILE_ERROR;
 	}
 
-	InterpretResult result = run();
+	chargeStorage();
 
-	chunk.clear();
-	return result;
+	return run(scriptChunk);
+}
+
+yo::VirtualMachine::InterpretResult yo::VirtualMachine::execute(const std::shared_ptr<const Program>& program, const std::vector<Binding>& bindings)
+{
+	if (suspended())
+		finishRun(InterpretResult::OK);
+
+	// Quickening and profiling write to the chunk, so each VM runs its own copy of the shared program.
+	if (loadedProgram != program)
+	{
+		jitCode.reset();
+		jitChunk = nullptr;
+
+		programChunk = program->chunk();
+		loadedProgram = program;
+
+		chargeStorage();
+	}
+
+	for (const Value& name : executionGlobals)
+		vmGlobals.erase(name);
+
+	executionGlobals.clear();
+	scopedGlobals = true;
+
+	// The names are globals of this VM, so they are allocated where its collector traces and accounts for them.
+	Heap::Scope scope(&vmHeap);
+
+	for (const Binding& binding : bindings)
+	{
+		if (!defineGlobal(Value::makeString(binding.name, strlen(binding.name)), binding.value))
+		{
+			printf("Binding '%s' is already defined.\n", binding.name);
+			scopedGlobals = false;
+			return InterpretResult::RUNTIME_ERROR;
+		}
+	}
+
+	return run(programChunk);
+}
+
+bool yo::VirtualMachine::defineGlobal(const Value& name, const Value& value)
+{
+	// A global still waiting in an image is defined already.
+	if (restoredSnapshot && !vmGlobals.find(name) && restoredSnapshot->findGlobal(stringView(name)))
+		return false;
+
+	if (!vmGlobals.insert(name, value))
+		return false;
+
+	if (scopedGlobals)
+		executionGlobals.push_back(name);
+
+	chargeStorage();
+	return true;
+}
+
+yo::Value* yo::VirtualMachine::findGlobal(const Value& name)
+{
+	if (Value* value = vmGlobals.find(name))
+		return value;
+
+	const GlobalRecord* global = restoredSnapshot ? restoredSnapshot->findGlobal(stringView(name)) : nullptr;
+	if (!global)
+		return nullptr;
+
+	Value value;
+	if (!restoredSnapshot->restore(global->value, restoredObjects, vmGlobals, value))
+		return nullptr;
+
+	// Restored globals belong to the VM like the ones its scripts define, so they outlive any scoped execution.
+	vmGlobals.insert(name, value);
+	chargeStorage();
+
+	return vmGlobals.find(name);
+}
+
+void yo::VirtualMachine::undefinedGlobal(const Value& name)
+{
+	std::string_view str = stringView(name);
+
+	// findGlobal only misses a global the image holds when the records behind it are damaged.
+	if (restoredSnapshot && restoredSnapshot->findGlobal(str))
+		runtimeError("Cannot load snapshot: the records of '%.*s' are damaged.\n", (int)str.size(), str.data());
+	else
+		runtimeError("Undefined variable '%.*s'.\n", (int)str.size(), str.data());
+}
+
+void yo::VirtualMachine::restore(const std::shared_ptr<const Snapshot>& snapshot)
+{
+	restoredSnapshot = snapshot;
+	restoredObjects.clear();
+}
+
+void yo::VirtualMachine::snapshot(SnapshotWriter& writer)
+{
+	Heap::Scope scope(&vmHeap);
+
+	// What the image this VM started from still holds goes into the new one too.
+	if (restoredSnapshot)
+	{
+		for (size_t index = 0; index < restoredSnapshot->globalCount(); ++index)
+			findGlobal(restoredSnapshot->globalName(index));
+	}
+
+	writer.addPrototypes(scriptChunk);
+	writer.addPrototypes(programChunk);
+
+	for (const auto& [offset, object] : restoredObjects)
+	{
+		if (object->type == ObjectType::PROTOTYPE)
+			writer.addPrototype(static_cast<PrototypeObject*>(object));
+	}
+
+	for (int index = vmGlobals.next(0); index != -1; index = vmGlobals.next(index + 1))
+	{
+		const Table::Entry& entry = vmGlobals.entryAt(index);
+
+		// Natives are defined by every VM, and bindings by whoever executes the next program.
+		if (isObjectType(entry.value, ObjectType::NATIVE) && stringView(entry.key) == static_cast<NativeObject*>(std::get<YoctaObject*>(entry.value.variantValue))->name)
+			continue;
+
+		if (std::find(executionGlobals.begin(), executionGlobals.end(), entry.key) != executionGlobals.end())
+			continue;
+
+		writer.addGlobal(entry.key, entry.value);
+	}
+}
+
+void yo::VirtualMachine::traceRoots(Heap& heap)
+{
+	for (Value& value : vmStack)
+		heap.trace(value);
+
+	for (int index = vmGlobals.next(0); index != -1; index = vmGlobals.next(index + 1))
+	{
+		Table::Entry& entry = vmGlobals.entryAt(index);
+
+		heap.trace(entry.key);
+		heap.trace(entry.value);
+	}
+
+	for (Value& name : executionGlobals)
+		heap.trace(name);
+
+	for (auto& [offset, object] : restoredObjects)
+		heap.trace(object);
+
+	// The running coroutine holds its resumer's stack, and each caller holds the stack below that.
+	heap.trace(activeCoroutine);
+}
+
+bool yo::VirtualMachine::collectGarbage()
+{
+	vmHeap.collect(*this);
+
+	if (!vmHeap.account().exceeded())
+		return true;
+
+	// Old objects that died since the last major cycle still count against the limit, so they go first.
+	vmHeap.collectFully(*this);
+
+	if (!vmHeap.account().exceeded())
+		return true;
+
+	runtimeError("Memory limit of %zu bytes exceeded.\n", vmHeap.account().limit());
+	return false;
+}
+
+void yo::VirtualMachine::chargeStorage()
+{
+	// Chunks and globals belong to the VM rather than its heap, so they are charged by footprint whenever they change.
+	size_t bytes = scriptChunk.footprint() + programChunk.footprint() + vmGlobals.footprint() + executionGlobals.capacity() * sizeof(Value);
+
+	vmHeap.account().charge(bytes);
+	vmHeap.account().release(storageBytes);
+	storageBytes = bytes;
+}
+
+bool yo::VirtualMachine::tierUp(const char* reason)
+{
+	ChunkProfile& profile = vmChunk->profile;
+
+	if (!profile.optimized && !profile.optimizationFailed)
+	{
+		// Folded constants belong to the chunk, not to this run, so they must not land in the heap.
+		Heap::Scope detached(nullptr);
+
+		BytecodeOptimizer optimizer(*vmChunk);
+		profile.optimized = optimizer.optimize(profile.offsetMap);
+		profile.optimizationFailed = !profile.optimized;
+
+		if (tieringOptions.trace)
+		{
+			const OptimizerStatistics& statistics = optimizer.statistics();
+			fprintf(stderr, "[tier] optimized chunk: %zu folded, %zu fused, %zu specialized, %zu jumps threaded%s\n",
+				statistics.folded, statistics.fused, statistics.specialized, statistics.threaded, profile.optimized ? "" : " (failed)");
+		}
+
+		chargeStorage();
+	}
+
+	// Loop headers and the chunk entry are always instruction boundaries in both tiers, so the stack carries over as is.
+	size_t offset = IP - vmChunk->data.data();
+	int32_t target = profile.optimized ? profile.offsetMap[offset] : -1;
+
+	if (target < 0)
+	{
+		profiling = false;
+		return false;
+	}
+
+	if (tieringOptions.trace)
+	{
+		fprintf(stderr, "[tier] %s -> %s at offset %zu -> %d after %u invocations, %u back-edges (%s)\n",
+			translateTier(vmTier), translateTier(Tier::OPTIMIZED), offset, target, profile.invocations, profile.backEdges, reason);
+	}
+
+	vmChunk = profile.optimized.get();
+	vmTier = Tier::OPTIMIZED;
+	profiling = false;
+
+	IP = vmChunk->data.data() + target;
+
+	if (tracingJit)
+		tracingJit = std::make_unique<TracingJit>(*this, *vmChunk, vmTraceStatistics);
+
+	if (jitCode && jitChunk != vmChunk)
+	{
+		jitCode = BaselineJit::compile(*this, *vmChunk);
+		jitChunk = vmChunk;
+	}
+
+	return true;
+}
+
+void yo::VirtualMachine::profileOperands(const Value& a, const Value& b)
+{
+	if (activeCoroutine)
+		return;
+
+	std::vector<uint8_t>& types = vmChunk->profile.operandTypes;
+	if (types.empty())
+		types.resize(vmChunk->data.size(), 0);
+
+	bool integers = a.type == ValueType::VT_INTEGER && b.type == ValueType::VT_INTEGER;
+	types[IP - vmChunk->data.data() - 1] |= integers ? ChunkProfile::SEEN_INTEGERS : ChunkProfile::SEEN_OTHER;
+}
+
+void yo::VirtualMachine::quickenOperation(OPCode operation, const Value& a, const Value& b)
+{
+	if (activeCoroutine)
+		return;
+
+	size_t offset = IP - vmChunk->data.data() - 1;
+	const std::vector<uint8_t>& deoptimizations = vmChunk->profile.deoptimizations;
+
+	if (!deoptimizations.empty() && deoptimizations[offset] >= ChunkProfile::MAX_DEOPTIMIZATIONS)
+		return;
+
+	OPCode quickened = operation;
+
+	if (a.type == ValueType::VT_INTEGER && b.type == ValueType::VT_INTEGER)
+	{
+		switch (operation)
+		{
+		case OPCode::OP_ADD: quickened = OPCode::OP_ADD_INT; break;
+		case OPCode::OP_SUB: quickened = OPCode::OP_SUB_INT; break;
+		case OPCode::OP_MULT: quickened = OPCode::OP_MULT_INT; break;
+		case OPCode::OP_LESS: quickened = OPCode::OP_LESS_INT; break;
+		case OPCode::OP_GREATER: quickened = OPCode::OP_GREATER_INT; break;
+		default: break;
+		}
+	}
+	else if (a.type == ValueType::VT_NUMERIC && b.type == ValueType::VT_NUMERIC)
+	{
+		switch (operation)
+		{
+		case OPCode::OP_ADD: quickened = OPCode::OP_ADD_NUM_NUM; break;
+		case OPCode::OP_SUB: quickened = OPCode::OP_SUB_NUM_NUM; break;
+		case OPCode::OP_MULT: quickened = OPCode::OP_MULT_NUM_NUM; break;
+		case OPCode::OP_DIV: quickened = OPCode::OP_DIV_NUM_NUM; break;
+		case OPCode::OP_LESS: quickened = OPCode::OP_LESS_NUM_NUM; break;
+		case OPCode::OP_GREATER: quickened = OPCode::OP_GREATER_NUM_NUM; break;
+		default: break;
+		}
+	}
+	else if (operation == OPCode::OP_ADD && isString(a) && isString(b))
+		quickened = OPCode::OP_ADD_STR_STR;
+
+	vmChunk->data[offset] = (uint8_t)quickened;
+}
+
+void yo::VirtualMachine::quickenGlobal(OPCode operation, Value* value)
+{
+	if (activeCoroutine)
+		return;
+
+	size_t offset = IP - vmChunk->data.data() - 2;
+	ChunkProfile& profile = vmChunk->profile;
+
+	if (!profile.deoptimizations.empty() && profile.deoptimizations[offset] >= ChunkProfile::MAX_DEOPTIMIZATIONS)
+		return;
+
+	if (profile.globalCaches.empty())
+		profile.globalCaches.resize(vmChunk->data.size());
+
+	profile.globalCaches[offset] = { value, vmGlobals.version() };
+	vmChunk->data[offset] = (uint8_t)operation;
+}
+
+void yo::VirtualMachine::deoptimize(size_t offset)
+{
+	std::vector<uint8_t>& deoptimizations = vmChunk->profile.deoptimizations;
+	if (deoptimizations.empty())
+		deoptimizations.resize(vmChunk->data.size(), 0);
+
+	++deoptimizations[offset];
+	vmChunk->data[offset] = (uint8_t)genericOperation((OPCode)vmChunk->data[offset]);
 }
 
 const yo::Value& yo::VirtualMachine::peek(unsigned int distance) const
@@ -253,50 +1036,401 @@ yo::Value yo::VirtualMachine::readConstant(const Chunk& chunk)
 	return chunk.constantPool[readByte()];
 }
 
-uint8_t yo::VirtualMachine::readShort()
+uint16_t yo::VirtualMachine::readShort()
 {
 	return IP += 2, (uint16_t)((IP[-2] << 8) | IP[-1]);
 }
 
-void yo::VirtualMachine::binaryOperation(OPCode operation)
+bool yo::VirtualMachine::binaryOperation(OPCode operation)
 {
-	Value b = vmStack.back();
-	vmStack.pop_back();
+	const Value& a = vmStack[vmStack.size() - 2];
+	const Value& b = vmStack.back();
 
-	Value a = vmStack.back();
-	vmStack.pop_back();
+	if (operation == OPCode::OP_ADD && isString(a) && isString(b))
+	{
+		// Ropes make the concatenation itself cheap, so a string the limit could never hold is refused up front.
+		if (!vmHeap.account().fits(stringLength(a) + stringLength(b)))
+		{
+			runtimeError("Memory limit of %zu bytes exceeded.\n", vmHeap.account().limit());
+			return false;
+		}
+
+		if (stringLength(a) + stringLength(b) > StringObject::MAX_LENGTH)
+		{
+			runtimeError("Strings cannot be longer than %zu characters.\n", StringObject::MAX_LENGTH);
+			return false;
+		}
+	}
+	else if (operation == OPCode::OP_BIT_AND || operation == OPCode::OP_BIT_OR)
+	{
+		if (a.type != ValueType::VT_INTEGER || b.type != ValueType::VT_INTEGER)
+		{
+			runtimeError("Operands must be integers.\n");
+			return false;
+		}
+	}
+	else if (!isNumber(a) || !isNumber(b))
+	{
+		runtimeError(operation == OPCode::OP_ADD ? "Operands must be two numbers or two strings.\n" : "Operands must be numbers.\n");
+		return false;
+	}
+	else if ((operation == OPCode::OP_DIV || operation == OPCode::OP_MOD) &&
+		a.type == ValueType::VT_INTEGER && b.type == ValueType::VT_INTEGER && std::get<int64_t>(b.variantValue) == 0)
+	{
+		runtimeError("Division by zero.\n");
+		return false;
+	}
+
+	Value result;
 
 	switch (operation)
 	{
 	case OPCode::OP_ADD:
-	{
-		vmStack.push_back(a + b);
+		result = a + b;
 		break;
-	}
 
 	case OPCode::OP_SUB:
-		vmStack.push_back(a - b);
+		result = a - b;
 		break;
 
 	case OPCode::OP_MULT:
-		vmStack.push_back(a * b);
+		result = a * b;
 		break;
 
 	case OPCode::OP_DIV:
-		vmStack.push_back(a / b);
+		result = a / b;
+		break;
+
+	case OPCode::OP_MOD:
+		result = a % b;
+		break;
+
+	case OPCode::OP_BIT_AND:
+		result = a & b;
+		break;
+
+	case OPCode::OP_BIT_OR:
+		result = a | b;
 		break;
 
 	case OPCode::OP_GREATER:
-		vmStack.push_back({ a > b });
+		result = { a > b };
 		break;
 
 	case OPCode::OP_LESS:
-		vmStack.push_back({ a < b });
+		result = { a < b };
+		break;
+
+	default:
 		break;
 	}
+
+	vmStack.pop_back();
+	vmStack.back() = result;
+
+	return true;
 }
 
-inline bool yo::VirtualMachine::isBooleanFalse(const Value& value) const
+bool yo::VirtualMachine::integerOperation(OPCode operation)
 {
-	return value.type == ValueType::VT_NONE || (value.type == ValueType::VT_BOOL && !std::get<bool>(value.variantValue));
+	Value& a = vmStack[vmStack.size() - 2];
+	const Value& b = vmStack.back();
+
+	if (a.type != ValueType::VT_INTEGER || b.type != ValueType::VT_INTEGER)
+		return false;
+
+	int64_t x = std::get<int64_t>(a.variantValue);
+	int64_t y = std::get<int64_t>(b.variantValue);
+	int64_t result;
+
+	switch (operation)
+	{
+	case OPCode::OP_ADD_INT:
+		if (!checkedAdd(x, y, result))
+			return false;
+		a = { result };
+		break;
+
+	case OPCode::OP_SUB_INT:
+		if (!checkedSub(x, y, result))
+			return false;
+		a = { result };
+		break;
+
+	case OPCode::OP_MULT_INT:
+		if (!checkedMult(x, y, result))
+			return false;
+		a = { result };
+		break;
+
+	case OPCode::OP_LESS_INT:
+		a = { x < y };
+		break;
+
+	case OPCode::OP_GREATER_INT:
+		a = { x > y };
+		break;
+
+	default:
+		break;
+	}
+
+	vmStack.pop_back();
+	return true;
+}
+
+bool yo::VirtualMachine::indexOperation(OPCode operation)
+{
+	size_t containerSlot = vmStack.size() - (operation == OPCode::OP_SET_INDEX ? 3 : 2);
+	Value container = vmStack[containerSlot];
+	const Value& key = vmStack[containerSlot + 1];
+
+	if (isObjectType(container, ObjectType::NUMERIC_ARRAY))
+	{
+		std::vector<double>& data = static_cast<NumericArrayObject*>(std::get<YoctaObject*>(container.variantValue))->data;
+
+		if (key.type != ValueType::VT_INTEGER)
+		{
+			runtimeError("Array indices must be integers.\n");
+			return false;
+		}
+
+		int64_t index = std::get<int64_t>(key.variantValue);
+		if (index < 0 || (uint64_t)index >= data.size())
+		{
+			runtimeError("Array index %lld out of range.\n", (long long)index);
+			return false;
+		}
+
+		switch (operation)
+		{
+		case OPCode::OP_GET_INDEX:
+			vmStack[containerSlot] = { data[index] };
+			break;
+
+		case OPCode::OP_SET_INDEX:
+			if (!isNumber(vmStack.back()))
+			{
+				runtimeError("Array elements must be numbers.\n");
+				return false;
+			}
+
+			data[index] = toDouble(vmStack.back());
+			vmStack[containerSlot] = vmStack.back();
+			break;
+
+		case OPCode::OP_DELETE_INDEX:
+			runtimeError("Array elements cannot be deleted.\n");
+			return false;
+
+		default:
+			break;
+		}
+
+		vmStack.resize(containerSlot + 1);
+		return true;
+	}
+
+	if (!isObjectType(container, ObjectType::MAP))
+	{
+		runtimeError("Only maps and arrays can be indexed.\n");
+		return false;
+	}
+
+	Table& table = getMapObject(container)->table;
+
+	switch (operation)
+	{
+	case OPCode::OP_GET_INDEX:
+	{
+		Value* value = table.find(key);
+		vmStack[containerSlot] = value ? *value : Value();
+		break;
+	}
+
+	case OPCode::OP_SET_INDEX:
+	{
+		YoctaObject* map = std::get<YoctaObject*>(container.variantValue);
+		size_t footprint = table.footprint();
+
+		table.insert(key, vmStack.back());
+		vmHeap.chargeGrowth(map, footprint, table.footprint());
+
+		if (map->generation != Generation::YOUNG && (isYoung(key) || isYoung(vmStack.back())))
+			vmHeap.rememberEntry(map, key, table.slot(key), table.rehashes());
+
+		if (vmHeap.marking())
+		{
+			vmHeap.shade(key);
+			vmHeap.shade(vmStack.back());
+		}
+
+		vmStack[containerSlot] = vmStack.back();
+		break;
+	}
+
+	case OPCode::OP_DELETE_INDEX:
+		table.erase(key);
+		break;
+
+	default:
+		break;
+	}
+
+	vmStack.resize(operation == OPCode::OP_DELETE_INDEX ? containerSlot : containerSlot + 1);
+	return true;
 }
+
+bool yo::VirtualMachine::callOperation(uint8_t argCount)
+{
+	size_t calleeSlot = vmStack.size() - argCount - 1;
+	const Value& callee = vmStack[calleeSlot];
+
+	if (!isObjectType(callee, ObjectType::NATIVE))
+	{
+		runtimeError("Only functions can be called.\n");
+		return false;
+	}
+
+	NativeObject* native = static_cast<NativeObject*>(std::get<YoctaObject*>(callee.variantValue));
+	Value result;
+
+	if (!native->function(*this, argCount, vmStack.data() + calleeSlot + 1, result))
+		return false;
+
+	vmStack.resize(calleeSlot);
+	vmStack.push_back(result);
+
+	return true;
+}
+
+void yo::VirtualMachine::defineNative(const char* name, NativeFunction function)
+{
+	vmGlobals.insert(Value::makeString(name, strlen(name)), { (YoctaObject*)createObject<NativeObject>(name, function) });
+	chargeStorage();
+}
+
+void yo::VirtualMachine::enableStatistics(bool enabled)
+{
+	if (!enabled)
+		vmStatistics.reset();
+
+	else if (!vmStatistics)
+		vmStatistics = std::make_unique<OpcodeStatistics>();
+}
+
+void yo::VirtualMachine::enableAsync(bool enabled)
+{
+	if (enabled && !asyncEnabled)
+		registerAsyncNatives(*this);
+
+	asyncEnabled = enabled;
+}
+
+bool yo::VirtualMachine::await(const AsyncRequest& request)
+{
+	if (!asyncEnabled)
+		return NativeHost::await(request);
+
+	asyncRequest = request;
+	awaiting = true;
+	return true;
+}
+
+yo::VirtualMachine::InterpretResult yo::VirtualMachine::complete(const Value& result)
+{
+	// The parked call left a placeholder on the stack; the completion value takes its place.
+	vmStack.back() = result;
+	awaiting = false;
+
+	return resume();
+}
+
+bool yo::VirtualMachine::forInOperation(uint8_t keySlot)
+{
+	const Value& container = vmStack[keySlot + 1];
+
+	if (!isObjectType(container, ObjectType::MAP))
+	{
+		runtimeError("Only maps can be iterated.\n");
+		return false;
+	}
+
+	const Table& table = getMapObject(container)->table;
+	const Value& position = vmStack[keySlot + 2];
+
+	// Only compiled code touches the position, so just a coroutine restored from a damaged image can hold another one.
+	if (position.type != ValueType::VT_INTEGER || std::get<int64_t>(position.variantValue) < 0 ||
+		std::get<int64_t>(position.variantValue) > (int64_t)table.capacity())
+	{
+		runtimeError("Cannot load snapshot: a for-in position is damaged.\n");
+		return false;
+	}
+
+	int index = table.next((int)std::get<int64_t>(position.variantValue));
+
+	if (index == -1)
+	{
+		vmStack.push_back({ false });
+		return true;
+	}
+
+	vmStack[keySlot] = table.entryAt(index).key;
+	vmStack[keySlot + 2] = { (int64_t)(index + 1) };
+	vmStack.push_back({ true });
+
+	return true;
+}
+
+bool yo::VirtualMachine::resumeCoroutine()
+{
+	if (!isObjectType(vmStack.back(), ObjectType::COROUTINE))
+	{
+		runtimeError("Only coroutines can be resumed.\n");
+		return false;
+	}
+
+	CoroutineObject* coroutine = getCoroutineObject(vmStack.back());
+
+	if (coroutine->state != CoroutineState::SUSPENDED)
+	{
+		runtimeError(coroutine->state == CoroutineState::DEAD ? "Cannot resume a finished coroutine.\n" : "Cannot resume a running coroutine.\n");
+		return false;
+	}
+
+	vmStack.pop_back();
+
+	coroutine->caller = activeCoroutine;
+	coroutine->state = CoroutineState::RUNNING;
+	activeCoroutine = coroutine;
+
+	switchContext(coroutine);
+	return true;
+}
+
+void yo::VirtualMachine::leaveCoroutine(CoroutineState state, const Value& result)
+{
+	CoroutineObject* coroutine = activeCoroutine;
+	switchContext(coroutine);
+
+	coroutine->state = state;
+	activeCoroutine = coroutine->caller;
+	coroutine->caller = nullptr;
+
+	// Nothing can run a finished coroutine again, so its stack is released right away.
+	if (state == CoroutineState::DEAD)
+		ValueStack().swap(coroutine->stack);
+
+	vmStack.push_back(result);
+}
+
+void yo::VirtualMachine::switchContext(CoroutineObject* coroutine)
+{
+	std::swap(IP, coroutine->IP);
+	std::swap(vmChunk, coroutine->chunk);
+	vmStack.swap(coroutine->stack);
+
+	// The stack it now holds may point into the nursery.
+	if (coroutine->generation != Generation::YOUNG)
+		vmHeap.remember(coroutine);
+}
\ No newline at end of file
@@ -1,20 +1,125 @@
 #pragma once
 #include "Disassembler.h"
 #include "Compiler.h"
+#include "Table.h"
 #include "Debug.h"
+#include "BaselineJit.h"
+#include "TracingJit.h"
+#include "Tiering.h"
+#include "NativeHost.h"
+#include "Program.h"
+#include "Coroutine.h"
+#include "AsyncIo.h"
+#include "Heap.h"
+#include "Snapshot.h"
+#include "OpcodeStatistics.h"
 
 namespace yo
 {
-	class VirtualMachine
+	class VirtualMachine : public NativeHost, private HeapRoots
 	{
+		friend class BaselineJit;
+		friend class JitCode;
+		friend class TracingJit;
+		friend class SamplingProfiler;
+
 	public:
-		enum class InterpretResult { OK = 0, COMPILE_ERROR, RUNTIME_ERROR };
+		enum class InterpretResult { OK = 0, COMPILE_ERROR, RUNTIME_ERROR, YIELDED, WAITING };
+
+		static constexpr int64_t CALL_FUEL = 8;
 
 	public:
-		InterpretResult run();
+		VirtualMachine();
 
+	public:
 		InterpretResult interpret(const char* source);
 
+		InterpretResult execute(const std::shared_ptr<const Program>& program, const std::vector<Binding>& bindings = {});
+
+		InterpretResult resume();
+
+		bool suspended() const { return vmChunk != nullptr; }
+
+		void setBudget(uint64_t budget) { fuelBudget = budget; }
+
+		void enableJit(bool enabled) { jitEnabled = enabled; }
+
+		void enableTracing(bool enabled) { tracingEnabled = enabled; }
+
+		const TraceStatistics& traceStatistics() const { return vmTraceStatistics; }
+
+		void setTieringOptions(const TieringOptions& options) { tieringOptions = options; }
+
+		void enableQuickening(bool enabled) { quickeningEnabled = enabled; }
+
+		// Runs the counting instantiation of the dispatch loop; without it the loop carries no counting code at all.
+		void enableStatistics(bool enabled);
+
+		const OpcodeStatistics* statistics() const { return vmStatistics.get(); }
+
+		Heap& heap() { return vmHeap; }
+
+	public:
+		// Caps the bytes this VM may hold; going over it is a runtime error. Zero removes the limit.
+		void setMemoryLimit(size_t bytes) { vmHeap.account().setLimit(bytes); }
+
+		size_t memoryUsage() const { return vmHeap.account().current(); }
+
+		size_t peakMemoryUsage() const { return vmHeap.account().peak(); }
+
+	public:
+		// Starts from the globals of an image; each is restored the first time a script looks it up.
+		void restore(const std::shared_ptr<const Snapshot>& snapshot);
+
+		// Hands the globals this VM holds, and the prototypes its chunks hold, to a writer.
+		void snapshot(SnapshotWriter& writer);
+
+	public:
+		void enableAsync(bool enabled);
+
+		const AsyncRequest& pendingRequest() const { return asyncRequest; }
+
+		InterpretResult complete(const Value& result);
+
+	public:
+		void defineNative(const char* name, NativeFunction function) override;
+
+		bool await(const AsyncRequest& request) override;
+
+	protected:
+		void reportError(const char* message) override { runtimeError("%s", message); }
+
+	private:
+		InterpretResult run(Chunk& chunk);
+
+		InterpretResult finishRun(InterpretResult result);
+
+		template<bool COUNTING>
+		InterpretResult dispatch();
+
+		bool defineGlobal(const Value& name, const Value& value);
+
+		Value* findGlobal(const Value& name);
+
+		void undefinedGlobal(const Value& name);
+
+		bool tierUp(const char* reason);
+
+		void traceRoots(Heap& heap) override;
+
+		bool collectGarbage();
+
+		void chargeStorage();
+
+		void profileOperands(const Value& a, const Value& b);
+
+	private:
+		void quickenOperation(OPCode operation, const Value& a, const Value& b);
+
+		void quickenGlobal(OPCode operation, Value* value);
+
+		void deoptimize(size_t offset);
+
 	private:
 		const Value& peek(unsigned int distance) const;
 
@@ -22,10 +127,25 @@ namespace yo
 
 		Value readConstant(const Chunk& chunk);
 
-		uint8_t readShort();
+		uint16_t readShort();
 
 	private:
-		void binaryOperation(OPCode operation);
+		bool binaryOperation(OPCode operation);
+
+		bool integerOperation(OPCode operation);
+
+		bool indexOperation(OPCode operation);
+
+		bool forInOperation(uint8_t keySlot);
+
+		bool callOperation(uint8_t argCount);
+
+	private:
+		bool resumeCoroutine();
+
+		void leaveCoroutine(CoroutineState state, const Value& result);
+
+		void switchContext(CoroutineObject* coroutine);
 
 	private:
 		template <class X>
@@ -40,18 +160,65 @@ namespace yo
 		template<typename... Values>
 		void runtimeError(const char* format, Values... value)
 		{
-			size_t instruction = IP - &compiler.currentChunk->data.front() - 1;
-			printf("<Line %d> ", compiler.currentChunk->lines[instruction]);
+			size_t instruction = IP - &vmChunk->data.front() - 1;
+			printf("<Line %d> ", vmChunk->lines[instruction]);
 			printf(format, forward_or_transform(value)...);
 		}
 
 	private:
-		inline bool isBooleanFalse(const Value& value) const;
+		bool isBooleanFalse(const Value& value) const
+		{
+			return value.type == ValueType::VT_NONE || (value.type == ValueType::VT_BOOL && !std::get<bool>(value.variantValue));
+		}
+
+	private:
+		// Declared first so it outlives everything charged to its memory account.
+		Heap vmHeap;
 
 	private:
 		const uint8_t* IP = nullptr;
-		std::vector<Value> vmStack;
-		std::unordered_map<std::string, Value> vmGlobals;
+		Chunk* vmChunk = nullptr;
+		ValueStack vmStack;
+		Table vmGlobals;
+		CoroutineObject* activeCoroutine = nullptr;
+
+	private:
+		Chunk scriptChunk;
+		std::shared_ptr<const Program> loadedProgram;
+		Chunk programChunk;
+		std::vector<Value> executionGlobals;
+		bool scopedGlobals = false;
+		size_t storageBytes = 0;
+
+	private:
+		std::shared_ptr<const Snapshot> restoredSnapshot;
+		RestoredObjects restoredObjects;
+
+	private:
+		uint64_t fuelBudget = 0;
+		int64_t fuel = INT64_MAX;
+
+	private:
+		bool jitEnabled = false;
+		std::unique_ptr<JitCode> jitCode;
+		const Chunk* jitChunk = nullptr;
+
+	private:
+		bool tracingEnabled = false;
+		std::unique_ptr<TracingJit> tracingJit;
+		TraceStatistics vmTraceStatistics;
+
+	private:
+		TieringOptions tieringOptions;
+		Tier vmTier = Tier::INTERPRETER;
+		bool profiling = false;
+		bool quickeningEnabled = true;
+		std::unique_ptr<OpcodeStatistics> vmStatistics;
+
+	private:
+		bool asyncEnabled = false;
+		bool awaiting = false;
+		AsyncRequest asyncRequest;
 
 	private:
 		Compiler compiler;
@@ -0,0 +1,20 @@
+# Runs one script with the interpreter options in MODE and compares what it prints with the expected output.
+# Invoked by ctest as: cmake -DYOCTA=<interpreter> -DMODE=<options> -DSCRIPT=<file.yo> -DEXPECTED=<file.out> -P RunScript.cmake
+separate_arguments(options UNIX_COMMAND "${MODE}")
+
+execute_process(
+	COMMAND "${YOCTA}" ${options} "${SCRIPT}"
+	OUTPUT_VARIABLE output
+	ERROR_VARIABLE errors
+	RESULT_VARIABLE result
+)
+
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "'${SCRIPT}' with options '${MODE}' exited with '${result}'.\n${errors}")
+endif()
+
+file(READ "${EXPECTED}" expected)
+
+if(NOT output STREQUAL expected)
+	message(FATAL_ERROR "'${SCRIPT}' with options '${MODE}' printed:\n${output}\nExpected:\n${expected}")
+endif()
\ No newline at end of file
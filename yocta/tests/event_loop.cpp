@@ -0,0 +1,91 @@
+// Runs a script as four tasks on one event loop, over a pipe and a socket pair, and prints how each task ended,
+// so ctest can compare the output with the expected one like it does for the scripts in tests/scripts.
+//
+//   event_loop_tests <script>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "EventLoop.h"
+#include "Program.h"
+#include "VirtualMachine.h"
+
+#include <unistd.h>
+
+static const char* translateResult(yo::VirtualMachine::InterpretResult result)
+{
+	switch (result)
+	{
+		case yo::VirtualMachine::InterpretResult::OK: return "ok";
+		case yo::VirtualMachine::InterpretResult::COMPILE_ERROR: return "compile error";
+		case yo::VirtualMachine::InterpretResult::RUNTIME_ERROR: return "runtime error";
+		case yo::VirtualMachine::InterpretResult::YIELDED: return "yielded";
+		case yo::VirtualMachine::InterpretResult::WAITING: return "waiting";
+		default: return "unknown";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc != 2)
+	{
+		fprintf(stderr, "Usage: event_loop_tests <script>\n");
+		return 1;
+	}
+
+	std::ifstream file(argv[1]);
+
+	if (!file.good())
+	{
+		fprintf(stderr, "Cannot open '%s'.\n", argv[1]);
+		return 1;
+	}
+
+	std::stringstream source;
+	source << file.rdbuf();
+
+	std::shared_ptr<const yo::Program> program = yo::Program::compile(source.str().c_str());
+	if (!program)
+		return 1;
+
+	int pipeFds[2];
+	int pairFds[2];
+
+	if (!yo::EventLoop::openPipe(pipeFds) || !yo::EventLoop::openSocketPair(pairFds))
+	{
+		fprintf(stderr, "Cannot open the descriptors the tasks share.\n");
+		return 1;
+	}
+
+	// A short time slice makes the loops in the tasks yield as well as park.
+	yo::EventLoop loop(100);
+	std::vector<std::unique_ptr<yo::VirtualMachine>> machines;
+
+	for (int64_t task = 0; task < 4; ++task)
+	{
+		machines.push_back(std::make_unique<yo::VirtualMachine>());
+
+		loop.spawn(*machines.back(), program, { { "task", { task } }, { "input", { (int64_t)pipeFds[0] } }, { "output", { (int64_t)pipeFds[1] } },
+			{ "left", { (int64_t)pairFds[0] } }, { "right", { (int64_t)pairFds[1] } } });
+	}
+
+	if (!loop.run())
+	{
+		fprintf(stderr, "The event loop failed.\n");
+		return 1;
+	}
+
+	for (size_t task = 0; task < machines.size(); ++task)
+		printf("task %zu: %s\n", task, translateResult(loop.result(task)));
+
+	// The pipe transfer cannot finish without parking, and every task that parked must have been completed.
+	printf("parked: %s\n", loop.parks() > 0 ? "true" : "false");
+	printf("woken: %s\n", loop.wakeups() == loop.parks() ? "true" : "false");
+
+	close(pairFds[0]);
+	close(pairFds[1]);
+	return 0;
+}
\ No newline at end of file